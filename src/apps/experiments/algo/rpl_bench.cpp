@@ -0,0 +1,306 @@
+// Pipelines of ez::rpl against the equivalent std::views compositions and hand-written loops.
+// The results can be compared between two builds with the JSON output of Google Benchmark:
+//   ez_rpl_bench --benchmark_out=rpl.json --benchmark_out_format=json
+//   compare.py benchmarks baseline.json rpl.json
+// The ez_rpl_bench_json target runs the suite and writes the results in the build directory.
+
+#include <benchmark/benchmark.h>
+
+#include <ez/async/WorkStealingPool.hpp>
+#include <ez/rpl/All.hpp>
+
+#include <ez/Utils.hpp>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+using namespace ez;
+
+namespace {
+
+struct Order {
+    u64 id = 0;
+    u32 customer = 0;
+    double amount = 0;
+    bool paid = false;
+};
+
+template <typename T>
+std::vector<T> make_values(size_t size);
+
+template <>
+std::vector<u32> make_values(size_t size)
+{
+    std::vector<u32> values(size);
+    std::mt19937 random{42};
+    std::ranges::generate(values, [&] { return u32(random() % 1'000'000); });
+    return values;
+}
+
+template <>
+std::vector<std::string> make_values(size_t size)
+{
+    std::vector<std::string> values(size);
+    std::mt19937 random{42};
+    std::ranges::generate(values, [&] { return std::string(random() % 32, 'x'); });
+    return values;
+}
+
+template <>
+std::vector<Order> make_values(size_t size)
+{
+    std::vector<Order> values(size);
+    std::mt19937 random{42};
+    for (size_t i = 0; i < size; ++i) {
+        values[i] = {i, u32(random() % 1000), double(random() % 10'000) / 100.0,
+                     random() % 2 == 0};
+    }
+    return values;
+}
+
+// The same filter, transform and accumulate for every element type.
+bool keep(u32 value) { return value % 2 == 0; }
+u64 map(u32 value) { return u64(value) * 3; }
+
+bool keep(const std::string& value) { return value.size() > 8; }
+u64 map(const std::string& value) { return value.size(); }
+
+bool keep(const Order& order) { return order.paid; }
+u64 map(const Order& order) { return u64(order.amount); }
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void filter_transform_sum_rpl(benchmark::State& state)
+{
+    const auto values = make_values<T>(size_t(state.range(0)));
+    auto is_kept = [](const T& value) { return keep(value); };
+    auto mapped = [](const T& value) { return map(value); };
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rpl::run(values, rpl::filter(is_kept), rpl::transform(mapped),
+                                          rpl::accumulate(u64{0})));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+static void filter_transform_sum_views(benchmark::State& state)
+{
+    const auto values = make_values<T>(size_t(state.range(0)));
+    auto is_kept = [](const T& value) { return keep(value); };
+    auto mapped = [](const T& value) { return map(value); };
+
+    for (auto _ : state) {
+        u64 sum = 0;
+        for (u64 value : values | std::views::filter(is_kept) | std::views::transform(mapped)) {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+static void filter_transform_sum_loop(benchmark::State& state)
+{
+    const auto values = make_values<T>(size_t(state.range(0)));
+
+    for (auto _ : state) {
+        u64 sum = 0;
+        for (const T& value : values) {
+            if (keep(value)) sum += map(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(filter_transform_sum_rpl<u32>)->RangeMultiplier(10)->Range(1'000, 100'000'000);
+BENCHMARK(filter_transform_sum_views<u32>)->RangeMultiplier(10)->Range(1'000, 100'000'000);
+BENCHMARK(filter_transform_sum_loop<u32>)->RangeMultiplier(10)->Range(1'000, 100'000'000);
+
+BENCHMARK(filter_transform_sum_rpl<std::string>)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+BENCHMARK(filter_transform_sum_views<std::string>)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+BENCHMARK(filter_transform_sum_loop<std::string>)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+BENCHMARK(filter_transform_sum_rpl<Order>)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(filter_transform_sum_views<Order>)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(filter_transform_sum_loop<Order>)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+
+///////////////////////////////////////////////////////////////////////
+
+static void enumerate_to_map_rpl(benchmark::State& state)
+{
+    const auto values = make_values<u32>(size_t(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rpl::run(values, rpl::enumerate(), rpl::to_map()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void enumerate_to_map_loop(benchmark::State& state)
+{
+    const auto values = make_values<u32>(size_t(state.range(0)));
+
+    for (auto _ : state) {
+        std::map<size_t, u32> result;
+        for (size_t i = 0; i < values.size(); ++i) result.emplace(i, values[i]);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(enumerate_to_map_rpl)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+BENCHMARK(enumerate_to_map_loop)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+///////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void sort_unique_rpl(benchmark::State& state)
+{
+    const auto values = make_values<T>(size_t(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rpl::run(std::vector<T>(values), rpl::sort(), rpl::unique()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+static void sort_unique_loop(benchmark::State& state)
+{
+    const auto values = make_values<T>(size_t(state.range(0)));
+
+    for (auto _ : state) {
+        std::vector<T> result(values);
+        std::ranges::sort(result);
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(sort_unique_rpl<u32>)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(sort_unique_loop<u32>)->RangeMultiplier(10)->Range(1'000, 10'000'000);
+BENCHMARK(sort_unique_rpl<std::string>)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+BENCHMARK(sort_unique_loop<std::string>)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+///////////////////////////////////////////////////////////////////////
+
+// Only the first elements are needed, the cost must not depend on the input size.
+static void take_rpl(benchmark::State& state)
+{
+    const auto values = make_values<u32>(size_t(state.range(0)));
+    auto is_kept = [](u32 value) { return keep(value); };
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            rpl::run(values, rpl::filter(is_kept), rpl::take(16), rpl::to_vector()));
+    }
+}
+
+static void take_views(benchmark::State& state)
+{
+    const auto values = make_values<u32>(size_t(state.range(0)));
+    auto is_kept = [](u32 value) { return keep(value); };
+
+    for (auto _ : state) {
+        std::vector<u32> result;
+        for (u32 value : values | std::views::filter(is_kept) | std::views::take(16)) {
+            result.push_back(value);
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+static void take_loop(benchmark::State& state)
+{
+    const auto values = make_values<u32>(size_t(state.range(0)));
+
+    for (auto _ : state) {
+        std::vector<u32> result;
+        for (u32 value : values) {
+            if (!keep(value)) continue;
+            result.push_back(value);
+            if (result.size() == 16) break;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+BENCHMARK(take_rpl)->RangeMultiplier(10)->Range(1'000, 100'000'000);
+BENCHMARK(take_views)->RangeMultiplier(10)->Range(1'000, 100'000'000);
+BENCHMARK(take_loop)->RangeMultiplier(10)->Range(1'000, 100'000'000);
+
+///////////////////////////////////////////////////////////////////////
+
+static void parallel_rpl(benchmark::State& state)
+{
+    const auto values = make_values<u32>(size_t(state.range(0)));
+    auto is_kept = [](u32 value) { return keep(value); };
+    auto mapped = [](u32 value) { return map(value); };
+    async::WorkStealingPool pool;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rpl::run(rpl::par(pool), values, rpl::filter(is_kept),
+                                          rpl::transform(mapped), rpl::accumulate(u64{0})));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(parallel_rpl)->RangeMultiplier(10)->Range(100'000, 100'000'000)->UseRealTime();
+BENCHMARK(filter_transform_sum_rpl<u32>)
+    ->Name("sequential_rpl")
+    ->RangeMultiplier(10)
+    ->Range(100'000, 100'000'000)
+    ->UseRealTime();
+
+///////////////////////////////////////////////////////////////////////
+
+// The same stream forked to several sub pipelines, one after the other or each branch on the
+// pool behind its bounded buffer.
+template <bool concurrent>
+static void fan_out_rpl(benchmark::State& state)
+{
+    const auto values = make_values<u32>(size_t(state.range(0)));
+    auto is_kept = [](u32 value) { return keep(value); };
+    auto mapped = [](u32 value) { return map(value); };
+    async::WorkStealingPool pool;
+
+    auto branches = [&](auto... options) {
+        return rpl::parallel(
+            options...,
+            rpl::compose(rpl::filter(is_kept), rpl::transform(mapped), rpl::accumulate(u64{0})),
+            rpl::max(), rpl::count());
+    };
+
+    for (auto _ : state) {
+        if constexpr (concurrent) {
+            benchmark::DoNotOptimize(rpl::run(values, branches(rpl::on(pool))));
+        }
+        else {
+            benchmark::DoNotOptimize(rpl::run(values, branches()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(fan_out_rpl<false>)
+    ->Name("fan_out_rpl")
+    ->RangeMultiplier(10)
+    ->Range(100'000, 10'000'000)
+    ->UseRealTime();
+BENCHMARK(fan_out_rpl<true>)
+    ->Name("fan_out_on_pool_rpl")
+    ->RangeMultiplier(10)
+    ->Range(100'000, 10'000'000)
+    ->UseRealTime();
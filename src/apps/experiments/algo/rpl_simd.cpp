@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <ez/rpl/All.hpp>
+
+#include <ez/Utils.hpp>
+
+#include <functional>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+using namespace ez;
+
+inline constexpr u64 element_count = 1000000;
+
+template <typename T>
+std::vector<T> make_vector(u64 size)
+{
+    std::vector<T> result(size);
+    std::iota(result.begin(), result.end(), T{});
+    return result;
+}
+
+// Contiguous ranges are processed chunk by chunk, a transform view hides the contiguity and
+// forces the element by element path with the same input type.
+template <typename T, bool contiguous>
+decltype(auto) input(const std::vector<T>& elements)
+{
+    if constexpr (contiguous) { return (elements); }
+    else {
+        return elements | std::views::transform(std::identity{});
+    }
+}
+
+template <typename T, bool contiguous>
+static void benchmark_sum(benchmark::State& state)
+{
+    auto elements = make_vector<T>(element_count);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            rpl::run(input<T, contiguous>(elements), rpl::accumulate<T>()));
+    }
+}
+
+template <typename T, bool contiguous>
+static void benchmark_max(benchmark::State& state)
+{
+    auto elements = make_vector<T>(element_count);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rpl::run(input<T, contiguous>(elements), rpl::max()));
+    }
+}
+
+template <typename T, bool contiguous>
+static void benchmark_filter_count(benchmark::State& state)
+{
+    auto elements = make_vector<T>(element_count);
+    auto is_even = [](T val) { return val % 2 == 0; };
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            rpl::run(input<T, contiguous>(elements), rpl::filter(is_even), rpl::count()));
+    }
+}
+
+template <typename T, bool contiguous>
+static void benchmark_transform_sum(benchmark::State& state)
+{
+    auto elements = make_vector<T>(element_count);
+    auto twice = [](T val) -> T { return val * 2; };
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rpl::run(input<T, contiguous>(elements), rpl::transform(twice),
+                                          rpl::accumulate<T>()));
+    }
+}
+
+BENCHMARK(benchmark_sum<u32, false>);
+BENCHMARK(benchmark_sum<u32, true>);
+BENCHMARK(benchmark_sum<f32, false>);
+BENCHMARK(benchmark_sum<f32, true>);
+
+BENCHMARK(benchmark_max<u16, false>);
+BENCHMARK(benchmark_max<u16, true>);
+BENCHMARK(benchmark_max<u64, false>);
+BENCHMARK(benchmark_max<u64, true>);
+
+BENCHMARK(benchmark_filter_count<u32, false>);
+BENCHMARK(benchmark_filter_count<u32, true>);
+
+BENCHMARK(benchmark_transform_sum<u32, false>);
+BENCHMARK(benchmark_transform_sum<u32, true>);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <ez/Utils.hpp>
+
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ez {
+
+///
+/// Unbounded lock free work stealing deque (Chase-Lev, with the C11 memory orderings of Lê et
+/// al.). The owner thread pushes and pops at the bottom, any thread can steal from the top.
+/// The buffer grows when full, the previous buffers are kept until destruction since thieves can
+/// still read them.
+/// Elements must be trivially copyable (pointers, handles...), an empty result is `T{}`.
+/// Usage:
+///   @code
+///   ChaseLevDeque<Job*> jobs;
+///   jobs.push(job);              // owner thread
+///   Job* mine = jobs.pop();      // owner thread
+///   Job* stolen = jobs.steal();  // other threads
+///   @endcode
+template <typename T>
+class ChaseLevDeque : NonCopiable {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "ChaseLevDeque elements must be trivially copyable.");
+
+public:
+    explicit ChaseLevDeque(size_t capacity = 256);
+    ChaseLevDeque(ChaseLevDeque&&) = delete;
+
+    /// Approximate when called concurrently with other operations.
+    size_t size() const noexcept;
+    bool empty() const noexcept { return size() == 0; }
+
+    /// Owner side.
+    void push(T value);
+    T pop();
+
+    /// Any thread. Returns `T{}` when empty or when the element was taken concurrently.
+    T steal();
+
+private:
+    struct Buffer {
+        explicit Buffer(i64 capacity)
+            : mask{capacity - 1}, slots{std::make_unique<std::atomic<T>[]>(size_t(capacity))}
+        {
+        }
+
+        i64 capacity() const noexcept { return mask + 1; }
+        T load(i64 index) const noexcept
+        {
+            return slots[index & mask].load(std::memory_order::relaxed);
+        }
+        void store(i64 index, T value) noexcept
+        {
+            slots[index & mask].store(value, std::memory_order::relaxed);
+        }
+
+        i64 mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    Buffer* grow(Buffer* buffer, i64 top, i64 bottom);
+
+    static constexpr size_t cache_line = 64;
+
+    alignas(cache_line) std::atomic<i64> m_top{0};
+    alignas(cache_line) std::atomic<i64> m_bottom{0};
+    std::atomic<Buffer*> m_buffer;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;  // Owner side.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+ChaseLevDeque<T>::ChaseLevDeque(size_t capacity)
+{
+    const i64 rounded_capacity = i64(std::bit_ceil(std::max<size_t>(capacity, 2)));
+    m_buffers.push_back(std::make_unique<Buffer>(rounded_capacity));
+    m_buffer.store(m_buffers.back().get(), std::memory_order::relaxed);
+}
+
+template <typename T>
+size_t ChaseLevDeque<T>::size() const noexcept
+{
+    const i64 bottom = m_bottom.load(std::memory_order::relaxed);
+    const i64 top = m_top.load(std::memory_order::relaxed);
+    return size_t(std::max<i64>(bottom - top, 0));
+}
+
+template <typename T>
+void ChaseLevDeque<T>::push(T value)
+{
+    const i64 bottom = m_bottom.load(std::memory_order::relaxed);
+    const i64 top = m_top.load(std::memory_order::acquire);
+    Buffer* buffer = m_buffer.load(std::memory_order::relaxed);
+
+    if (bottom - top > buffer->capacity() - 1) buffer = grow(buffer, top, bottom);
+
+    buffer->store(bottom, value);
+    // Release on the index instead of a standalone fence, the thieves acquire it.
+    m_bottom.store(bottom + 1, std::memory_order::release);
+}
+
+template <typename T>
+T ChaseLevDeque<T>::pop()
+{
+    const i64 bottom = m_bottom.load(std::memory_order::relaxed) - 1;
+    Buffer* buffer = m_buffer.load(std::memory_order::relaxed);
+    m_bottom.store(bottom, std::memory_order::relaxed);
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    i64 top = m_top.load(std::memory_order::relaxed);
+
+    if (top > bottom) {
+        m_bottom.store(bottom + 1, std::memory_order::relaxed);
+        return T{};
+    }
+
+    T value = buffer->load(bottom);
+    if (top == bottom) {
+        // Last element, race with the thieves.
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order::seq_cst,
+                                           std::memory_order::relaxed)) {
+            value = T{};
+        }
+        m_bottom.store(bottom + 1, std::memory_order::relaxed);
+    }
+    return value;
+}
+
+template <typename T>
+T ChaseLevDeque<T>::steal()
+{
+    i64 top = m_top.load(std::memory_order::acquire);
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    const i64 bottom = m_bottom.load(std::memory_order::acquire);
+
+    if (top >= bottom) return T{};
+
+    Buffer* buffer = m_buffer.load(std::memory_order::acquire);
+    T value = buffer->load(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order::seq_cst,
+                                       std::memory_order::relaxed)) {
+        return T{};
+    }
+    return value;
+}
+
+template <typename T>
+auto ChaseLevDeque<T>::grow(Buffer* buffer, i64 top, i64 bottom) -> Buffer*
+{
+    auto bigger = std::make_unique<Buffer>(buffer->capacity() * 2);
+    for (i64 i = top; i < bottom; ++i) bigger->store(i, buffer->load(i));
+
+    Buffer* result = bigger.get();
+    m_buffers.push_back(std::move(bigger));
+    m_buffer.store(result, std::memory_order::release);
+    return result;
+}
+
+}  // namespace ez
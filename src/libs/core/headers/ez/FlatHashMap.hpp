@@ -0,0 +1,376 @@
+#pragma once
+
+#include <ez/Utils.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace ez {
+
+///
+/// Hash map storing its elements in a single array with open addressing (linear probing).
+/// Lookups touch contiguous memory and inserting does not allocate a node per element.
+/// The slot count is a power of two and the table grows when it is 7/8 full. Erasing shifts the
+/// following elements back, there are no tombstones.
+/// Inserting or erasing invalidates iterators and references. The keys must not be modified
+/// through the iterators.
+/// Usage:
+///   @code
+///   FlatHashMap<std::string, int> map;
+///   map["a"] = 1;
+///   map.try_emplace("b", 2);
+///   if (auto it = map.find("a"); it != map.end()) it->second += 1;
+///   @endcode
+template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+class FlatHashMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = size_t;
+
+    template <bool is_const>
+    class Iterator;
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+    explicit FlatHashMap(size_t capacity, Hash hash = {}, Equal equal = {});
+    FlatHashMap(const FlatHashMap& other);
+    FlatHashMap(FlatHashMap&& other) noexcept;
+    ~FlatHashMap();
+
+    FlatHashMap& operator=(FlatHashMap other) noexcept;
+
+    void swap(FlatHashMap& other) noexcept;
+
+    size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    size_t slot_count() const noexcept { return m_slot_count; }
+
+    /// Makes room for `capacity` elements without further rehash.
+    void reserve(size_t capacity);
+    void clear() noexcept;
+
+    iterator begin() noexcept { return {this, first_used(0)}; }
+    iterator end() noexcept { return {this, m_slot_count}; }
+    const_iterator begin() const noexcept { return {this, first_used(0)}; }
+    const_iterator end() const noexcept { return {this, m_slot_count}; }
+
+    iterator find(const K& key);
+    const_iterator find(const K& key) const;
+    bool contains(const K& key) const { return find_index(key, hash_of(key)) != npos; }
+
+    V& at(const K& key);
+    const V& at(const K& key) const;
+
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+    V& operator[](K&& key) { return try_emplace(std::move(key)).first->second; }
+
+    /// Constructs the value from `args` if the key is not present, the arguments are left
+    /// untouched otherwise.
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args);
+
+    std::pair<iterator, bool> insert(value_type value)
+    {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+
+    size_t erase(const K& key);
+
+private:
+    static constexpr size_t npos = size_t(-1);
+    static constexpr size_t min_slot_count = 8;
+
+    struct alignas(value_type) Storage {
+        std::byte bytes[sizeof(value_type)];
+    };
+
+    value_type* slot(size_t index) noexcept
+    {
+        return std::launder(reinterpret_cast<value_type*>(&m_slots[index]));
+    }
+    const value_type* slot(size_t index) const noexcept
+    {
+        return std::launder(reinterpret_cast<const value_type*>(&m_slots[index]));
+    }
+
+    // The low bits select the slot, the high bits are kept in the tag to skip most of the key
+    // comparisons. A zero tag marks an empty slot.
+    size_t hash_of(const K& key) const
+    {
+        u64 h = u64(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+        return size_t(h ^ (h >> 32));
+    }
+    static u8 tag_of(size_t hash) noexcept { return u8(0x80 | (hash >> 57)); }
+
+    size_t mask() const noexcept { return m_slot_count - 1; }
+
+    size_t first_used(size_t index) const noexcept
+    {
+        while (index < m_slot_count && m_tags[index] == 0) ++index;
+        return index;
+    }
+
+    size_t find_index(const K& key, size_t hash) const;
+    size_t find_free(size_t hash) const;
+    void rehash(size_t slot_count);
+
+    static size_t slot_count_for(size_t capacity)
+    {
+        return std::max(min_slot_count, std::bit_ceil(capacity + capacity / 7 + 1));
+    }
+
+private:
+    std::unique_ptr<Storage[]> m_slots;
+    std::unique_ptr<u8[]> m_tags;
+    size_t m_slot_count = 0;
+    size_t m_size = 0;
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] Equal m_equal;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename K, typename V, typename Hash, typename Equal>
+template <bool is_const>
+class FlatHashMap<K, V, Hash, Equal>::Iterator {
+public:
+    using Map = std::conditional_t<is_const, const FlatHashMap, FlatHashMap>;
+
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = FlatHashMap::value_type;
+    using reference = std::conditional_t<is_const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<is_const, const value_type*, value_type*>;
+
+    Iterator() = default;
+    Iterator(Map* map, size_t index) : m_map{map}, m_index{index} {}
+
+    operator Iterator<true>() const { return {m_map, m_index}; }
+
+    reference operator*() const { return *m_map->slot(m_index); }
+    pointer operator->() const { return m_map->slot(m_index); }
+
+    Iterator& operator++()
+    {
+        m_index = m_map->first_used(m_index + 1);
+        return *this;
+    }
+
+    Iterator operator++(int)
+    {
+        Iterator result = *this;
+        ++*this;
+        return result;
+    }
+
+    bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+
+private:
+    Map* m_map = nullptr;
+    size_t m_index = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename K, typename V, typename Hash, typename Equal>
+FlatHashMap<K, V, Hash, Equal>::FlatHashMap(size_t capacity, Hash hash, Equal equal)
+    : m_hash{std::move(hash)}, m_equal{std::move(equal)}
+{
+    reserve(capacity);
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+FlatHashMap<K, V, Hash, Equal>::FlatHashMap(const FlatHashMap& other)
+    : m_hash{other.m_hash}, m_equal{other.m_equal}
+{
+    reserve(other.size());
+    for (const value_type& value : other) { try_emplace(value.first, value.second); }
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+FlatHashMap<K, V, Hash, Equal>::FlatHashMap(FlatHashMap&& other) noexcept
+    : m_slots{std::move(other.m_slots)},
+      m_tags{std::move(other.m_tags)},
+      m_slot_count{std::exchange(other.m_slot_count, 0)},
+      m_size{std::exchange(other.m_size, 0)},
+      m_hash{other.m_hash},
+      m_equal{other.m_equal}
+{
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+FlatHashMap<K, V, Hash, Equal>::~FlatHashMap()
+{
+    clear();
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+FlatHashMap<K, V, Hash, Equal>& FlatHashMap<K, V, Hash, Equal>::operator=(
+    FlatHashMap other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+void FlatHashMap<K, V, Hash, Equal>::swap(FlatHashMap& other) noexcept
+{
+    std::swap(m_slots, other.m_slots);
+    std::swap(m_tags, other.m_tags);
+    std::swap(m_slot_count, other.m_slot_count);
+    std::swap(m_size, other.m_size);
+    std::swap(m_hash, other.m_hash);
+    std::swap(m_equal, other.m_equal);
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+void FlatHashMap<K, V, Hash, Equal>::reserve(size_t capacity)
+{
+    if (capacity == 0 || capacity <= m_slot_count - m_slot_count / 8) return;
+    rehash(slot_count_for(capacity));
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+void FlatHashMap<K, V, Hash, Equal>::clear() noexcept
+{
+    if (m_size == 0) return;
+    for (size_t index = 0; index < m_slot_count; ++index) {
+        if (m_tags[index] != 0) std::destroy_at(slot(index));
+    }
+    std::memset(m_tags.get(), 0, m_slot_count);
+    m_size = 0;
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+auto FlatHashMap<K, V, Hash, Equal>::find(const K& key) -> iterator
+{
+    const size_t index = find_index(key, hash_of(key));
+    return {this, index == npos ? m_slot_count : index};
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+auto FlatHashMap<K, V, Hash, Equal>::find(const K& key) const -> const_iterator
+{
+    const size_t index = find_index(key, hash_of(key));
+    return {this, index == npos ? m_slot_count : index};
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+V& FlatHashMap<K, V, Hash, Equal>::at(const K& key)
+{
+    const size_t index = find_index(key, hash_of(key));
+    if (index == npos) throw std::out_of_range{"FlatHashMap::at: key not found"};
+    return slot(index)->second;
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+const V& FlatHashMap<K, V, Hash, Equal>::at(const K& key) const
+{
+    const size_t index = find_index(key, hash_of(key));
+    if (index == npos) throw std::out_of_range{"FlatHashMap::at: key not found"};
+    return slot(index)->second;
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+template <typename Key, typename... Args>
+auto FlatHashMap<K, V, Hash, Equal>::try_emplace(Key&& key, Args&&... args)
+    -> std::pair<iterator, bool>
+{
+    if constexpr (!std::is_same_v<std::remove_cvref_t<Key>, K>) {
+        return try_emplace(K(std::forward<Key>(key)), std::forward<Args>(args)...);
+    }
+    else {
+        const size_t hash = hash_of(key);
+
+        if (const size_t index = find_index(key, hash); index != npos) {
+            return {{this, index}, false};
+        }
+
+        if (m_size + 1 > m_slot_count - m_slot_count / 8) rehash(slot_count_for(m_size + 1));
+
+        const size_t index = find_free(hash);
+        std::construct_at(slot(index), std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<Key>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        m_tags[index] = tag_of(hash);
+        ++m_size;
+        return {{this, index}, true};
+    }
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+size_t FlatHashMap<K, V, Hash, Equal>::erase(const K& key)
+{
+    size_t hole = find_index(key, hash_of(key));
+    if (hole == npos) return 0;
+
+    std::destroy_at(slot(hole));
+    --m_size;
+
+    // Backward shift: move back the following elements whose home slot is not between the hole
+    // and their current position.
+    for (size_t index = (hole + 1) & mask(); m_tags[index] != 0; index = (index + 1) & mask()) {
+        const size_t home = hash_of(slot(index)->first) & mask();
+        if (((index - home) & mask()) >= ((index - hole) & mask())) {
+            std::construct_at(slot(hole), std::move(*slot(index)));
+            std::destroy_at(slot(index));
+            m_tags[hole] = m_tags[index];
+            hole = index;
+        }
+    }
+    m_tags[hole] = 0;
+    return 1;
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+size_t FlatHashMap<K, V, Hash, Equal>::find_index(const K& key, size_t hash) const
+{
+    if (m_size == 0) return npos;
+
+    const u8 tag = tag_of(hash);
+    for (size_t index = hash & mask();; index = (index + 1) & mask()) {
+        if (m_tags[index] == 0) return npos;
+        if (m_tags[index] == tag && m_equal(slot(index)->first, key)) return index;
+    }
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+size_t FlatHashMap<K, V, Hash, Equal>::find_free(size_t hash) const
+{
+    size_t index = hash & mask();
+    while (m_tags[index] != 0) index = (index + 1) & mask();
+    return index;
+}
+
+template <typename K, typename V, typename Hash, typename Equal>
+void FlatHashMap<K, V, Hash, Equal>::rehash(size_t slot_count)
+{
+    auto slots = std::exchange(m_slots, std::make_unique<Storage[]>(slot_count));
+    auto tags = std::exchange(m_tags, std::make_unique<u8[]>(slot_count));
+    const size_t old_slot_count = std::exchange(m_slot_count, slot_count);
+
+    for (size_t index = 0; index < old_slot_count; ++index) {
+        if (tags[index] == 0) continue;
+
+        auto* value = std::launder(reinterpret_cast<value_type*>(&slots[index]));
+        const size_t hash = hash_of(value->first);
+        const size_t free_index = find_free(hash);
+        std::construct_at(slot(free_index), std::move(*value));
+        std::destroy_at(value);
+        m_tags[free_index] = tag_of(hash);
+    }
+}
+
+}  // namespace ez
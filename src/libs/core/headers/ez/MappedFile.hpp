@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ez/Utils.hpp>
+
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ez {
+
+///
+/// Read only view of a whole file mapped in memory.
+/// The access pattern hint is forwarded to the kernel (madvise) so that sequential scans
+/// read ahead aggressively and release the pages behind.
+/// Throws std::system_error when the file cannot be opened or mapped.
+/// Usage:
+///   @code
+///   MappedFile file{"events.log"};
+///   std::string_view content = file.view();
+///   @endcode
+class MappedFile : NonCopiable {
+public:
+    enum class Access { Normal, Sequential, Random };
+
+    explicit MappedFile(const std::filesystem::path& path, Access access = Access::Sequential);
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    const char* data() const noexcept { return m_data; }
+    size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    std::string_view view() const noexcept { return {m_data, m_size}; }
+    std::span<const std::byte> bytes() const noexcept
+    {
+        return {reinterpret_cast<const std::byte*>(m_data), m_size};
+    }
+
+private:
+    void release() noexcept;
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    // Used when memory mapping is not available.
+    std::vector<char> m_fallback;
+};
+
+}  // namespace ez
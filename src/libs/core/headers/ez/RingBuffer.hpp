@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ez/Contract.hpp>
+#include <ez/Utils.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace ez {
+
+///
+/// Fixed capacity double ended queue stored in a contiguous circular buffer.
+/// Elements are default constructed up front and recycled by assignment, pushing and popping
+/// never allocate.
+/// Usage:
+///   @code
+///   RingBuffer<int> last_values{3};
+///   last_values.push_back(1);
+///   if (last_values.full()) last_values.pop_front();
+///   @endcode
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : m_values(std::max<size_t>(capacity, 1)) {}
+
+    size_t capacity() const noexcept { return m_values.size(); }
+    size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    bool full() const noexcept { return m_size == capacity(); }
+
+    T& operator[](size_t index) { return m_values[wrap(m_head + index)]; }
+    const T& operator[](size_t index) const { return m_values[wrap(m_head + index)]; }
+
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[m_size - 1]; }
+    const T& back() const { return (*this)[m_size - 1]; }
+
+    void push_back(auto&& value)
+    {
+        EZ_ASSERT(!full());
+        m_values[wrap(m_head + m_size)] = EZ_FWD(value);
+        ++m_size;
+    }
+
+    void pop_front()
+    {
+        EZ_ASSERT(!empty());
+        m_head = wrap(m_head + 1);
+        --m_size;
+    }
+
+    void pop_back()
+    {
+        EZ_ASSERT(!empty());
+        --m_size;
+    }
+
+    void clear() noexcept
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+private:
+    size_t wrap(size_t index) const noexcept
+    {
+        return index < capacity() ? index : index - capacity();
+    }
+
+private:
+    std::vector<T> m_values;
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+}  // namespace ez
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <ez/Contract.hpp>
+#include <ez/Utils.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace ez {
+
+/// Finalizer of splitmix64. Spreads the entropy of weak hashes (std::hash of integers is the
+/// identity) over the 64 bits, the sketches below use the high and low bits independently.
+constexpr u64 mix_hash(u64 h) noexcept
+{
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+///
+/// Set membership with a bounded memory and no false negatives. The bit count and the number
+/// of probes are derived from the expected element count and the false positive rate, once more
+/// elements are inserted the false positive rate increases.
+/// Elements are given by hash.
+/// Usage:
+///   @code
+///   BloomFilter seen{1'000'000, 0.01};
+///   if (seen.insert(std::hash<std::string>{}(key))) { /* key not seen before */ }
+///   @endcode
+class BloomFilter {
+public:
+    BloomFilter(size_t expected_count, double false_positive_rate)
+    {
+        const double n = double(std::max<size_t>(expected_count, 1));
+        const double p = std::clamp(false_positive_rate, 1e-9, 0.5);
+        const double ln2 = std::log(2.0);
+
+        const size_t bits = size_t(std::ceil(-n * std::log(p) / (ln2 * ln2)));
+        m_words.resize(std::max<size_t>((bits + 63) / 64, 1));
+        m_probe_count = std::max<size_t>(size_t(std::round(double(bit_count()) / n * ln2)), 1);
+    }
+
+    size_t bit_count() const noexcept { return m_words.size() * 64; }
+    size_t probe_count() const noexcept { return m_probe_count; }
+
+    /// Returns true if the element was not present, false if it may have been present.
+    bool insert(u64 hash) noexcept
+    {
+        bool inserted = false;
+        Probes probes{hash};
+        for (size_t i = 0; i < m_probe_count; ++i) {
+            const u64 bit = probes.next() % bit_count();
+            u64& word = m_words[bit / 64];
+            inserted |= (word & mask_of(bit)) == 0;
+            word |= mask_of(bit);
+        }
+        return inserted;
+    }
+
+    bool may_contain(u64 hash) const noexcept
+    {
+        Probes probes{hash};
+        for (size_t i = 0; i < m_probe_count; ++i) {
+            const u64 bit = probes.next() % bit_count();
+            if ((m_words[bit / 64] & mask_of(bit)) == 0) return false;
+        }
+        return true;
+    }
+
+    void clear() noexcept { std::ranges::fill(m_words, 0); }
+
+private:
+    // Double hashing: the probes are h1 + i * h2, h2 is odd to cover every bit.
+    struct Probes {
+        u64 h1;
+        u64 h2;
+
+        explicit Probes(u64 hash) : h1{mix_hash(hash)}, h2{std::rotl(h1, 32) | 1} {}
+
+        u64 next() noexcept { return std::exchange(h1, h1 + h2); }
+    };
+
+    static u64 mask_of(u64 bit) noexcept { return u64(1) << (bit % 64); }
+
+    std::vector<u64> m_words;
+    size_t m_probe_count = 1;
+};
+
+///
+/// Cardinality estimation with `2^precision` one byte registers, the standard error is about
+/// `1.04 / sqrt(2^precision)` (1.6% for the default precision of 12, with 4 KiB of registers).
+/// Sketches with the same precision can be merged.
+/// Elements are given by hash.
+/// Usage:
+///   @code
+///   HyperLogLog visitors;
+///   for (const auto& request : requests) visitors.add(std::hash<std::string>{}(request.ip));
+///   size_t unique_visitors = visitors.estimate();
+///   @endcode
+class HyperLogLog {
+public:
+    explicit HyperLogLog(size_t precision = 12)
+        : m_precision{std::clamp<size_t>(precision, 4, 18)}, m_registers(size_t(1) << m_precision)
+    {
+    }
+
+    size_t precision() const noexcept { return m_precision; }
+
+    void add(u64 hash) noexcept
+    {
+        const u64 h = mix_hash(hash);
+        const size_t index = size_t(h >> (64 - m_precision));
+        // The guard bit bounds the rank when the remaining bits are all zero.
+        const u64 remaining = (h << m_precision) | (u64(1) << (m_precision - 1));
+        const u8 rank = u8(std::countl_zero(remaining) + 1);
+        m_registers[index] = std::max(m_registers[index], rank);
+    }
+
+    size_t estimate() const noexcept
+    {
+        const double m = double(m_registers.size());
+        double sum = 0;
+        size_t zeros = 0;
+        for (u8 rank : m_registers) {
+            sum += std::ldexp(1.0, -int(rank));
+            zeros += rank == 0;
+        }
+
+        const double raw = alpha() * m * m / sum;
+        // Linear counting is more accurate for small cardinalities.
+        if (raw <= 2.5 * m && zeros != 0) return size_t(std::round(m * std::log(m / zeros)));
+        return size_t(std::round(raw));
+    }
+
+    void merge(const HyperLogLog& other)
+    {
+        EZ_ASSERT(other.m_precision == m_precision);
+        for (size_t i = 0; i < m_registers.size(); ++i) {
+            m_registers[i] = std::max(m_registers[i], other.m_registers[i]);
+        }
+    }
+
+private:
+    double alpha() const noexcept
+    {
+        switch (m_registers.size()) {
+            case 16: return 0.673;
+            case 32: return 0.697;
+            case 64: return 0.709;
+            default: return 0.7213 / (1.0 + 1.079 / double(m_registers.size()));
+        }
+    }
+
+    size_t m_precision = 12;
+    std::vector<u8> m_registers;
+};
+
+}  // namespace ez
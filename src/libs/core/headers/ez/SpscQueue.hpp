@@ -0,0 +1,121 @@
+#pragma once
+
+#include <ez/Option.hpp>
+#include <ez/Utils.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <new>
+
+namespace ez {
+
+///
+/// Bounded lock free queue with a single producer thread and a single consumer thread.
+/// The capacity is rounded up to the next power of two.
+/// Usage:
+///   @code
+///   SpscQueue<int> queue{128};
+///   queue.try_push(10); // producer thread
+///   Option<int> value = queue.try_pop(); // consumer thread
+///   @endcode
+template <typename T>
+class SpscQueue : NonCopiable {
+public:
+    explicit SpscQueue(size_t capacity);
+    SpscQueue(SpscQueue&&) = delete;
+    ~SpscQueue();
+
+    size_t capacity() const noexcept { return m_mask + 1; }
+
+    bool empty() const noexcept;
+    size_t size() const noexcept;
+
+    /// Producer side. Returns false when the queue is full.
+    bool try_push(auto&&... args);
+
+    /// Consumer side. Returns none when the queue is empty.
+    Option<T> try_pop();
+
+private:
+    T* slot(size_t index) noexcept { return reinterpret_cast<T*>(&m_slots[index & m_mask]); }
+
+private:
+    struct alignas(T) Storage {
+        std::byte bytes[sizeof(T)];
+    };
+
+    static constexpr size_t cache_line = 64;
+
+    const size_t m_mask;
+    std::unique_ptr<Storage[]> m_slots;
+
+    // Each side owns one index and caches the other one to limit cache line traffic.
+    alignas(cache_line) std::atomic<size_t> m_head{0};
+    size_t m_cached_tail = 0;
+
+    alignas(cache_line) std::atomic<size_t> m_tail{0};
+    size_t m_cached_head = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+SpscQueue<T>::SpscQueue(size_t capacity)
+    : m_mask{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1},
+      m_slots{std::make_unique<Storage[]>(m_mask + 1)}
+{
+}
+
+template <typename T>
+SpscQueue<T>::~SpscQueue()
+{
+    while (try_pop()) {}
+}
+
+template <typename T>
+bool SpscQueue<T>::empty() const noexcept
+{
+    return m_head.load(std::memory_order::acquire) == m_tail.load(std::memory_order::acquire);
+}
+
+template <typename T>
+size_t SpscQueue<T>::size() const noexcept
+{
+    return m_tail.load(std::memory_order::acquire) - m_head.load(std::memory_order::acquire);
+}
+
+template <typename T>
+bool SpscQueue<T>::try_push(auto&&... args)
+{
+    const size_t tail = m_tail.load(std::memory_order::relaxed);
+
+    if (tail - m_cached_head == capacity()) {
+        m_cached_head = m_head.load(std::memory_order::acquire);
+        if (tail - m_cached_head == capacity()) return false;
+    }
+
+    std::construct_at(slot(tail), EZ_FWD(args)...);
+    m_tail.store(tail + 1, std::memory_order::release);
+    return true;
+}
+
+template <typename T>
+Option<T> SpscQueue<T>::try_pop()
+{
+    const size_t head = m_head.load(std::memory_order::relaxed);
+
+    if (head == m_cached_tail) {
+        m_cached_tail = m_tail.load(std::memory_order::acquire);
+        if (head == m_cached_tail) return none;
+    }
+
+    T* value = std::launder(slot(head));
+    Option<T> result{std::move(*value)};
+    std::destroy_at(value);
+    m_head.store(head + 1, std::memory_order::release);
+    return result;
+}
+
+}  // namespace ez
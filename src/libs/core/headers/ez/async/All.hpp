@@ -1,9 +1,15 @@
 #pragma once
 
+#include <ez/async/AsyncGenerator.hpp>
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/Channel.hpp>
+#include <ez/async/Generator.hpp>
 #include <ez/async/Race.hpp>
 #include <ez/async/Schedule.hpp>
 #include <ez/async/Scope.hpp>
+#include <ez/async/Synchronization.hpp>
 #include <ez/async/Task.hpp>
 #include <ez/async/Wait.hpp>
 #include <ez/async/WhenAll.hpp>
 #include <ez/async/WhenAny.hpp>
+#include <ez/async/WhenN.hpp>
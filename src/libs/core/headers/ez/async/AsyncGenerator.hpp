@@ -0,0 +1,184 @@
+#pragma once
+
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/FrameAllocator.hpp>
+#include <ez/async/Generator.hpp>
+#include <ez/async/Task.hpp>
+#include <ez/async/Traits.hpp>
+#include <ez/async/Types.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <type_traits>
+
+namespace ez::async {
+
+template <typename T>
+class AsyncGenerator;
+
+namespace internal {
+
+template <typename T>
+class AsyncGeneratorPromise : public PooledFrame {
+public:
+    using Reference = GeneratorReference<T>;
+    using Pointer = std::add_pointer_t<Reference>;
+
+    // Yields and the end of the body transfer to the consumer awaiting `next()`.
+    struct ConsumerTransfer {
+        bool await_ready() const noexcept { return false; }
+        CoHandle<> await_suspend(CoHandle<AsyncGeneratorPromise> coroutine) const noexcept
+        {
+            return coroutine.promise().m_consumer;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    AsyncGenerator<T> get_return_object() noexcept;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    ConsumerTransfer final_suspend() const noexcept { return {}; }
+
+    ConsumerTransfer yield_value(Reference value) noexcept
+    {
+        m_value = std::addressof(value);
+        return {};
+    }
+
+    auto yield_value(const std::remove_reference_t<T>& value)
+        requires(!std::is_reference_v<T> && std::is_copy_constructible_v<T>)
+    {
+        return YieldCopyAwaiter<T, AsyncGeneratorPromise>{value};
+    }
+
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+    void set_value(Pointer value) noexcept { m_value = value; }
+    CoHandle<> yield_target() const noexcept { return m_consumer; }
+
+    Reference value() const noexcept { return static_cast<Reference>(*m_value); }
+
+    void rethrow_if_failed()
+    {
+        if (m_exception) std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+
+    // A generator without its own token observes the one of its first consumer.
+    template <typename ConsumerPromise>
+    void set_consumer(CoHandle<ConsumerPromise> consumer) noexcept
+    {
+        m_consumer = consumer;
+        if (!m_cancellation_token.can_be_cancelled()) {
+            m_cancellation_token = internal::cancellation_token_of(consumer);
+        }
+    }
+
+    const CancellationToken& cancellation_token() const noexcept { return m_cancellation_token; }
+    void set_cancellation_token(CancellationToken token) noexcept
+    {
+        m_cancellation_token = std::move(token);
+    }
+
+private:
+    Pointer m_value = nullptr;
+    std::exception_ptr m_exception;
+    CoHandle<> m_consumer;
+    CancellationToken m_cancellation_token;
+};
+
+template <typename T>
+struct AsyncGeneratorNext {
+    CoHandle<AsyncGeneratorPromise<T>> coroutine;
+
+    bool await_ready() const noexcept { return coroutine.done(); }
+
+    template <typename ConsumerPromise>
+    CoHandle<> await_suspend(CoHandle<ConsumerPromise> consumer) noexcept
+    {
+        coroutine.promise().set_consumer(consumer);
+        return coroutine;
+    }
+
+    bool await_resume()
+    {
+        coroutine.promise().rethrow_if_failed();
+        return !coroutine.done();
+    }
+};
+
+}  // namespace internal
+
+///
+/// Lazy asynchronous sequence: the body may `co_await` between its `co_yield`s, the consumer
+/// awaits each element with `next()`. The control goes back and forth by symmetric transfer, the
+/// yielded values are handed over by reference without copy and the only allocation is the
+/// coroutine frame. The body inherits the cancellation token of its first consumer.
+/// Usage:
+///   @code
+///   async::AsyncGenerator<Frame> frames(Socket& socket)
+///   {
+///       while (auto frame = co_await read_frame(socket)) co_yield std::move(*frame);
+///   }
+///
+///   auto stream = frames(socket);
+///   while (co_await stream.next()) handle(stream.value());
+///   co_await async::for_each(frames(socket), [](Frame& frame) { handle(frame); });
+///   @endcode
+template <typename T>
+class [[nodiscard]] AsyncGenerator {
+public:
+    using promise_type = internal::AsyncGeneratorPromise<T>;
+    using Reference = typename promise_type::Reference;
+
+    explicit AsyncGenerator(CoHandle<promise_type> coroutine) noexcept : m_coroutine{coroutine} {}
+    AsyncGenerator(AsyncGenerator&& other) noexcept = default;
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept = default;
+
+    /// Awaitable running the body up to its next `co_yield`: true when a value is available,
+    /// false at the end. An exception thrown by the body is rethrown.
+    auto next() noexcept { return internal::AsyncGeneratorNext<T>{m_coroutine.get()}; }
+
+    /// The element made available by the last `next()`.
+    Reference value() const noexcept { return m_coroutine.get().promise().value(); }
+
+    /// The body and the tasks it awaits observe `token` instead of the token of the consumer.
+    AsyncGenerator with_cancellation(CancellationToken token) &&
+    {
+        m_coroutine.get().promise().set_cancellation_token(std::move(token));
+        return std::move(*this);
+    }
+
+private:
+    UniqueCoroutine<promise_type> m_coroutine;
+};
+
+namespace internal {
+
+template <typename T>
+AsyncGenerator<T> AsyncGeneratorPromise<T>::get_return_object() noexcept
+{
+    return AsyncGenerator<T>{CoHandle<AsyncGeneratorPromise>::from_promise(*this)};
+}
+
+}  // namespace internal
+
+///
+/// Calls `f` with each element of the generator as an lvalue, which `f` may move from. The
+/// result of `f` is awaited when it is awaitable.
+template <typename T, typename F>
+Task<> for_each(AsyncGenerator<T> generator, F f)
+{
+    while (co_await generator.next()) {
+        auto&& value = generator.value();
+        if constexpr (trait::Awaitable<std::invoke_result_t<F&, decltype((value))>>) {
+            co_await f(value);
+        }
+        else {
+            f(value);
+        }
+    }
+}
+
+}  // namespace ez::async
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <ez/async/Types.hpp>
+#include <ez/async/internal/WaiterList.hpp>
+
+#include <ez/Utils.hpp>
+
+#include <atomic>
+#include <concepts>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace ez::async {
+
+class CancellationToken;
+
+namespace internal {
+
+struct CancellationRegistration {
+    CancellationRegistration* prev = nullptr;
+    CancellationRegistration* next = nullptr;
+    void (*invoke)(CancellationRegistration*) = nullptr;
+    bool queued = false;
+};
+
+// Shared by a source and its tokens. The callbacks run outside of the lock on the thread
+// requesting the cancellation, a registration removed while its callback runs on another thread
+// waits for the end of the callback.
+class CancellationState : NonCopiable {
+public:
+    bool is_requested() const noexcept { return m_requested.load(std::memory_order::acquire); }
+
+    /// False when the cancellation was already requested.
+    bool request();
+
+    /// False when the cancellation was already requested, the callback is not registered.
+    bool add(CancellationRegistration* registration);
+    void remove(CancellationRegistration* registration);
+
+private:
+    std::atomic<bool> m_requested{false};
+
+    std::mutex m_mutex;
+    WaiterList<CancellationRegistration> m_registrations;
+    std::atomic<CancellationRegistration*> m_running{nullptr};
+    std::thread::id m_requesting_thread;
+};
+
+}  // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+
+///
+/// Read side of a CancellationSource. A default constructed token can not be cancelled.
+/// Tasks inherit the token of the coroutine awaiting them, `async::Operation` cancels its
+/// operation when the token of the awaiting coroutine is cancelled and `when_any` cancels the
+/// awaitables which did not complete first.
+/// Usage:
+///   @code
+///   auto token = co_await async::current_cancellation_token();
+///   for (auto& chunk : chunks) {
+///       token.throw_if_cancellation_requested();
+///       process(chunk);
+///   }
+///   co_await token;  // Resumed by the cancellation.
+///   @endcode
+class CancellationToken {
+public:
+    CancellationToken() noexcept = default;
+
+    bool can_be_cancelled() const noexcept { return m_state != nullptr; }
+    bool is_cancellation_requested() const noexcept { return m_state && m_state->is_requested(); }
+
+    /// Throws OperationCancelled.
+    void throw_if_cancellation_requested() const
+    {
+        if (is_cancellation_requested()) throw OperationCancelled{};
+    }
+
+    /// Suspends until the cancellation is requested, the coroutine is resumed by the thread
+    /// requesting it. Never resumes when the token can not be cancelled.
+    auto operator co_await() const noexcept;
+
+private:
+    friend class CancellationSource;
+    template <typename F>
+    friend class CancellationCallback;
+
+    explicit CancellationToken(std::shared_ptr<internal::CancellationState> state) noexcept
+        : m_state{std::move(state)}
+    {
+    }
+
+    std::shared_ptr<internal::CancellationState> m_state;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///
+/// Requests the cancellation of the operations holding one of its tokens. The cancellation is
+/// cooperative: the operations poll or await the token, or register a CancellationCallback.
+/// Usage:
+///   @code
+///   async::CancellationSource source;
+///   scope << download(url).with_cancellation(source.token());
+///   ...
+///   source.request_cancellation();
+///   @endcode
+class CancellationSource {
+public:
+    CancellationSource() : m_state{std::make_shared<internal::CancellationState>()} {}
+
+    CancellationToken token() const noexcept { return CancellationToken{m_state}; }
+
+    bool is_cancellation_requested() const noexcept { return m_state->is_requested(); }
+
+    /// Runs the registered callbacks on this thread. False when already requested.
+    bool request_cancellation() { return m_state->request(); }
+
+private:
+    std::shared_ptr<internal::CancellationState> m_state;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///
+/// Calls `f` once the cancellation of the token is requested, immediately when it already is.
+/// The destructor unregisters the callback, it waits for the end of the callback when it runs
+/// on another thread.
+/// Usage:
+///   @code
+///   async::CancellationCallback on_cancel{token, [&] { socket.cancel(); }};
+///   @endcode
+template <typename F>
+class CancellationCallback : private internal::CancellationRegistration {
+public:
+    CancellationCallback(CancellationToken token, F f) : m_f{std::move(f)}
+    {
+        invoke = [](internal::CancellationRegistration* registration) {
+            static_cast<CancellationCallback*>(registration)->m_f();
+        };
+
+        if (!token.can_be_cancelled()) return;
+        if (token.m_state->add(this)) m_state = std::move(token.m_state);
+        else m_f();
+    }
+
+    CancellationCallback(const CancellationCallback&) = delete;
+    CancellationCallback(CancellationCallback&&) = delete;
+    CancellationCallback& operator=(const CancellationCallback&) = delete;
+    CancellationCallback& operator=(CancellationCallback&&) = delete;
+
+    ~CancellationCallback()
+    {
+        if (m_state) m_state->remove(this);
+    }
+
+private:
+    F m_f;
+    std::shared_ptr<internal::CancellationState> m_state;
+};
+
+template <typename F>
+CancellationCallback(CancellationToken, F) -> CancellationCallback<F>;
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace internal {
+
+template <typename Promise>
+concept HasCancellationToken = requires(const Promise& promise) {
+    { promise.cancellation_token() } -> std::convertible_to<CancellationToken>;
+};
+
+template <typename Promise>
+CancellationToken cancellation_token_of(CoHandle<Promise> coroutine) noexcept
+{
+    if constexpr (HasCancellationToken<Promise>) {
+        return coroutine.promise().cancellation_token();
+    }
+    else {
+        return {};
+    }
+}
+
+struct CancellationAwaiter {
+    struct Resume {
+        CancellationAwaiter* awaiter;
+
+        void operator()() const
+        {
+            if (awaiter->m_suspended.exchange(true, std::memory_order::acq_rel)) {
+                awaiter->m_coroutine.resume();
+            }
+        }
+    };
+
+    CancellationToken token;
+    CoHandle<> m_coroutine;
+    std::atomic<bool> m_suspended{false};
+    std::optional<CancellationCallback<Resume>> m_callback;
+
+    explicit CancellationAwaiter(CancellationToken t) noexcept : token{std::move(t)} {}
+    CancellationAwaiter(CancellationAwaiter&& other) noexcept : token{std::move(other.token)} {}
+
+    bool await_ready() const noexcept { return token.is_cancellation_requested(); }
+
+    // Whoever comes second between the suspension and the callback resumes the coroutine.
+    bool await_suspend(CoHandle<> coroutine)
+    {
+        m_coroutine = coroutine;
+        m_callback.emplace(token, Resume{this});
+        return !m_suspended.exchange(true, std::memory_order::acq_rel);
+    }
+
+    void await_resume() noexcept { m_callback.reset(); }
+};
+
+struct CurrentCancellationToken {
+    CancellationToken token;
+
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    bool await_suspend(CoHandle<Promise> coroutine) noexcept
+    {
+        token = cancellation_token_of(coroutine);
+        return false;
+    }
+
+    CancellationToken await_resume() noexcept { return std::move(token); }
+};
+
+}  // namespace internal
+
+inline auto CancellationToken::operator co_await() const noexcept
+{
+    return internal::CancellationAwaiter{*this};
+}
+
+/// Token of the calling coroutine, the awaiting never suspends.
+inline internal::CurrentCancellationToken current_cancellation_token() noexcept { return {}; }
+
+}  // namespace ez::async
@@ -0,0 +1,495 @@
+#pragma once
+
+#include <ez/async/Types.hpp>
+#include <ez/async/internal/WaiterList.hpp>
+
+#include <ez/Contract.hpp>
+#include <ez/Option.hpp>
+#include <ez/RingBuffer.hpp>
+#include <ez/SpscQueue.hpp>
+#include <ez/Utils.hpp>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace ez::async {
+
+///
+/// Bounded multi producer, multi consumer channel between coroutines. Senders are suspended
+/// while the channel is full, receivers while it is empty; a suspended coroutine is resumed on
+/// the thread unblocking it. Once closed, sends fail and receivers drain the buffered values.
+/// Awaiting `receive` on several channels in `when_any` selects the first one with a value, the
+/// other receives are withdrawn when `when_any` completes. A receive abandoned after a sender
+/// handed it a value (a `when_any` loser resumed by another thread) gives the value back: it goes
+/// to the next receiver, before the buffered values.
+/// T must be default constructible, the buffer is allocated once.
+/// Usage:
+///   @code
+///   async::Channel<Request> requests{64};
+///   scope << [&]() -> async::Task<> {
+///       while (auto request = co_await requests.receive()) co_await handle(*request);
+///   };
+///   co_await requests.send(std::move(request));
+///   requests.close();
+///   @endcode
+template <typename T>
+class Channel : NonCopiable {
+    struct SendAwaiter;
+    struct ReceiveAwaiter;
+
+public:
+    explicit Channel(size_t capacity) : m_buffer{capacity} {}
+    Channel(Channel&&) = delete;
+
+    size_t capacity() const noexcept { return m_buffer.capacity(); }
+    size_t size() const;
+    bool is_closed() const;
+
+    /// Awaitable returning false when the channel is closed, the value is dropped in that case.
+    [[nodiscard]] SendAwaiter send(T value) { return {{}, this, std::move(value)}; }
+
+    /// Awaitable returning the next value, or nothing once the channel is closed and drained.
+    [[nodiscard]] ReceiveAwaiter receive() { return {{}, this}; }
+
+    /// Non suspending versions, `value` is moved only when sent.
+    bool try_send(T& value);
+    Option<T> try_receive();
+
+    /// Fails the pending and future sends, wakes up every suspended coroutine.
+    void close();
+
+private:
+    // A queued awaiter is resumed through its `wake_up`, claimed either by the thread resuming
+    // it or by the awaiter destroyed before.
+    template <typename Self>
+    struct Waiter {
+        Self* prev = nullptr;
+        Self* next = nullptr;
+        std::shared_ptr<internal::WakeUp> wake_up;
+        bool waiting = false;  // Guarded by the mutex of the channel.
+    };
+
+    struct SendAwaiter : Waiter<SendAwaiter> {
+        Channel* channel;
+        T value;
+        bool sent = false;
+
+        ~SendAwaiter() { channel->withdraw(channel->m_senders, *this); }
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(CoHandle<> coroutine) { return channel->suspend_send(*this, coroutine); }
+        bool await_resume() const noexcept { return sent; }
+    };
+
+    struct ReceiveAwaiter : Waiter<ReceiveAwaiter> {
+        Channel* channel;
+        Option<T> value;
+
+        ~ReceiveAwaiter() { channel->withdraw(channel->m_receivers, *this); }
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(CoHandle<> coroutine)
+        {
+            return channel->suspend_receive(*this, coroutine);
+        }
+        Option<T> await_resume() { return std::move(value); }
+    };
+
+    bool suspend_send(SendAwaiter& sender, CoHandle<> coroutine);
+    bool suspend_receive(ReceiveAwaiter& receiver, CoHandle<> coroutine);
+    bool deliver(T& value, std::unique_lock<std::mutex>& lock);
+    Option<T> take_locked();
+    void refill_from_sender(std::unique_lock<std::mutex>& lock);
+
+    template <typename Awaiter>
+    void withdraw(internal::WaiterList<Awaiter>& list, Awaiter& awaiter);
+    void give_back(T& value);
+
+    template <typename Awaiter>
+    static void enqueue(internal::WaiterList<Awaiter>& list, Awaiter& awaiter, CoHandle<> handle);
+
+    mutable std::mutex m_mutex;
+    RingBuffer<T> m_buffer;
+    std::deque<T> m_returned;  // Given back by abandoned receives, received first.
+    internal::WaiterList<SendAwaiter> m_senders;
+    internal::WaiterList<ReceiveAwaiter> m_receivers;
+    bool m_closed = false;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///
+/// Bounded channel between a single sending coroutine and a single receiving one. Values go
+/// through a lock free `SpscQueue`, a side only touches the other one's state when it has to
+/// suspend or to wake it up. Same close semantics as `Channel`, an abandoned send or receive
+/// leaves its value where it is.
+/// Usage:
+///   @code
+///   async::SpscChannel<Frame> frames{256};
+///   co_await frames.send(frame);             // producer coroutine
+///   Option<Frame> next = co_await frames.receive();  // consumer coroutine
+///   @endcode
+template <typename T>
+class SpscChannel : NonCopiable {
+    struct SendAwaiter;
+    struct ReceiveAwaiter;
+
+public:
+    explicit SpscChannel(size_t capacity) : m_queue{capacity} {}
+    SpscChannel(SpscChannel&&) = delete;
+
+    size_t capacity() const noexcept { return m_queue.capacity(); }
+    size_t size() const noexcept { return m_queue.size(); }
+    bool is_closed() const noexcept { return m_closed.load(std::memory_order::acquire); }
+
+    [[nodiscard]] SendAwaiter send(T value) { return {this, std::move(value)}; }
+    [[nodiscard]] ReceiveAwaiter receive() { return {this}; }
+
+    void close();
+
+private:
+    struct SendAwaiter {
+        SpscChannel* channel;
+        T value;
+        std::shared_ptr<internal::WakeUp> wake_up;
+        bool sent = false;
+
+        ~SendAwaiter() { withdraw(channel->m_sender, wake_up); }
+
+        bool await_ready()
+        {
+            if (channel->is_closed()) return true;
+            return sent = channel->try_send(value);
+        }
+
+        bool await_suspend(CoHandle<> coroutine)
+        {
+            wake_up = std::make_shared<internal::WakeUp>(coroutine);
+            return channel->park(channel->m_sender, wake_up, [channel = channel] {
+                return channel->m_queue.size() != channel->capacity();
+            });
+        }
+
+        bool await_resume()
+        {
+            if (sent || channel->is_closed()) return sent;
+            sent = channel->try_send(value);
+            EZ_ASSERT(sent);
+            return sent;
+        }
+    };
+
+    struct ReceiveAwaiter {
+        SpscChannel* channel;
+        Option<T> value;
+        std::shared_ptr<internal::WakeUp> wake_up;
+
+        ~ReceiveAwaiter() { withdraw(channel->m_receiver, wake_up); }
+
+        bool await_ready()
+        {
+            value = channel->try_receive();
+            // Values sent before the close are still delivered.
+            if (!value && channel->is_closed()) value = channel->try_receive();
+            return value || channel->is_closed();
+        }
+
+        bool await_suspend(CoHandle<> coroutine)
+        {
+            wake_up = std::make_shared<internal::WakeUp>(coroutine);
+            return channel->park(channel->m_receiver, wake_up,
+                                 [channel = channel] { return !channel->m_queue.empty(); });
+        }
+
+        Option<T> await_resume()
+        {
+            if (!value) value = channel->try_receive();
+            return std::move(value);
+        }
+    };
+
+    bool try_send(T& value);
+    Option<T> try_receive();
+
+    // The suspended coroutine of a side. `parked` is checked without locking by the other side
+    // after each push or pop, the mutex is only taken to park and to wake up.
+    struct Slot {
+        std::atomic<bool> parked{false};
+        std::mutex mutex;
+        std::shared_ptr<internal::WakeUp> wake_up;
+    };
+
+    bool park(Slot& slot, const std::shared_ptr<internal::WakeUp>& wake_up, auto can_proceed);
+    static void wake(Slot& slot);
+    static void take_back(Slot& slot, const internal::WakeUp& wake_up);
+    static void withdraw(Slot& slot, const std::shared_ptr<internal::WakeUp>& wake_up);
+
+    static constexpr size_t cache_line = 64;
+
+    SpscQueue<T> m_queue;
+    alignas(cache_line) Slot m_sender;
+    alignas(cache_line) Slot m_receiver;
+    std::atomic<bool> m_closed{false};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+size_t Channel<T>::size() const
+{
+    std::lock_guard lock{m_mutex};
+    return m_returned.size() + m_buffer.size();
+}
+
+template <typename T>
+bool Channel<T>::is_closed() const
+{
+    std::lock_guard lock{m_mutex};
+    return m_closed;
+}
+
+template <typename T>
+bool Channel<T>::try_send(T& value)
+{
+    std::unique_lock lock{m_mutex};
+    if (m_closed) return false;
+    return deliver(value, lock);
+}
+
+template <typename T>
+Option<T> Channel<T>::try_receive()
+{
+    std::unique_lock lock{m_mutex};
+    Option<T> value = take_locked();
+    if (value) refill_from_sender(lock);
+    return value;
+}
+
+template <typename T>
+void Channel<T>::close()
+{
+    std::vector<std::shared_ptr<internal::WakeUp>> wake_ups;
+    {
+        std::lock_guard lock{m_mutex};
+        m_closed = true;
+        while (ReceiveAwaiter* receiver = m_receivers.pop_front()) {
+            receiver->waiting = false;
+            wake_ups.push_back(receiver->wake_up);
+        }
+        while (SendAwaiter* sender = m_senders.pop_front()) {
+            sender->waiting = false;
+            wake_ups.push_back(sender->wake_up);
+        }
+    }
+
+    // Resuming one of them may destroy the others, the awaiters are not touched anymore.
+    for (auto& wake_up : wake_ups) wake_up->resume_if_unclaimed();
+}
+
+template <typename T>
+template <typename Awaiter>
+void Channel<T>::enqueue(internal::WaiterList<Awaiter>& list, Awaiter& awaiter, CoHandle<> handle)
+{
+    awaiter.wake_up = std::make_shared<internal::WakeUp>(handle);
+    awaiter.waiting = true;
+    list.push_back(&awaiter);
+}
+
+template <typename T>
+bool Channel<T>::suspend_send(SendAwaiter& sender, CoHandle<> coroutine)
+{
+    std::unique_lock lock{m_mutex};
+    if (m_closed) return false;
+    if (deliver(sender.value, lock)) {
+        sender.sent = true;
+        return false;
+    }
+
+    enqueue(m_senders, sender, coroutine);
+    return true;
+}
+
+template <typename T>
+bool Channel<T>::suspend_receive(ReceiveAwaiter& receiver, CoHandle<> coroutine)
+{
+    std::unique_lock lock{m_mutex};
+    if ((receiver.value = take_locked())) {
+        refill_from_sender(lock);
+        return false;
+    }
+    if (m_closed) return false;
+
+    enqueue(m_receivers, receiver, coroutine);
+    return true;
+}
+
+// Hands `value` to the first suspended receiver, resumed once unlocked, or buffers it.
+template <typename T>
+bool Channel<T>::deliver(T& value, std::unique_lock<std::mutex>& lock)
+{
+    if (ReceiveAwaiter* receiver = m_receivers.pop_front()) {
+        receiver->value = std::move(value);
+        receiver->waiting = false;
+        std::shared_ptr<internal::WakeUp> wake_up = receiver->wake_up;
+        lock.unlock();
+        wake_up->resume_if_unclaimed();
+        return true;
+    }
+    if (m_buffer.full()) return false;
+
+    m_buffer.push_back(std::move(value));
+    return true;
+}
+
+template <typename T>
+Option<T> Channel<T>::take_locked()
+{
+    Option<T> value;
+    if (!m_returned.empty()) {
+        value = std::move(m_returned.front());
+        m_returned.pop_front();
+    }
+    else if (!m_buffer.empty()) {
+        value = std::move(m_buffer.front());
+        m_buffer.pop_front();
+    }
+    return value;
+}
+
+// A slot may have been freed, the first suspended sender fills it and is resumed once unlocked.
+template <typename T>
+void Channel<T>::refill_from_sender(std::unique_lock<std::mutex>& lock)
+{
+    if (m_buffer.full()) return;
+    SendAwaiter* sender = m_senders.pop_front();
+    if (sender == nullptr) return;
+
+    m_buffer.push_back(std::move(sender->value));
+    sender->sent = true;
+    sender->waiting = false;
+    std::shared_ptr<internal::WakeUp> wake_up = sender->wake_up;
+    lock.unlock();
+    wake_up->resume_if_unclaimed();
+}
+
+// A receive handed a value but destroyed before its resumption gives the value back, a send
+// already delivered its value.
+template <typename T>
+template <typename Awaiter>
+void Channel<T>::withdraw(internal::WaiterList<Awaiter>& list, Awaiter& awaiter)
+{
+    if (!awaiter.wake_up) return;
+
+    {
+        std::lock_guard lock{m_mutex};
+        if (awaiter.waiting) {
+            list.remove(&awaiter);
+            return;
+        }
+    }
+    if (!awaiter.wake_up->claim()) return;
+
+    if constexpr (std::is_same_v<Awaiter, ReceiveAwaiter>) {
+        if (awaiter.value) give_back(*awaiter.value);
+    }
+}
+
+template <typename T>
+void Channel<T>::give_back(T& value)
+{
+    std::unique_lock lock{m_mutex};
+    if (!m_receivers.empty()) {
+        deliver(value, lock);
+        return;
+    }
+    m_returned.push_back(std::move(value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void SpscChannel<T>::close()
+{
+    m_closed.store(true, std::memory_order::seq_cst);
+    wake(m_receiver);
+    wake(m_sender);
+}
+
+template <typename T>
+bool SpscChannel<T>::try_send(T& value)
+{
+    if (!m_queue.try_push(std::move(value))) return false;
+    wake(m_receiver);
+    return true;
+}
+
+template <typename T>
+Option<T> SpscChannel<T>::try_receive()
+{
+    Option<T> value = m_queue.try_pop();
+    if (value) wake(m_sender);
+    return value;
+}
+
+// Publishes the coroutine in `slot`, then checks the queue again: either the other side sees the
+// coroutine and wakes it up, or it is taken back here and the awaiter does not suspend.
+template <typename T>
+bool SpscChannel<T>::park(Slot& slot,
+                          const std::shared_ptr<internal::WakeUp>& wake_up,
+                          auto can_proceed)
+{
+    {
+        std::lock_guard lock{slot.mutex};
+        slot.wake_up = wake_up;
+        slot.parked.store(true, std::memory_order::seq_cst);
+    }
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+
+    if (!can_proceed() && !is_closed()) return true;
+
+    take_back(slot, *wake_up);
+    // Lost the race: the other side already claimed the coroutine and resumes it.
+    return !wake_up->claim();
+}
+
+template <typename T>
+void SpscChannel<T>::wake(Slot& slot)
+{
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    if (!slot.parked.load(std::memory_order::relaxed)) return;
+
+    std::shared_ptr<internal::WakeUp> wake_up;
+    {
+        std::lock_guard lock{slot.mutex};
+        wake_up = std::move(slot.wake_up);
+        slot.parked.store(false, std::memory_order::relaxed);
+    }
+    if (wake_up) wake_up->resume_if_unclaimed();
+}
+
+template <typename T>
+void SpscChannel<T>::take_back(Slot& slot, const internal::WakeUp& wake_up)
+{
+    std::lock_guard lock{slot.mutex};
+    if (slot.wake_up.get() == &wake_up) {
+        slot.wake_up.reset();
+        slot.parked.store(false, std::memory_order::relaxed);
+    }
+}
+
+// The coroutine is claimed even when the other side already took it: a destroyed awaiter is
+// never resumed.
+template <typename T>
+void SpscChannel<T>::withdraw(Slot& slot, const std::shared_ptr<internal::WakeUp>& wake_up)
+{
+    if (!wake_up) return;
+
+    take_back(slot, *wake_up);
+    wake_up->claim();
+}
+
+}  // namespace ez::async
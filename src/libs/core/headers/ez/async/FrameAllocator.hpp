@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ez/Utils.hpp>
+
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+namespace ez::async {
+
+/// Coroutine frame allocations of the calling thread, see `PooledFrame`.
+struct FrameAllocationStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t pooled = 0;  // Allocations served by the free lists of the thread.
+    size_t arena = 0;   // Allocations served by a caller provided memory resource.
+    size_t bytes = 0;   // Requested frame sizes.
+};
+
+FrameAllocationStats frame_allocation_stats() noexcept;
+void reset_frame_allocation_stats() noexcept;
+
+/// Returns the blocks cached by the calling thread to the global heap.
+void release_cached_frames() noexcept;
+
+namespace internal {
+
+void* allocate_frame(size_t size, std::pmr::memory_resource* arena);
+void deallocate_frame(void* frame, size_t size) noexcept;
+
+// The memory resource following a `std::allocator_arg` in the coroutine parameters, if any.
+template <typename... Args>
+std::pmr::memory_resource* find_frame_arena(const Args&... args) noexcept
+{
+    std::pmr::memory_resource* arena = nullptr;
+    bool after_tag = false;
+    auto visit = [&]<typename Arg>(const Arg& arg) {
+        if constexpr (std::is_convertible_v<const Arg&, std::pmr::memory_resource*>) {
+            if (after_tag && arena == nullptr) arena = arg;
+        }
+        after_tag = std::is_same_v<Arg, std::allocator_arg_t>;
+    };
+    (visit(args), ...);
+    return arena;
+}
+
+}  // namespace internal
+
+///
+/// Base of the promise types whose coroutine frames avoid the global allocator. Frames come from
+/// per thread free lists, one per 64 bytes size class up to 1 KiB; a frame released on another
+/// thread goes to the free lists of that thread. Bigger frames use `operator new`.
+/// A coroutine taking `std::allocator_arg, std::pmr::memory_resource*` among its parameters
+/// allocates its frame from that resource instead, e.g. a monotonic arena per request.
+/// Usage:
+///   @code
+///   Task<int> eval(std::allocator_arg_t, std::pmr::memory_resource*, const Node& node);
+///
+///   std::pmr::monotonic_buffer_resource arena;
+///   int value = co_await eval(std::allocator_arg, &arena, root);
+///   @endcode
+struct PooledFrame {
+    static void* operator new(size_t size) { return internal::allocate_frame(size, nullptr); }
+
+    template <typename... Args>
+    static void* operator new(size_t size, const Args&... args)
+    {
+        return internal::allocate_frame(size, internal::find_frame_arena(args...));
+    }
+
+    static void operator delete(void* frame, size_t size) noexcept
+    {
+        internal::deallocate_frame(frame, size);
+    }
+};
+
+}  // namespace ez::async
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <ez/async/FrameAllocator.hpp>
+#include <ez/async/Types.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+
+namespace ez::async {
+
+template <typename T>
+class Generator;
+
+namespace internal {
+
+// A generator of values hands them over as rvalue references, a generator of references as is.
+template <typename T>
+using GeneratorReference = std::conditional_t<std::is_reference_v<T>, T, T&&>;
+
+// Keeps a copy of an lvalue yielded by a generator of values, in the suspended frame.
+template <typename T, typename Promise>
+struct YieldCopyAwaiter {
+    std::remove_cvref_t<T> value;
+
+    bool await_ready() const noexcept { return false; }
+    auto await_suspend(CoHandle<Promise> coroutine) noexcept
+    {
+        coroutine.promise().set_value(std::addressof(value));
+        return coroutine.promise().yield_target();
+    }
+    void await_resume() const noexcept {}
+};
+
+template <typename T>
+class GeneratorPromise : public PooledFrame {
+public:
+    using Reference = GeneratorReference<T>;
+    using Pointer = std::add_pointer_t<Reference>;
+
+    Generator<T> get_return_object() noexcept;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    std::suspend_always final_suspend() const noexcept { return {}; }
+
+    std::suspend_always yield_value(Reference value) noexcept
+    {
+        m_value = std::addressof(value);
+        return {};
+    }
+
+    auto yield_value(const std::remove_reference_t<T>& value)
+        requires(!std::is_reference_v<T> && std::is_copy_constructible_v<T>)
+    {
+        return YieldCopyAwaiter<T, GeneratorPromise>{value};
+    }
+
+    // Synchronous: the body yields but does not await.
+    void await_transform(auto&&) = delete;
+
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+    void set_value(Pointer value) noexcept { m_value = value; }
+    std::noop_coroutine_handle yield_target() const noexcept { return std::noop_coroutine(); }
+
+    Reference value() const noexcept { return static_cast<Reference>(*m_value); }
+
+    void rethrow_if_failed()
+    {
+        if (m_exception) std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+
+private:
+    Pointer m_value = nullptr;
+    std::exception_ptr m_exception;
+};
+
+}  // namespace internal
+
+///
+/// Lazy sequence produced by a coroutine with `co_yield`, consumed as an input range. The body
+/// runs up to the next `co_yield` each time the iterator is incremented, the yielded values are
+/// handed over by reference without copy (an lvalue yielded by a generator of values is copied
+/// once in the frame). The only allocation is the coroutine frame, taken from the frame pool.
+/// An exception thrown by the body is rethrown by `begin()` or the increment.
+/// Usage:
+///   @code
+///   async::Generator<Page> pages(Database& db)
+///   {
+///       for (auto cursor = db.open(); !cursor.done(); cursor.next()) co_yield cursor.page();
+///   }
+///
+///   for (auto&& page : pages(db)) store(page);
+///   auto big = rpl::run(pages(db), rpl::filter(is_big), rpl::to_vector());
+///   @endcode
+template <typename T>
+class [[nodiscard]] Generator : public std::ranges::view_interface<Generator<T>> {
+public:
+    using promise_type = internal::GeneratorPromise<T>;
+    using Reference = typename promise_type::Reference;
+
+    class Iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = std::remove_cvref_t<T>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        explicit Iterator(CoHandle<promise_type> coroutine) : m_coroutine{coroutine} {}
+        Iterator(Iterator&&) = default;
+        Iterator& operator=(Iterator&&) = default;
+
+        Reference operator*() const noexcept { return m_coroutine.promise().value(); }
+
+        Iterator& operator++()
+        {
+            m_coroutine.resume();
+            m_coroutine.promise().rethrow_if_failed();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const Iterator& it, std::default_sentinel_t) noexcept
+        {
+            return it.m_coroutine.done();
+        }
+
+    private:
+        CoHandle<promise_type> m_coroutine;
+    };
+
+    explicit Generator(CoHandle<promise_type> coroutine) noexcept : m_coroutine{coroutine} {}
+    Generator(Generator&& other) noexcept = default;
+    Generator& operator=(Generator&& other) noexcept = default;
+
+    /// Runs the body up to its first `co_yield`, must be called once.
+    Iterator begin()
+    {
+        CoHandle<promise_type> coroutine = m_coroutine.get();
+        coroutine.resume();
+        coroutine.promise().rethrow_if_failed();
+        return Iterator{coroutine};
+    }
+
+    std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    UniqueCoroutine<promise_type> m_coroutine;
+};
+
+namespace internal {
+
+template <typename T>
+Generator<T> GeneratorPromise<T>::get_return_object() noexcept
+{
+    return Generator<T>{CoHandle<GeneratorPromise>::from_promise(*this)};
+}
+
+}  // namespace internal
+
+}  // namespace ez::async
@@ -1,8 +1,13 @@
 #pragma once
 
-#include <ez/Shared.hpp>
+#include <ez/async/Cancellation.hpp>
 #include <ez/async/Types.hpp>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+
 namespace ez::async {
 
 namespace traits {
@@ -19,34 +24,107 @@ concept Operation = requires(Op& op){
 
 }  // namespace traits
 
+///
+/// Awaitable over a callback based operation. `Impl::cancel()` is called when the token of the
+/// awaiting coroutine is cancelled, the operation must still complete (with an error or
+/// OperationCancelled) and call its continuation.
+/// The implementation is kept alive until its completion handler runs. The continuation belongs
+/// to the awaiter of each `co_await`: an awaiting frame destroyed while pending (a `when_any`
+/// loser) cancels the operation and is never resumed, even when the Operation outlives it.
 template <traits::Operation Impl>
-struct Operation {
+class Operation {
+    struct State;
+    struct Cancel;
+
+public:
     using ReturnType = decltype(std::declval<Impl&>().result());
 
-    Impl impl;
-    Shared<bool> m_done{false};
+    template <typename... Args>
+        requires(!(sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, Operation> && ...)))
+    Operation(Args&&... args) : m_state{std::make_shared<State>(EZ_FWD(args)...)}
+    {
+    }
 
-    Operation(auto&&... args) : impl{EZ_FWD(args)...} {}
+    Operation(Operation&& other) noexcept = default;
 
-    bool await_ready() { return impl.done(); }
+    class Awaiter {
+    public:
+        explicit Awaiter(std::shared_ptr<State> state) : m_state{std::move(state)} {}
+        Awaiter(const Awaiter&) = delete;
 
-    void await_suspend(CoHandle<> coroutine)
-    {
-        impl.start([coroutine, done = m_done]() mutable {
-            safe_resume(coroutine);
-            done = true;
-        });
-    }
+        ~Awaiter()
+        {
+            if (m_state->continuation.exchange(nullptr, std::memory_order::acq_rel)) {
+                m_state->cancel();
+            }
+        }
 
-    auto await_resume() { return impl.result(); }
+        bool await_ready() { return m_state->impl.done(); }
 
-    bool cancel()
-    {
-        if (m_done.value()) return false;
-        impl.cancel();
-        m_done = true;
-        return true;
-    }
+        template <typename Promise>
+        void await_suspend(CoHandle<Promise> coroutine)
+        {
+            auto state = m_state;
+            state->continuation.store(coroutine.address(), std::memory_order::release);
+            m_cancellation.emplace(internal::cancellation_token_of(coroutine), Cancel{state});
+
+            std::lock_guard lock{state->mutex};
+            state->impl.start([state]() mutable {
+                state->done.store(true, std::memory_order::release);
+                void* address = state->continuation.exchange(nullptr, std::memory_order::acq_rel);
+                if (address) CoHandle<>::from_address(address).resume();
+            });
+            state->started = true;
+            if (state->cancel_requested) state->impl.cancel();
+        }
+
+        auto await_resume()
+        {
+            m_cancellation.reset();
+            return m_state->impl.result();
+        }
+
+    private:
+        std::shared_ptr<State> m_state;
+        std::optional<CancellationCallback<Cancel>> m_cancellation;
+    };
+
+    Awaiter operator co_await() const noexcept { return Awaiter{m_state}; }
+
+    /// False when the operation already completed or was cancelled.
+    bool cancel() { return m_state->cancel(); }
+
+private:
+    struct State {
+        State(auto&&... args) : impl{EZ_FWD(args)...} {}
+
+        bool cancel()
+        {
+            std::lock_guard lock{mutex};
+            if (cancel_requested || done.load(std::memory_order::acquire)) return false;
+            cancel_requested = true;
+            if (started) impl.cancel();
+            return true;
+        }
+
+        Impl impl;
+        std::atomic<void*> continuation{nullptr};
+        std::atomic<bool> done{false};
+
+        // Orders the start and the cancellation, a cancellation requested before the start is
+        // applied right after it.
+        std::mutex mutex;
+        bool started = false;
+        bool cancel_requested = false;
+    };
+
+    struct Cancel {
+        std::shared_ptr<State> state;
+
+        void operator()() const { state->cancel(); }
+    };
+
+    std::shared_ptr<State> m_state;
 };
 
 }  // namespace ez::async
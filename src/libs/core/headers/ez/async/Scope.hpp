@@ -1,34 +1,177 @@
 #pragma once
 
 #include <ez/async/Executor.hpp>
+#include <ez/async/FrameAllocator.hpp>
 #include <ez/async/Task.hpp>
+#include <ez/async/internal/WaiterList.hpp>
 
 #include <ez/Shared.hpp>
 #include <ez/Traits.hpp>
+#include <ez/Utils.hpp>
 
-#include <algorithm>
-
-#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <vector>
 
 namespace ez::async {
 
+struct ScopeStats {
+    size_t spawned = 0;
+    size_t active = 0;
+    size_t queued = 0;
+    size_t completed = 0;  // Including the failed ones.
+    size_t failed = 0;
+    size_t peak_active = 0;
+};
+
+namespace internal {
+
+class ScopeState;
+struct ScopeTask;
+struct ScopeSpawner;
+
+// Frame wrapping a task spawned in a scope, it links itself in the scope and destroys itself
+// once the task completed.
+struct ScopeTaskPromise : PooledFrame {
+    ScopeTaskPromise* prev = nullptr;
+    ScopeTaskPromise* next = nullptr;
+    ScopeState* scope = nullptr;
+    ScopeSpawner* spawner = nullptr;  // Producer suspended in `spawn` until the task starts.
+    std::exception_ptr error;
+
+    ScopeTask get_return_object() noexcept;
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    auto final_suspend() const noexcept;
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+struct ScopeTask {
+    using promise_type = ScopeTaskPromise;
+
+    CoHandle<ScopeTaskPromise> handle;
+};
+
+inline ScopeTask ScopeTaskPromise::get_return_object() noexcept
+{
+    return {CoHandle<ScopeTaskPromise>::from_promise(*this)};
+}
+
+struct ScopeSpawner {
+    CoHandle<> producer;
+    ScopeTaskPromise* queued = nullptr;
+};
+
+struct ScopeJoiner {
+    ScopeJoiner* prev = nullptr;
+    ScopeJoiner* next = nullptr;
+    CoHandle<> continuation;
+    bool queued = false;
+};
+
+// Bookkeeping of a Scope, independent of its context. The tasks run at most `max_active` at a
+// time, the others wait in a FIFO. Completions may come from any thread.
+class ScopeState {
+public:
+    using Post = void (*)(void* context, CoHandle<> coroutine);
+
+    ScopeState(void* context, Post post, size_t max_active);
+    ScopeState(const ScopeState&) = delete;
+    ~ScopeState();
+
+    // True when the task is started now, false when it is queued: the producer of the spawner
+    // is then resumed once the task starts.
+    bool spawn(CoHandle<ScopeTaskPromise> task, ScopeSpawner* spawner = nullptr);
+    void complete(ScopeTaskPromise& task);
+
+    // False when the scope is already idle.
+    bool add_joiner(ScopeJoiner& joiner);
+    void remove_joiner(ScopeJoiner& joiner);
+    void remove_spawner(ScopeSpawner& spawner);
+    bool is_idle() const;
+
+    ScopeStats stats() const;
+    std::vector<std::exception_ptr> take_errors();
+
+    // Exceptions kept until take_errors, the failures past it are only counted: a scope whose
+    // errors are never taken does not grow.
+    static constexpr size_t max_errors = 64;
+
+private:
+    void start_locked(ScopeTaskPromise& task);
+
+    void* m_context;
+    Post m_post;
+    const size_t m_max_active;
+
+    mutable std::mutex m_mutex;
+    WaiterList<ScopeTaskPromise> m_active;
+    WaiterList<ScopeTaskPromise> m_queued;
+    WaiterList<ScopeJoiner> m_joiners;
+    ScopeStats m_stats;
+    std::vector<std::exception_ptr> m_errors;
+};
+
+inline auto ScopeTaskPromise::final_suspend() const noexcept
+{
+    struct Completion {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(CoHandle<ScopeTaskPromise> coroutine) const noexcept
+        {
+            coroutine.promise().scope->complete(coroutine.promise());
+            coroutine.destroy();
+        }
+        void await_resume() const noexcept {}
+    };
+    return Completion{};
+}
+
+inline ScopeTask make_scope_task(Task<> task) { co_await task; }
+
+}  // namespace internal
+
+///
+/// Owns detached tasks started on a context. At most `max_active` tasks run at a time, the
+/// others are queued in spawn order. A completed task is released right away. The tasks left
+/// are destroyed with the scope. The scope is not movable, `operator<<` and `spawn` must be
+/// called from one thread at a time but the tasks may complete on any thread.
+/// Usage:
+///   @code
+///   async::Scope scope{context, 64};
+///   for (auto& request : requests) co_await scope.spawn(handle(request));
+///   co_await scope.join();
+///   auto failed = scope.stats().failed;
+///   @endcode
 template <typename Context>
 class Scope {
 public:
-    Scope(Context& ctx) : m_context{ctx} {}
+    static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+
+    Scope(Context& ctx, size_t max_active = unlimited);
 
     Context& context();
     const Context& context() const;
 
+    /// Never suspends: over the limit the task is queued.
     Scope& operator<<(Task<> task);
     Scope& operator<<(trait::Fn<Task<>()> auto&& callable);
 
-private:
-    void cleanup();
+    /// Awaitable starting the task, the producer is suspended until the task is started.
+    auto spawn(Task<> task);
+
+    /// Awaitable completing once no task is active or queued.
+    auto join();
+
+    ScopeStats stats() const { return m_state.stats(); }
+
+    /// The exceptions of the failed tasks since the last call, the first 64 of them. All the
+    /// failures are counted in `stats().failed`.
+    std::vector<std::exception_ptr> take_errors() { return m_state.take_errors(); }
 
 private:
     Ref<Context> m_context;
-    std::deque<Task<>> m_tasks;
+    internal::ScopeState m_state;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -36,13 +179,25 @@ private:
 template <typename T>
 Scope(T&) -> Scope<T>;
 
+template <typename T>
+Scope(T&, size_t) -> Scope<T>;
+
+template <typename Context>
+Scope<Context>::Scope(Context& ctx, size_t max_active)
+    : m_context{ctx},
+      m_state{&ctx,
+              [](void* context, CoHandle<> coroutine) {
+                  async::post(*static_cast<Context*>(context),
+                              [coroutine]() mutable { coroutine.resume(); });
+              },
+              max_active}
+{
+}
+
 template <typename Context>
 Scope<Context>& Scope<Context>::operator<<(Task<> task)
 {
-    cleanup();
-    auto handle = task.handle();
-    m_tasks.push_back(std::move(task));
-    async::post(m_context.get(), [handle]() mutable { handle.resume(); });
+    m_state.spawn(internal::make_scope_task(std::move(task)).handle);
     return *this;
 }
 
@@ -53,22 +208,65 @@ Scope<Context>& Scope<Context>::operator<<(trait::Fn<Task<>()> auto&& callable)
 }
 
 template <typename Context>
-Context& Scope<Context>::context()
+auto Scope<Context>::spawn(Task<> task)
 {
-    return m_context;
+    struct SpawnAwaiter : internal::ScopeSpawner {
+        internal::ScopeState& state;
+        Task<> task;
+
+        SpawnAwaiter(internal::ScopeState& state, Task<> task)
+            : state{state}, task{std::move(task)}
+        {
+        }
+        SpawnAwaiter(const SpawnAwaiter&) = delete;
+
+        // A producer destroyed while waiting must not be resumed.
+        ~SpawnAwaiter() { state.remove_spawner(*this); }
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(CoHandle<> awaiting_coroutine)
+        {
+            producer = awaiting_coroutine;
+            return !state.spawn(internal::make_scope_task(std::move(task)).handle, this);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    return SpawnAwaiter{m_state, std::move(task)};
 }
 
 template <typename Context>
-const Context& Scope<Context>::context() const
+auto Scope<Context>::join()
+{
+    struct JoinAwaiter : internal::ScopeJoiner {
+        internal::ScopeState& state;
+
+        JoinAwaiter(internal::ScopeState& state) : state{state} {}
+        JoinAwaiter(const JoinAwaiter&) = delete;
+        ~JoinAwaiter() { state.remove_joiner(*this); }
+
+        bool await_ready() const { return state.is_idle(); }
+        bool await_suspend(CoHandle<> awaiting_coroutine)
+        {
+            continuation = awaiting_coroutine;
+            return state.add_joiner(*this);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    return JoinAwaiter{m_state};
+}
+
+template <typename Context>
+Context& Scope<Context>::context()
 {
     return m_context;
 }
 
 template <typename Context>
-void Scope<Context>::cleanup()
+const Context& Scope<Context>::context() const
 {
-    auto ret = std::ranges::remove_if(m_tasks, [](auto& task) { return task.done(); });
-    m_tasks.erase(ret.begin(), ret.end());
+    return m_context;
 }
 
 }  // namespace ez::async
@@ -0,0 +1,516 @@
+#pragma once
+
+#include <ez/async/Executor.hpp>
+#include <ez/async/Types.hpp>
+#include <ez/async/internal/WaiterList.hpp>
+
+#include <ez/Contract.hpp>
+#include <ez/Utils.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ez::async {
+
+namespace internal {
+
+template <typename E>
+void post_resume(void* executor, std::shared_ptr<WakeUp> wake_up)
+{
+    async::post(*static_cast<E*>(executor),
+                [wake_up = std::move(wake_up)] { wake_up->resume_if_unclaimed(); });
+}
+
+// Coroutine suspended on a primitive, resumed inline by the thread releasing it or posted to the
+// executor given to the `*_on` awaitables.
+struct SyncWaiter {
+    SyncWaiter* prev = nullptr;
+    SyncWaiter* next = nullptr;
+    CoHandle<> handle;
+    void (*post)(void* executor, std::shared_ptr<WakeUp> wake_up) = nullptr;
+    void* executor = nullptr;
+    std::shared_ptr<WakeUp> wake_up;  // Created once queued.
+    bool waiting = false;             // Guarded by the mutex of the primitive.
+    bool queued = false;              // Only touched by the awaiting coroutine.
+};
+
+using SyncWaiterList = WaiterList<SyncWaiter>;
+
+// Granted waiters, resumed once the mutex of the primitive is released. Their awaiters are not
+// touched anymore: resuming one of them may destroy the others.
+using WakeUps = std::vector<std::shared_ptr<WakeUp>>;
+
+inline void resume_all(WakeUps& wake_ups)
+{
+    for (auto& wake_up : wake_ups) resume(std::move(wake_up));
+}
+
+// Awaitable of the primitives. `Primitive::suspend(waiter)` returns false when the waiter
+// proceeds right away, otherwise the waiter is queued and resumed by a release. A non void
+// `Result` is constructed from the primitive once it proceeds.
+template <typename Primitive, typename Result = void>
+class SyncAwaiter : SyncWaiter {
+public:
+    explicit SyncAwaiter(Primitive& primitive) : m_primitive{primitive} {}
+
+    template <typename E>
+    SyncAwaiter(Primitive& primitive, E& executor) : m_primitive{primitive}
+    {
+        post = &post_resume<E>;
+        this->executor = &executor;
+    }
+
+    SyncAwaiter(const SyncAwaiter&) = delete;
+    SyncAwaiter& operator=(const SyncAwaiter&) = delete;
+
+    // A waiter granted the primitive but destroyed before being resumed gives the grant back.
+    ~SyncAwaiter()
+    {
+        if (queued) m_primitive.withdraw(*this);
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(CoHandle<> coroutine)
+    {
+        handle = coroutine;
+        return m_primitive.suspend(*this);
+    }
+
+    Result await_resume() const noexcept
+    {
+        if constexpr (!std::is_void_v<Result>) return Result{m_primitive};
+    }
+
+private:
+    Primitive& m_primitive;
+};
+
+}  // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AsyncMutex;
+
+/// Owns an `AsyncMutex` lock, unlocks it when destroyed.
+class AsyncLockGuard {
+public:
+    explicit AsyncLockGuard(AsyncMutex& mutex) noexcept : m_mutex{&mutex} {}
+    AsyncLockGuard(AsyncLockGuard&& other) noexcept
+        : m_mutex{std::exchange(other.m_mutex, nullptr)}
+    {
+    }
+    AsyncLockGuard& operator=(AsyncLockGuard&& other) noexcept;
+    ~AsyncLockGuard() { unlock(); }
+
+    void unlock() noexcept;
+
+private:
+    AsyncMutex* m_mutex = nullptr;
+};
+
+///
+/// Mutex for coroutines: waiting for the lock suspends the coroutine instead of blocking its
+/// thread. The lock is handed over to the waiters in FIFO order, a newcomer never overtakes
+/// them. Waiters are resumed by the thread unlocking, or on the executor given to `lock_on`.
+/// Usage:
+///   @code
+///   async::AsyncMutex mutex;
+///   {
+///       auto lock = co_await mutex.scoped_lock();
+///       co_await write(connection, message);
+///   }
+///   @endcode
+class AsyncMutex : NonCopiable {
+public:
+    AsyncMutex() = default;
+    AsyncMutex(AsyncMutex&&) = delete;
+
+    [[nodiscard]] auto lock() { return internal::SyncAwaiter<AsyncMutex>{*this}; }
+
+    template <typename E>
+    [[nodiscard]] auto lock_on(E& executor)
+    {
+        return internal::SyncAwaiter<AsyncMutex>{*this, executor};
+    }
+
+    /// Awaitable locking the mutex and returning the guard unlocking it.
+    [[nodiscard]] auto scoped_lock()
+    {
+        return internal::SyncAwaiter<AsyncMutex, AsyncLockGuard>{*this};
+    }
+
+    template <typename E>
+    [[nodiscard]] auto scoped_lock_on(E& executor)
+    {
+        return internal::SyncAwaiter<AsyncMutex, AsyncLockGuard>{*this, executor};
+    }
+
+    bool try_lock();
+    void unlock();
+
+private:
+    template <typename, typename>
+    friend class internal::SyncAwaiter;
+
+    bool suspend(internal::SyncWaiter& waiter);
+    void withdraw(internal::SyncWaiter& waiter);
+
+    std::mutex m_mutex;
+    internal::SyncWaiterList m_waiters;
+    bool m_locked = false;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///
+/// Counting semaphore for coroutines, typically limiting the number of concurrent operations.
+/// Permits are granted to the waiters in FIFO order.
+/// Usage:
+///   @code
+///   async::AsyncSemaphore outbound_calls{8};
+///   co_await outbound_calls.acquire();
+///   EZ_ON_SCOPE_EXIT { outbound_calls.release(); };
+///   co_return co_await client.call(request);
+///   @endcode
+class AsyncSemaphore : NonCopiable {
+public:
+    explicit AsyncSemaphore(size_t permits) : m_permits{permits} {}
+    AsyncSemaphore(AsyncSemaphore&&) = delete;
+
+    [[nodiscard]] auto acquire() { return internal::SyncAwaiter<AsyncSemaphore>{*this}; }
+
+    template <typename E>
+    [[nodiscard]] auto acquire_on(E& executor)
+    {
+        return internal::SyncAwaiter<AsyncSemaphore>{*this, executor};
+    }
+
+    bool try_acquire();
+    void release(size_t count = 1);
+
+    /// Permits not acquired, zero while coroutines are waiting.
+    size_t available();
+
+private:
+    template <typename, typename>
+    friend class internal::SyncAwaiter;
+
+    bool suspend(internal::SyncWaiter& waiter);
+    void withdraw(internal::SyncWaiter& waiter);
+
+    std::mutex m_mutex;
+    internal::SyncWaiterList m_waiters;
+    size_t m_permits = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class ResetMode { Manual, Auto };
+
+///
+/// Event awaited by coroutines. A manual reset event releases every waiter and stays set until
+/// `reset`; an auto reset event releases a single waiter per `set`, and stays set only when no
+/// coroutine was waiting.
+/// Usage:
+///   @code
+///   async::AsyncEvent connected;
+///   co_await connected.wait();  // in the coroutines needing the connection
+///   connected.set();            // once connected
+///   @endcode
+class AsyncEvent : NonCopiable {
+public:
+    explicit AsyncEvent(ResetMode mode = ResetMode::Manual, bool set = false)
+        : m_mode{mode}, m_set{set}
+    {
+    }
+    AsyncEvent(AsyncEvent&&) = delete;
+
+    [[nodiscard]] auto wait() { return internal::SyncAwaiter<AsyncEvent>{*this}; }
+
+    template <typename E>
+    [[nodiscard]] auto wait_on(E& executor)
+    {
+        return internal::SyncAwaiter<AsyncEvent>{*this, executor};
+    }
+
+    void set();
+    void reset();
+    bool is_set();
+
+private:
+    template <typename, typename>
+    friend class internal::SyncAwaiter;
+
+    bool suspend(internal::SyncWaiter& waiter);
+    void withdraw(internal::SyncWaiter& waiter);
+
+    std::mutex m_mutex;
+    internal::SyncWaiterList m_waiters;
+    const ResetMode m_mode = ResetMode::Manual;
+    bool m_set = false;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///
+/// Single use barrier for coroutines: the waiters are released once `count_down` was called
+/// `count` times.
+/// Usage:
+///   @code
+///   async::AsyncLatch loaded{modules.size()};
+///   for (auto& module : modules) scope << load(module, loaded);  // calls loaded.count_down()
+///   co_await loaded.wait();
+///   @endcode
+class AsyncLatch : NonCopiable {
+public:
+    explicit AsyncLatch(size_t count) : m_count{count} {}
+    AsyncLatch(AsyncLatch&&) = delete;
+
+    [[nodiscard]] auto wait() { return internal::SyncAwaiter<AsyncLatch>{*this}; }
+
+    template <typename E>
+    [[nodiscard]] auto wait_on(E& executor)
+    {
+        return internal::SyncAwaiter<AsyncLatch>{*this, executor};
+    }
+
+    void count_down(size_t count = 1);
+    bool try_wait();
+
+private:
+    template <typename, typename>
+    friend class internal::SyncAwaiter;
+
+    bool suspend(internal::SyncWaiter& waiter);
+    void withdraw(internal::SyncWaiter& waiter);
+
+    std::mutex m_mutex;
+    internal::SyncWaiterList m_waiters;
+    size_t m_count = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace internal {
+
+inline void enqueue(SyncWaiterList& waiters, SyncWaiter& waiter)
+{
+    waiter.wake_up = std::make_shared<WakeUp>(waiter.handle, waiter.post, waiter.executor);
+    waiter.waiting = true;
+    waiter.queued = true;
+    waiters.push_back(&waiter);
+}
+
+inline std::shared_ptr<WakeUp> dequeue(SyncWaiterList& waiters)
+{
+    SyncWaiter* waiter = waiters.pop_front();
+    if (waiter == nullptr) return nullptr;
+    waiter->waiting = false;
+    return waiter->wake_up;
+}
+
+// True when the waiter was granted the primitive but is destroyed before being resumed, the
+// caller then gives the grant back.
+inline bool withdraw(std::mutex& mutex, SyncWaiterList& waiters, SyncWaiter& waiter)
+{
+    {
+        std::lock_guard lock{mutex};
+        if (waiter.waiting) {
+            waiters.remove(&waiter);
+            return false;
+        }
+    }
+    return waiter.wake_up->claim();
+}
+
+}  // namespace internal
+
+inline AsyncLockGuard& AsyncLockGuard::operator=(AsyncLockGuard&& other) noexcept
+{
+    if (this != &other) {
+        unlock();
+        m_mutex = std::exchange(other.m_mutex, nullptr);
+    }
+    return *this;
+}
+
+inline void AsyncLockGuard::unlock() noexcept
+{
+    if (m_mutex) std::exchange(m_mutex, nullptr)->unlock();
+}
+
+inline bool AsyncMutex::try_lock()
+{
+    std::lock_guard lock{m_mutex};
+    return !std::exchange(m_locked, true);
+}
+
+inline void AsyncMutex::unlock()
+{
+    std::unique_lock lock{m_mutex};
+    EZ_ASSERT(m_locked);
+
+    // The lock goes to the first waiter without being released.
+    std::shared_ptr<internal::WakeUp> wake_up = internal::dequeue(m_waiters);
+    if (wake_up == nullptr) {
+        m_locked = false;
+        return;
+    }
+    lock.unlock();
+    internal::resume(std::move(wake_up));
+}
+
+inline bool AsyncMutex::suspend(internal::SyncWaiter& waiter)
+{
+    std::lock_guard lock{m_mutex};
+    if (!std::exchange(m_locked, true)) return false;
+
+    internal::enqueue(m_waiters, waiter);
+    return true;
+}
+
+inline void AsyncMutex::withdraw(internal::SyncWaiter& waiter)
+{
+    if (internal::withdraw(m_mutex, m_waiters, waiter)) unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool AsyncSemaphore::try_acquire()
+{
+    std::lock_guard lock{m_mutex};
+    if (m_permits == 0) return false;
+    --m_permits;
+    return true;
+}
+
+inline void AsyncSemaphore::release(size_t count)
+{
+    internal::WakeUps released;
+    {
+        std::lock_guard lock{m_mutex};
+        m_permits += count;
+        while (m_permits != 0) {
+            std::shared_ptr<internal::WakeUp> wake_up = internal::dequeue(m_waiters);
+            if (wake_up == nullptr) break;
+            released.push_back(std::move(wake_up));
+            --m_permits;
+        }
+    }
+    internal::resume_all(released);
+}
+
+inline size_t AsyncSemaphore::available()
+{
+    std::lock_guard lock{m_mutex};
+    return m_permits;
+}
+
+inline bool AsyncSemaphore::suspend(internal::SyncWaiter& waiter)
+{
+    std::lock_guard lock{m_mutex};
+    if (m_permits != 0) {
+        --m_permits;
+        return false;
+    }
+    internal::enqueue(m_waiters, waiter);
+    return true;
+}
+
+inline void AsyncSemaphore::withdraw(internal::SyncWaiter& waiter)
+{
+    if (internal::withdraw(m_mutex, m_waiters, waiter)) release();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline void AsyncEvent::set()
+{
+    internal::WakeUps released;
+    {
+        std::lock_guard lock{m_mutex};
+        if (m_mode == ResetMode::Auto) {
+            if (auto wake_up = internal::dequeue(m_waiters)) released.push_back(std::move(wake_up));
+            else m_set = true;
+        }
+        else {
+            m_set = true;
+            while (auto wake_up = internal::dequeue(m_waiters)) {
+                released.push_back(std::move(wake_up));
+            }
+        }
+    }
+    internal::resume_all(released);
+}
+
+inline void AsyncEvent::reset()
+{
+    std::lock_guard lock{m_mutex};
+    m_set = false;
+}
+
+inline bool AsyncEvent::is_set()
+{
+    std::lock_guard lock{m_mutex};
+    return m_set;
+}
+
+inline bool AsyncEvent::suspend(internal::SyncWaiter& waiter)
+{
+    std::lock_guard lock{m_mutex};
+    if (m_set) {
+        if (m_mode == ResetMode::Auto) m_set = false;
+        return false;
+    }
+    internal::enqueue(m_waiters, waiter);
+    return true;
+}
+
+inline void AsyncEvent::withdraw(internal::SyncWaiter& waiter)
+{
+    // The release of an auto reset event goes to the next waiter.
+    if (internal::withdraw(m_mutex, m_waiters, waiter) && m_mode == ResetMode::Auto) set();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline void AsyncLatch::count_down(size_t count)
+{
+    internal::WakeUps released;
+    {
+        std::lock_guard lock{m_mutex};
+        EZ_ASSERT(count <= m_count);
+        m_count -= count;
+        if (m_count != 0) return;
+
+        while (auto wake_up = internal::dequeue(m_waiters)) released.push_back(std::move(wake_up));
+    }
+    internal::resume_all(released);
+}
+
+inline bool AsyncLatch::try_wait()
+{
+    std::lock_guard lock{m_mutex};
+    return m_count == 0;
+}
+
+inline bool AsyncLatch::suspend(internal::SyncWaiter& waiter)
+{
+    std::lock_guard lock{m_mutex};
+    if (m_count == 0) return false;
+
+    internal::enqueue(m_waiters, waiter);
+    return true;
+}
+
+inline void AsyncLatch::withdraw(internal::SyncWaiter& waiter)
+{
+    internal::withdraw(m_mutex, m_waiters, waiter);
+}
+
+}  // namespace ez::async
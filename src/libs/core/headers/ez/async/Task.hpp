@@ -1,5 +1,7 @@
 #pragma once
 
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/FrameAllocator.hpp>
 #include <ez/async/Receiver.hpp>
 #include <ez/async/Types.hpp>
 
@@ -19,9 +21,15 @@ struct StoreCallerAwaiter {
 
     bool await_ready() noexcept { return corountine.promise().has_value(); }
 
-    CoHandle<> await_suspend(CoHandle<> caller) noexcept
+    // A task without its own token inherits the one of the awaiting coroutine.
+    template <typename CallerPromise>
+    CoHandle<> await_suspend(CoHandle<CallerPromise> caller) noexcept
     {
-        corountine.promise().set_continuation(caller);
+        auto& promise = corountine.promise();
+        if (!promise.cancellation_token().can_be_cancelled()) {
+            promise.set_cancellation_token(internal::cancellation_token_of(caller));
+        }
+        promise.set_continuation(caller);
         return corountine;
     }
 
@@ -50,7 +58,7 @@ struct TaskFinalAwaiter {
 ////////////////////////////////////////////////////////////////////////////////
 
 template <typename T>
-struct TaskPromise : public Receiver<T> {
+struct TaskPromise : public Receiver<T>, public PooledFrame {
     CoHandle<> continuation = std::noop_coroutine();
 
     void set_continuation(CoHandle<> cont) { continuation = cont; }
@@ -58,6 +66,15 @@ struct TaskPromise : public Receiver<T> {
 
     std::suspend_always initial_suspend() noexcept { return {}; }
     TaskFinalAwaiter final_suspend() noexcept { return {}; }
+
+    const CancellationToken& cancellation_token() const noexcept { return m_cancellation_token; }
+    void set_cancellation_token(CancellationToken token) noexcept
+    {
+        m_cancellation_token = std::move(token);
+    }
+
+private:
+    CancellationToken m_cancellation_token;
 };
 
 template <typename T = void>
@@ -84,6 +101,14 @@ public:
         return {m_coroutine.get()};
     }
 
+    /// The task and the tasks it awaits observe `token` instead of the token of the coroutine
+    /// awaiting it.
+    Task with_cancellation(CancellationToken token) &&
+    {
+        m_coroutine.get().promise().set_cancellation_token(std::move(token));
+        return std::move(*this);
+    }
+
     bool done() const { return handle().done(); }
     void resume() { handle().resume(); }
     void* address() const { return handle().address(); }
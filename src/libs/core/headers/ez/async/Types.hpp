@@ -40,4 +40,14 @@ public:
     ValueNotSet() : std::runtime_error{"Value not set"} {}
 };
 
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error{"Operation cancelled"} {}
+};
+
+class QuorumNotReached : public std::runtime_error {
+public:
+    QuorumNotReached() : std::runtime_error{"Quorum not reached"} {}
+};
+
 }  // namespace ez::async
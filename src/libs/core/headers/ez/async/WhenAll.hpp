@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ez/async/internal/AwaitableRange.hpp>
 #include <ez/async/internal/WhenAll.hpp>
 
 namespace ez::async {
@@ -14,4 +15,23 @@ auto when_all(Awaitables&&... awaitables)
     return Awaiter{internal::make_when_all_continuation_task(EZ_FWD(awaitables))...};
 }
 
+///
+/// Awaits a runtime number of awaitables concurrently, returns their results in the order of the
+/// range, nothing for void awaitables. The elements of an lvalue container are awaited in place,
+/// the others are moved.
+/// Usage:
+///   @code
+///   std::vector<async::Task<Rows>> queries;
+///   for (auto& shard : shards) queries.push_back(query(shard, request));
+///   std::vector<Rows> rows = co_await async::when_all(std::move(queries));
+///   @endcode
+template <internal::AwaitableRange Range>
+auto when_all(Range&& awaitables)
+{
+    using Awaiter = internal::WhenAllRangeAwaiter<internal::RangeResult<Range>>;
+
+    return Awaiter{internal::make_range_continuation_tasks<internal::WhenAllContinuationTask>(
+        EZ_FWD(awaitables))};
+}
+
 }  // namespace ez::async
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <ez/async/internal/AwaitableRange.hpp>
 #include <ez/async/internal/WhenAny.hpp>
+#include <ez/async/internal/WhenN.hpp>
 
 namespace ez::async {
 template <trait::Awaitable... Awaitables>
@@ -14,4 +16,22 @@ auto when_any(Awaitables&&... awaitables)
     return Awaiter{internal::make_when_any_continuation_task(EZ_FWD(awaitables))...};
 }
 
+///
+/// Awaits the first completion of a runtime number of awaitables, returns its index in the range
+/// and its result (or rethrows its exception), only the index for void awaitables. The other
+/// awaitables are cancelled and, unlike the variadic version, awaited: none of them outlives the
+/// when_any. Throws std::invalid_argument for an empty range.
+/// Usage:
+///   @code
+///   auto [replica, value] = co_await async::when_any(replicas | std::views::transform(read));
+///   @endcode
+template <internal::AwaitableRange Range>
+auto when_any(Range&& awaitables)
+{
+    using Awaiter = internal::WhenAnyRangeAwaiter<internal::RangeResult<Range>>;
+
+    return Awaiter{internal::make_range_continuation_tasks<internal::WhenNContinuationTask>(
+        EZ_FWD(awaitables))};
+}
+
 }  // namespace ez::async
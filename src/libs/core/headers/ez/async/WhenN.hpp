@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ez/async/internal/AwaitableRange.hpp>
+#include <ez/async/internal/WhenN.hpp>
+
+namespace ez::async {
+
+///
+/// Awaits the first `needed` successful awaitables of a range, returns their indexes and results
+/// in completion order, only the indexes for void awaitables. The others are cancelled and
+/// awaited. Failures are tolerated as long as `needed` awaitables can still succeed, otherwise
+/// the first failure is rethrown (QuorumNotReached when the range is shorter than `needed`).
+/// Usage:
+///   @code
+///   // Quorum read: 2 replicas out of 3.
+///   auto versions = co_await async::when_n(2, replicas | std::views::transform(read));
+///   auto latest = std::ranges::max(versions, {}, [](auto& v) { return v.second.version; });
+///   @endcode
+template <internal::AwaitableRange Range>
+auto when_n(size_t needed, Range&& awaitables)
+{
+    using Awaiter = internal::WhenNAwaiter<internal::RangeResult<Range>>;
+
+    return Awaiter{needed,
+                   internal::make_range_continuation_tasks<internal::WhenNContinuationTask>(
+                       EZ_FWD(awaitables))};
+}
+
+}  // namespace ez::async
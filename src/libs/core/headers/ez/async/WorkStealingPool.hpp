@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ez/async/Executor.hpp>
+
+#include <ez/ChaseLevDeque.hpp>
+#include <ez/Utils.hpp>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ez::async {
+
+///
+/// Thread pool where each worker owns a work stealing deque. Jobs posted from a worker go to
+/// its LIFO slot (the continuation just scheduled runs next, while its data is still in cache),
+/// the previous occupant of the slot is moved to the worker's deque. Jobs posted from other
+/// threads go to a shared injection queue. Idle workers take from their deque, then from the
+/// injection queue, then steal from the other workers, spin a little and finally park on a
+/// futex (std::atomic::wait).
+/// The destructor runs the queued jobs before joining the workers. Jobs must not throw.
+/// Usage:
+///   @code
+///   async::WorkStealingPool pool{8};
+///   auto task = [&]() -> async::Task<int> {
+///       co_await async::schedule_on(pool);
+///       co_return compute();
+///   };
+///   int result = async::sync_wait(task());
+///   @endcode
+class WorkStealingPool : NonCopiable {
+public:
+    explicit WorkStealingPool(size_t thread_count = std::thread::hardware_concurrency());
+    WorkStealingPool(WorkStealingPool&&) = delete;
+    ~WorkStealingPool();
+
+    size_t thread_count() const noexcept { return m_workers.size(); }
+
+    template <typename F>
+    void post(F&& f)
+    {
+        submit(new FunctionJob<std::decay_t<F>>{{&FunctionJob<std::decay_t<F>>::run},
+                                                std::forward<F>(f)});
+    }
+
+    /// True when called from one of the workers of this pool.
+    bool is_worker_thread() const noexcept;
+
+private:
+    struct Job {
+        void (*run_and_delete)(Job*);
+    };
+
+    template <typename F>
+    struct FunctionJob : Job {
+        F f;
+
+        static void run(Job* job)
+        {
+            std::unique_ptr<FunctionJob> self{static_cast<FunctionJob*>(job)};
+            self->f();
+        }
+    };
+
+    struct Worker;
+
+    void submit(Job* job);
+    void wake_one();
+    void run(Worker& worker);
+    Job* find_job(Worker& worker);
+    Job* steal(Worker& worker);
+    bool has_stealable_jobs() const;
+
+    static thread_local Worker* s_current_worker;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_injection_mutex;
+    std::deque<Job*> m_injection;
+    std::atomic<size_t> m_injection_size{0};
+
+    std::atomic<u32> m_wake_epoch{0};
+    std::atomic<u32> m_sleeping{0};
+    std::atomic<bool> m_stopping{false};
+};
+
+template <>
+struct Executor<WorkStealingPool> {
+    static void post(WorkStealingPool& pool, auto&& task) { pool.post(EZ_FWD(task)); }
+};
+
+}  // namespace ez::async
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ez/async/Traits.hpp>
+
+#include <ez/Utils.hpp>
+
+#include <ranges>
+#include <vector>
+
+namespace ez::async::internal {
+
+template <typename Range>
+concept AwaitableRange = std::ranges::input_range<Range> &&
+                         trait::Awaitable<std::ranges::range_reference_t<Range>>;
+
+template <AwaitableRange Range>
+using RangeResult = typename trait::AwaitableTraits<std::ranges::range_reference_t<Range>>::R;
+
+// The elements of an lvalue container are awaited in place, like the lvalue arguments of the
+// variadic when_all, the caller keeps them alive. The elements of an rvalue range or of a view
+// producing temporaries are moved in the continuation tasks.
+template <typename Range>
+constexpr bool awaited_in_place = std::is_lvalue_reference_v<Range> &&
+                                  std::is_lvalue_reference_v<std::ranges::range_reference_t<Range>>;
+
+// `T` is a reference for an awaitable awaited in place.
+template <typename ContinuationTask, trait::Awaitable T>
+ContinuationTask make_range_continuation_task(T awaitable)
+{
+    // A cast rather than std::move: GCC 12 copies an awaiter returned by reference from a call.
+    using R = typename trait::AwaitableTraits<T>::R;
+    if constexpr (std::is_void_v<R>) {
+        co_await static_cast<T&&>(awaitable);
+        co_return;
+    }
+    else {
+        co_return co_await static_cast<T&&>(awaitable);
+    }
+}
+
+template <template <typename> class ContinuationTask, AwaitableRange Range>
+auto make_range_continuation_tasks(Range&& awaitables)
+    -> std::vector<ContinuationTask<RangeResult<Range>>>
+{
+    using Task = ContinuationTask<RangeResult<Range>>;
+
+    std::vector<Task> tasks;
+    if constexpr (std::ranges::sized_range<Range>) tasks.reserve(std::ranges::size(awaitables));
+
+    for (auto it = std::ranges::begin(awaitables); it != std::ranges::end(awaitables); ++it) {
+        if constexpr (awaited_in_place<Range>) {
+            tasks.push_back(
+                make_range_continuation_task<Task, std::ranges::range_reference_t<Range>>(*it));
+        }
+        else {
+            tasks.push_back(make_range_continuation_task<Task, std::ranges::range_value_t<Range>>(
+                std::ranges::iter_move(it)));
+        }
+    }
+    return tasks;
+}
+
+}  // namespace ez::async::internal
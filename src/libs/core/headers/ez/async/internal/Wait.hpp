@@ -11,13 +11,11 @@
 namespace ez::async::internal {
 class SyncWaitEvent {
 public:
+    // Notifies under the lock: the waiting thread destroys the event as soon as it sees m_set.
     void set()
     {
-        {
-            std::lock_guard lock{m_mutex};
-            m_set = true;
-        }
-
+        std::lock_guard lock{m_mutex};
+        m_set = true;
         m_condition_var.notify_all();
     }
 
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <ez/async/Types.hpp>
+
+#include <atomic>
+#include <memory>
+
+namespace ez::async::internal {
+
+// Intrusive FIFO of the awaiters suspended on a channel or a synchronization primitive. The
+// awaiters live in the suspended coroutine frames, an awaiter destroyed while waiting (a
+// `when_any` loser, a destroyed task) unlinks itself.
+template <typename Waiter>
+class WaiterList {
+public:
+    bool empty() const noexcept { return m_head == nullptr; }
+
+    void push_back(Waiter* waiter) noexcept
+    {
+        waiter->prev = m_tail;
+        waiter->next = nullptr;
+        if (m_tail) m_tail->next = waiter;
+        else m_head = waiter;
+        m_tail = waiter;
+    }
+
+    Waiter* pop_front() noexcept
+    {
+        Waiter* waiter = m_head;
+        if (waiter) remove(waiter);
+        return waiter;
+    }
+
+    void remove(Waiter* waiter) noexcept
+    {
+        if (waiter->prev) waiter->prev->next = waiter->next;
+        else m_head = waiter->next;
+        if (waiter->next) waiter->next->prev = waiter->prev;
+        else m_tail = waiter->prev;
+        waiter->prev = waiter->next = nullptr;
+    }
+
+private:
+    Waiter* m_head = nullptr;
+    Waiter* m_tail = nullptr;
+};
+
+// Resumption of a queued waiter, shared with the thread releasing it: a granted awaiter may be
+// destroyed before it is resumed (a `when_any` loser, a resumption posted to an executor). The
+// first to set `claimed` either resumes the coroutine or, from the destroyed awaiter, gives the
+// grant back.
+struct WakeUp {
+    CoHandle<> handle;
+    void (*post)(void* executor, std::shared_ptr<WakeUp> wake_up) = nullptr;
+    void* executor = nullptr;
+    std::atomic_bool claimed{false};
+
+    // True for the first caller only.
+    bool claim() noexcept { return !claimed.exchange(true, std::memory_order::acq_rel); }
+
+    void resume_if_unclaimed()
+    {
+        if (claim()) handle.resume();
+    }
+};
+
+inline void resume(std::shared_ptr<WakeUp> wake_up)
+{
+    if (auto post = wake_up->post) {
+        void* executor = wake_up->executor;
+        post(executor, std::move(wake_up));
+    }
+    else {
+        wake_up->resume_if_unclaimed();
+    }
+}
+
+}  // namespace ez::async::internal
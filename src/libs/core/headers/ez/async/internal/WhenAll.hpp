@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ez/async/Cancellation.hpp>
 #include <ez/async/Receiver.hpp>
 #include <ez/async/Traits.hpp>
 #include <ez/async/Types.hpp>
@@ -9,6 +10,7 @@
 #include <ez/Utils.hpp>
 
 #include <atomic>
+#include <vector>
 
 namespace ez::async::internal {
 
@@ -19,6 +21,7 @@ public:
     WhenAllLatch(WhenAllLatch&& other) : m_count(other.m_count.load(std::memory_order::acquire))
     {
         std::swap(m_continuation, other.m_continuation);
+        std::swap(m_cancellation_token, other.m_cancellation_token);
     }
 
     WhenAllLatch& operator=(WhenAllLatch&& other)
@@ -27,17 +30,32 @@ public:
             m_count.store(other.m_count.load(std::memory_order::acquire),
                           std::memory_order::relaxed);
             std::swap(m_continuation, other.m_continuation);
+            std::swap(m_cancellation_token, other.m_cancellation_token);
         }
 
         return *this;
     }
 
-    bool is_ready() const noexcept { return m_continuation && m_continuation.done(); }
+    bool is_ready() const noexcept { return m_count.load(std::memory_order::acquire) == 1; }
 
     void set_continuation(CoHandle<> awaiting_coroutine) noexcept
     {
         m_continuation = awaiting_coroutine;
-        m_count.fetch_sub(1, std::memory_order::acq_rel);
+    }
+
+    // Token of the awaiting coroutine, shared by the awaitables.
+    const CancellationToken& cancellation_token() const noexcept { return m_cancellation_token; }
+    void set_cancellation_token(CancellationToken token) noexcept
+    {
+        m_cancellation_token = std::move(token);
+    }
+
+    // The awaiter holds the extra count until every awaitable is started: the continuation is
+    // resumed by the last completion, or not suspended at all when they all completed during
+    // the start.
+    bool notify_started() noexcept
+    {
+        return m_count.fetch_sub(1, std::memory_order::acq_rel) != 1;
     }
 
     void notify_awaitable_completed() noexcept
@@ -48,6 +66,7 @@ public:
 private:
     std::atomic_uint32_t m_count;
     CoHandle<> m_continuation;
+    CancellationToken m_cancellation_token;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -85,8 +104,10 @@ public:
 
     bool await_ready() const noexcept { return m_latch.is_ready(); }
 
-    bool await_suspend(CoHandle<> awaiting_coroutine) noexcept
+    template <typename Promise>
+    bool await_suspend(CoHandle<Promise> awaiting_coroutine) noexcept
     {
+        m_latch.set_cancellation_token(internal::cancellation_token_of(awaiting_coroutine));
         return start_tasks(awaiting_coroutine);
     }
 
@@ -105,7 +126,7 @@ private:
     {
         m_latch.set_continuation(awaiting_coroutine);
         m_tasks.for_each([&](auto& task) { task.start(m_latch); });
-        return !m_latch.is_ready();
+        return m_latch.notify_started();
     }
 
 private:
@@ -115,6 +136,52 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Awaits a runtime number of awaitables, the results are returned in their order. Nothing is
+// returned for void awaitables, their exceptions are still rethrown.
+template <typename R>
+class WhenAllRangeAwaiter {
+public:
+    WhenAllRangeAwaiter(std::vector<WhenAllContinuationTask<R>> tasks)
+        : m_tasks{std::move(tasks)}, m_latch{std::uint32_t(m_tasks.size())}
+    {
+    }
+
+    WhenAllRangeAwaiter(WhenAllRangeAwaiter&& other)
+        : m_tasks{std::move(other.m_tasks)}, m_latch{std::move(other.m_latch)}
+    {
+    }
+
+    bool await_ready() const noexcept { return m_latch.is_ready(); }
+
+    template <typename Promise>
+    bool await_suspend(CoHandle<Promise> awaiting_coroutine) noexcept
+    {
+        m_latch.set_cancellation_token(internal::cancellation_token_of(awaiting_coroutine));
+        m_latch.set_continuation(awaiting_coroutine);
+        for (auto& task : m_tasks) task.start(m_latch);
+        return m_latch.notify_started();
+    }
+
+    auto await_resume()
+    {
+        if constexpr (std::is_void_v<R>) {
+            for (auto& task : m_tasks) task.get();
+        }
+        else {
+            std::vector<R> results;
+            results.reserve(m_tasks.size());
+            for (auto& task : m_tasks) results.push_back(std::move(task.get()));
+            return results;
+        }
+    }
+
+private:
+    std::vector<WhenAllContinuationTask<R>> m_tasks;
+    WhenAllLatch m_latch{0};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 template <typename R>
 class WhenAllContinuationTask;
 
@@ -141,7 +208,10 @@ public:
         return CompletionNotifier{};
     }
 
-    void return_value(auto&& value) { Receiver<R>::set_value(EZ_FWD(value)); }
+    CancellationToken cancellation_token() const noexcept
+    {
+        return m_latch->cancellation_token();
+    }
 
     void start(WhenAllLatch& latch)
     {
@@ -182,13 +252,14 @@ template <trait::Awaitable T>
 auto make_when_all_continuation_task(T&& awaitable)
     -> WhenAllContinuationTask<typename trait::AwaitableTraits<decltype(awaitable)>::R>
 {
+    // A cast rather than EZ_FWD: GCC 12 copies an awaiter returned by reference from a call.
     using R = typename trait::AwaitableTraits<decltype(awaitable)>::R;
     if constexpr (std::is_void_v<R>) {
-        co_await EZ_FWD(awaitable);
+        co_await static_cast<T&&>(awaitable);
         co_return;
     }
     else {
-        co_return co_await EZ_FWD(awaitable);
+        co_return co_await static_cast<T&&>(awaitable);
     }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ez/async/Cancellation.hpp>
 #include <ez/async/Receiver.hpp>
 #include <ez/async/Traits.hpp>
 #include <ez/async/Types.hpp>
@@ -11,6 +12,7 @@
 #include <ez/Utils.hpp>
 
 #include <atomic>
+#include <optional>
 
 namespace ez::async::internal {
 
@@ -29,23 +31,46 @@ public:
 
     WhenAnyLatch& operator=(const WhenAnyLatch& other) = default;
 
-    bool is_ready() const noexcept { return m_state->finished_count.load() > 0; }
+    bool is_ready() const noexcept { return m_state->finished_count.load() > 1; }
 
     void set_continuation(CoHandle<> awaiting_coroutine) noexcept
     {
         m_state->continuation = awaiting_coroutine;
     }
 
-    void notify_awaitable_completed() noexcept
+    // Completions count for 2 and the end of the start for 1: the first completion after the
+    // start resumes the continuation, a completion during the start only makes the awaiter skip
+    // the suspension. The first completion is the result and cancels the other awaitables, which
+    // may complete before the continuation runs.
+    void notify_awaitable_completed(void* awaitable) noexcept
     {
-        auto old_count = m_state->finished_count.fetch_add(1, std::memory_order::acquire);
-        if (old_count == 0) { m_state->continuation.resume(); }
+        auto old_count = m_state->finished_count.fetch_add(2, std::memory_order::acq_rel);
+        if (old_count < 2) {
+            m_state->winner = awaitable;
+            cancel();
+        }
+        if (old_count == 1) { m_state->continuation.resume(); }
+    }
+
+    bool is_winner(void* awaitable) const noexcept { return m_state->winner == awaitable; }
+
+    void cancel() noexcept { m_state->cancellation.request_cancellation(); }
+    CancellationToken cancellation_token() const noexcept
+    {
+        return m_state->cancellation.token();
+    }
+
+    bool notify_started() noexcept
+    {
+        return m_state->finished_count.fetch_add(1, std::memory_order::acq_rel) == 0;
     }
 
 private:
     struct State {
         std::atomic_uint32_t finished_count{0};
         CoHandle<> continuation;
+        void* winner = nullptr;
+        CancellationSource cancellation;
     };
 
     Shared<State> m_state;
@@ -98,16 +123,22 @@ public:
 
     bool await_ready() const noexcept { return m_latch.is_ready(); }
 
-    bool await_suspend(CoHandle<> awaiting_coroutine) noexcept
+    // The cancellation of the awaiting coroutine cancels every awaitable.
+    template <typename Promise>
+    bool await_suspend(CoHandle<Promise> awaiting_coroutine) noexcept
     {
+        m_parent_cancellation.emplace(internal::cancellation_token_of(awaiting_coroutine),
+                                      CancelAll{m_latch});
         return start_tasks(awaiting_coroutine);
     }
 
     auto await_resume()
     {
+        m_parent_cancellation.reset();
+
         if constexpr (std::is_same_v<ReturnType, void>) {
             tuple::for_each(m_tasks, [&](auto& task) {
-                if (task.done()) task.get();
+                if (m_latch.is_winner(task.address())) task.get();
             });
         }
         else {
@@ -123,7 +154,7 @@ private:
     {
         auto& task = std::get<index>(m_tasks);
 
-        if (task.done()) {
+        if (m_latch.is_winner(task.address())) {
             result = task.get();
             return;
         }
@@ -134,13 +165,24 @@ private:
     bool start_tasks(CoHandle<> awaiting_coroutine)
     {
         m_latch.set_continuation(awaiting_coroutine);
-        tuple::for_each(m_tasks, [&](auto& task) { task.start(m_latch); });
-        return !m_latch.is_ready();
+        // Once an awaitable completed synchronously the others are not started, a ready channel
+        // must not lose a value to a receive which could not win.
+        tuple::for_each(m_tasks, [&](auto& task) {
+            if (!m_latch.is_ready()) task.start(m_latch);
+        });
+        return m_latch.notify_started();
     }
 
 private:
+    struct CancelAll {
+        WhenAnyLatch latch;
+
+        void operator()() { latch.cancel(); }
+    };
+
     Tuple<Tasks...> m_tasks;
     WhenAnyLatch m_latch;
+    std::optional<CancellationCallback<CancelAll>> m_parent_cancellation;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -163,7 +205,7 @@ public:
             bool await_ready() const noexcept { return false; }
             void await_suspend(CoHandle<Self> coroutine) noexcept
             {
-                coroutine.promise().m_latch.notify_awaitable_completed();
+                coroutine.promise().m_latch->notify_awaitable_completed(coroutine.address());
             }
             void await_resume() const noexcept {}
         };
@@ -171,16 +213,20 @@ public:
         return CompletionNotifier{};
     }
 
-    void return_value(auto&& value) { Receiver<R>::set_value(EZ_FWD(value)); }
+    CancellationToken cancellation_token() const noexcept
+    {
+        return m_latch->cancellation_token();
+    }
 
-    void start(WhenAnyLatch latch)
+    // The latch of the awaiter, which owns the frame of this promise.
+    void start(WhenAnyLatch& latch)
     {
-        m_latch = std::move(latch);
+        m_latch = &latch;
         make_coroutine(*this).resume();
     }
 
 private:
-    WhenAnyLatch m_latch;
+    WhenAnyLatch* m_latch = nullptr;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -216,13 +262,14 @@ template <trait::Awaitable T>
 auto make_when_any_continuation_task(T&& awaitable)
     -> WhenAnyContinuationTask<typename trait::AwaitableTraits<decltype(awaitable)>::R>
 {
+    // A cast rather than EZ_FWD: GCC 12 copies an awaiter returned by reference from a call.
     using R = typename trait::AwaitableTraits<decltype(awaitable)>::R;
     if constexpr (std::is_void_v<R>) {
-        co_await EZ_FWD(awaitable);
+        co_await static_cast<T&&>(awaitable);
         co_return;
     }
     else {
-        co_return co_await EZ_FWD(awaitable);
+        co_return co_await static_cast<T&&>(awaitable);
     }
 }
 
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/Receiver.hpp>
+#include <ez/async/Traits.hpp>
+#include <ez/async/Types.hpp>
+
+#include <ez/Resource.hpp>
+#include <ez/Shared.hpp>
+#include <ez/Utils.hpp>
+
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ez::async::internal {
+
+// Unlike the variadic when_any, the awaitables left are cancelled and awaited before the
+// continuation is resumed: a task waiting in the queue of another executor must not outlive its
+// frame. The started tasks are counted, the last completion resumes the continuation once the
+// awaiter started them all.
+class WhenNLatch {
+public:
+    WhenNLatch(size_t needed, size_t count, bool failures_count)
+    {
+        m_state->needed = needed;
+        m_state->count = count;
+        m_state->failures_count = failures_count;
+        m_state->finished = needed == 0 || count < needed;
+        m_state->results.reserve(needed);
+    }
+
+    bool is_ready() const noexcept
+    {
+        std::lock_guard lock{m_state->mutex};
+        return m_state->finished && m_state->running == 0;
+    }
+
+    void set_continuation(CoHandle<> awaiting_coroutine) noexcept
+    {
+        m_state->continuation = awaiting_coroutine;
+    }
+
+    /// False once finished, the awaitable must not be started.
+    bool notify_starting() noexcept
+    {
+        std::lock_guard lock{m_state->mutex};
+        if (m_state->finished) return false;
+        ++m_state->running;
+        return true;
+    }
+
+    // The results are recorded in completion order, failures only when they count as results.
+    // The latch is finished once `needed` results are recorded or when too many awaitables
+    // failed for that, the others are then cancelled.
+    void notify_awaitable_completed(size_t index, bool succeeded) noexcept
+    {
+        // The last completion may destroy the awaiter holding this latch.
+        Shared<State> state = m_state;
+        bool finishing = false;
+        bool resume = false;
+        {
+            std::lock_guard lock{state->mutex};
+            --state->running;
+            if (!state->finished) {
+                if (succeeded || state->failures_count) state->results.push_back(index);
+                else if (!state->failure) state->failure = index;
+                ++state->completed;
+
+                const size_t failed = state->completed - state->results.size();
+                finishing = state->results.size() == state->needed ||
+                    state->count - failed < state->needed;
+                state->finished = finishing;
+            }
+            resume = state->started && state->finished && state->running == 0;
+        }
+
+        if (finishing) state->cancellation.request_cancellation();
+        if (resume) state->continuation.resume();
+    }
+
+    bool notify_started() noexcept
+    {
+        std::lock_guard lock{m_state->mutex};
+        m_state->started = true;
+        return !(m_state->finished && m_state->running == 0);
+    }
+
+    void cancel() noexcept { m_state->cancellation.request_cancellation(); }
+    CancellationToken cancellation_token() const noexcept
+    {
+        return m_state->cancellation.token();
+    }
+
+    /// Valid once ready.
+    const std::vector<size_t>& results() const noexcept { return m_state->results; }
+    std::optional<size_t> first_failure() const noexcept { return m_state->failure; }
+    size_t needed() const noexcept { return m_state->needed; }
+
+private:
+    struct State {
+        mutable std::mutex mutex;
+        size_t needed = 0;
+        size_t count = 0;
+        bool failures_count = false;
+        size_t running = 0;
+        size_t completed = 0;
+        std::vector<size_t> results;
+        std::optional<size_t> failure;
+        bool started = false;
+        bool finished = false;
+        CoHandle<> continuation;
+        CancellationSource cancellation;
+    };
+
+    Shared<State> m_state;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename R>
+class WhenNContinuationTask;
+
+template <typename R>
+class WhenNContinuationPromise : public Receiver<R> {
+public:
+    using Self = WhenNContinuationPromise<R>;
+
+    auto get_return_object() noexcept { return make_coroutine(*this); }
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    auto final_suspend() const noexcept
+    {
+        struct CompletionNotifier {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(CoHandle<Self> coroutine) noexcept
+            {
+                auto& promise = coroutine.promise();
+                promise.m_latch->notify_awaitable_completed(promise.m_index,
+                                                            promise.has_value());
+            }
+            void await_resume() const noexcept {}
+        };
+
+        return CompletionNotifier{};
+    }
+
+    CancellationToken cancellation_token() const noexcept
+    {
+        return m_latch->cancellation_token();
+    }
+
+    // The latch of the awaiter, which outlives the started awaitables.
+    void start(WhenNLatch& latch, size_t index)
+    {
+        m_latch = &latch;
+        m_index = index;
+        make_coroutine(*this).resume();
+    }
+
+private:
+    WhenNLatch* m_latch = nullptr;
+    size_t m_index = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename R>
+class WhenNContinuationTask {
+public:
+    using Promise = WhenNContinuationPromise<R>;
+    using promise_type = Promise;
+
+    WhenNContinuationTask(CoHandle<Promise> coroutine) : m_coroutine{coroutine} {}
+    WhenNContinuationTask(WhenNContinuationTask&& another)
+        : m_coroutine{std::move(another.m_coroutine)}
+    {
+    }
+
+    void start(WhenNLatch& latch, size_t index) noexcept
+    {
+        m_coroutine.get().promise().start(latch, index);
+    }
+
+    decltype(auto) get() { return std::move(m_coroutine.get().promise()).get(); }
+
+private:
+    UniqueCoroutine<Promise> m_coroutine;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct WhenNCancelAll {
+    WhenNLatch latch;
+
+    void operator()() { latch.cancel(); }
+};
+
+// Awaits the first `needed` successes of a runtime number of awaitables, returns their indexes
+// and results in completion order, only the indexes for void awaitables. When failures count,
+// the failed awaitables are results too and their exception is rethrown.
+template <typename R>
+class WhenNAwaiter {
+public:
+    WhenNAwaiter(size_t needed,
+                 std::vector<WhenNContinuationTask<R>> tasks,
+                 bool failures_count = false)
+        : m_tasks{std::move(tasks)}, m_latch{needed, m_tasks.size(), failures_count}
+    {
+    }
+
+    WhenNAwaiter(WhenNAwaiter&& other)
+        : m_tasks{std::move(other.m_tasks)}, m_latch{std::move(other.m_latch)}
+    {
+    }
+
+    bool await_ready() const noexcept { return m_latch.is_ready(); }
+
+    template <typename Promise>
+    bool await_suspend(CoHandle<Promise> awaiting_coroutine) noexcept
+    {
+        m_parent_cancellation.emplace(internal::cancellation_token_of(awaiting_coroutine),
+                                      WhenNCancelAll{m_latch});
+        m_latch.set_continuation(awaiting_coroutine);
+        for (size_t index = 0; index < m_tasks.size() && m_latch.notify_starting(); ++index) {
+            m_tasks[index].start(m_latch, index);
+        }
+        return m_latch.notify_started();
+    }
+
+    auto await_resume()
+    {
+        m_parent_cancellation.reset();
+
+        const auto& indexes = m_latch.results();
+        if (indexes.size() < m_latch.needed()) {
+            if (auto failure = m_latch.first_failure()) m_tasks[*failure].get();  // Rethrows.
+            throw QuorumNotReached{};
+        }
+
+        if constexpr (std::is_void_v<R>) {
+            for (size_t index : indexes) m_tasks[index].get();
+            return indexes;
+        }
+        else {
+            std::vector<std::pair<size_t, R>> results;
+            results.reserve(indexes.size());
+            for (size_t index : indexes) {
+                results.emplace_back(index, std::move(m_tasks[index].get()));
+            }
+            return results;
+        }
+    }
+
+protected:
+    std::vector<WhenNContinuationTask<R>> m_tasks;
+
+private:
+    WhenNLatch m_latch;
+    std::optional<CancellationCallback<WhenNCancelAll>> m_parent_cancellation;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The first completion of a runtime number of awaitables, its exception is rethrown. Only its
+// index for void awaitables.
+template <typename R>
+class WhenAnyRangeAwaiter : public WhenNAwaiter<R> {
+public:
+    WhenAnyRangeAwaiter(std::vector<WhenNContinuationTask<R>> tasks)
+        : WhenNAwaiter<R>{1, std::move(tasks), true}
+    {
+        if (this->m_tasks.empty()) throw std::invalid_argument{"when_any of an empty range"};
+    }
+
+    auto await_resume() { return std::move(WhenNAwaiter<R>::await_resume().front()); }
+};
+
+}  // namespace ez::async::internal
@@ -1,23 +1,36 @@
 #pragma once
 
+#include <ez/rpl/Async.hpp>
 #include <ez/rpl/Compose.hpp>
+#include <ez/rpl/Execution.hpp>
 #include <ez/rpl/Parallel.hpp>
+#include <ez/rpl/Profile.hpp>
 #include <ez/rpl/Run.hpp>
+#include <ez/rpl/Stream.hpp>
 
 #include <ez/rpl/stages/Accumulate.hpp>
 #include <ez/rpl/stages/Apply.hpp>
 #include <ez/rpl/stages/Copy.hpp>
 #include <ez/rpl/stages/Count.hpp>
 #include <ez/rpl/stages/Deref.hpp>
+#include <ez/rpl/stages/Distinct.hpp>
 #include <ez/rpl/stages/Enumerate.hpp>
+#include <ez/rpl/stages/ExternalSort.hpp>
+#include <ez/rpl/stages/Files.hpp>
 #include <ez/rpl/stages/Filter.hpp>
 #include <ez/rpl/stages/ForEach.hpp>
 #include <ez/rpl/stages/Get.hpp>
+#include <ez/rpl/stages/GroupBy.hpp>
+#include <ez/rpl/stages/InspectChunks.hpp>
 #include <ez/rpl/stages/Iota.hpp>
+#include <ez/rpl/stages/Join.hpp>
 #include <ez/rpl/stages/MinMax.hpp>
 #include <ez/rpl/stages/Reorder.hpp>
 #include <ez/rpl/stages/Sort.hpp>
 #include <ez/rpl/stages/SubRange.hpp>
 #include <ez/rpl/stages/Take.hpp>
+#include <ez/rpl/stages/TopK.hpp>
 #include <ez/rpl/stages/Transform.hpp>
 #include <ez/rpl/stages/Unique.hpp>
+#include <ez/rpl/stages/Window.hpp>
+#include <ez/rpl/stages/Zip.hpp>
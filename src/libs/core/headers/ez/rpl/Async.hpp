@@ -0,0 +1,414 @@
+#pragma once
+
+#include <ez/rpl/Execution.hpp>
+#include <ez/rpl/StageFactory.hpp>
+
+#include <ez/async/Executor.hpp>
+#include <ez/async/Task.hpp>
+#include <ez/async/Traits.hpp>
+
+#include <ez/Option.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <vector>
+
+namespace ez::rpl {
+
+enum class AsyncOrder {
+    Ordered,   ///< Results are emitted in the order of the inputs.
+    Unordered  ///< Results are emitted as soon as they are available.
+};
+
+/// Stage of a `run_async` pipeline transforming each element with a function returning an
+/// awaitable, with at most `concurrency` transformations in flight.
+template <typename F>
+struct AsyncTransformFactory {
+    F transform;
+    size_t concurrency = 1;
+    AsyncOrder order = AsyncOrder::Ordered;
+};
+
+template <typename F>
+auto async_transform(F&& f, size_t concurrency = 16, AsyncOrder order = AsyncOrder::Ordered)
+{
+    return AsyncTransformFactory<std::decay_t<F>>{std::forward<F>(f),
+                                                  std::max<size_t>(concurrency, 1), order};
+}
+
+///////////////////////////////////////////////////////////////////////
+
+namespace internal {
+
+template <typename T>
+struct IsAsyncTransform : std::false_type {
+};
+
+template <typename F>
+struct IsAsyncTransform<AsyncTransformFactory<F>> : std::true_type {
+};
+
+template <typename... StageFactories>
+consteval size_t async_stage_index()
+{
+    constexpr bool is_async[] = {IsAsyncTransform<StageFactories>::value...};
+
+    for (size_t i = 0; i < sizeof...(StageFactories); ++i) {
+        if (is_async[i]) return i;
+    }
+    return sizeof...(StageFactories);
+}
+
+// Moves the elements reaching the end of the upstream pipeline to a buffer.
+template <typename InputType, typename Buffer, typename...>
+struct CollectInto {
+    using OutputType = Unit&&;
+
+    Buffer buffer = nullptr;
+
+    CollectInto(Buffer b) : buffer{b} {}
+
+    void process_incremental(InputType input, auto&&)
+    {
+        buffer->emplace_back(static_cast<InputType>(input));
+    }
+
+    decltype(auto) flush_to(auto&& next) { return next.process_batch(Unit{}); }
+};
+
+template <typename Buffer>
+auto collect_into(Buffer* buffer)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, CollectInto>(buffer);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+template <typename Result>
+struct AsyncCompletion {
+    size_t index = 0;
+    Option<Result> value;
+    std::exception_ptr error;
+};
+
+// State shared by the driving coroutine and the transformations in flight: the transformation
+// and its completions. The transformations keep it alive, the driver may be destroyed while they
+// run (a `when_any` loser). The driver is resumed on the executor, never inside a
+// transformation, and only while it still waits.
+template <typename Executor, typename Result, typename F>
+class AsyncCompletions
+    : public std::enable_shared_from_this<AsyncCompletions<Executor, Result, F>> {
+public:
+    AsyncCompletions(Executor& executor, F transform)
+        : m_executor{&executor}, m_transform{std::move(transform)}
+    {
+    }
+
+    F& transform() { return m_transform; }
+
+    void push(AsyncCompletion<Result>&& completion)
+    {
+        bool waiting = false;
+        {
+            std::lock_guard lock{m_mutex};
+            m_completions.push_back(std::move(completion));
+            waiting = m_waiter != nullptr;
+        }
+        if (waiting) {
+            async::post(*m_executor, [self = this->shared_from_this()] { self->resume_waiter(); });
+        }
+    }
+
+    auto wait()
+    {
+        struct Awaiter {
+            AsyncCompletions* self;
+
+            Awaiter(AsyncCompletions* s) : self{s} {}
+            Awaiter(const Awaiter&) = delete;
+
+            // A driver destroyed while waiting is not resumed.
+            ~Awaiter()
+            {
+                std::lock_guard lock{self->m_mutex};
+                self->m_waiter = nullptr;
+            }
+
+            bool await_ready() const
+            {
+                std::lock_guard lock{self->m_mutex};
+                return !self->m_completions.empty();
+            }
+
+            bool await_suspend(async::CoHandle<> waiter)
+            {
+                std::lock_guard lock{self->m_mutex};
+                if (!self->m_completions.empty()) return false;
+                self->m_waiter = waiter;
+                return true;
+            }
+
+            std::vector<AsyncCompletion<Result>> await_resume()
+            {
+                std::lock_guard lock{self->m_mutex};
+                return std::exchange(self->m_completions, {});
+            }
+        };
+
+        return Awaiter{this};
+    }
+
+private:
+    void resume_waiter()
+    {
+        async::CoHandle<> waiter;
+        {
+            std::lock_guard lock{m_mutex};
+            waiter = std::exchange(m_waiter, nullptr);
+        }
+        if (waiter) waiter.resume();
+    }
+
+    Executor* m_executor = nullptr;
+    F m_transform;
+    std::mutex m_mutex;
+    std::vector<AsyncCompletion<Result>> m_completions;
+    async::CoHandle<> m_waiter;
+};
+
+// Coroutine destroying itself once completed.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept
+        {
+            return {async::CoHandle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    async::CoHandle<promise_type> handle;
+};
+
+template <typename Result, typename Completions, typename Value>
+DetachedTask async_transform_one(std::shared_ptr<Completions> completions,
+                                 Value value,
+                                 size_t index)
+{
+    AsyncCompletion<Result> completion{index};
+    try {
+        completion.value.emplace(co_await std::invoke(completions->transform(), std::move(value)));
+    }
+    catch (...) {
+        completion.error = std::current_exception();
+    }
+    completions->push(std::move(completion));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+template <typename View>
+using SourceElement = std::conditional_t<std::is_reference_v<std::ranges::range_reference_t<View>>,
+                                         std::ranges::range_reference_t<View>,
+                                         std::ranges::range_reference_t<View>&&>;
+
+template <typename ElementType, typename FactoryTuple, typename Upstream, typename Downstream>
+struct AsyncRunTypes;
+
+template <typename ElementType, typename FactoryTuple, size_t... upstream, size_t... downstream>
+struct AsyncRunTypes<ElementType, FactoryTuple, IndexSequence<upstream...>,
+                     IndexSequence<downstream...>> {
+    static constexpr size_t async_index = sizeof...(upstream);
+
+    template <typename Buffer>
+    using UpstreamPipeline =
+        Pipeline<ProcessingMode::Incremental, ElementType,
+                 std::tuple_element_t<upstream, FactoryTuple>...,
+                 StageFactory<ProcessingMode::Incremental, ProcessingMode::Batch, CollectInto,
+                              Buffer*>>;
+
+    using UpstreamInputs = typename UpstreamPipeline<Unit>::InputTypeList;
+
+    // Value handed to the asynchronous transformation.
+    using Value = std::remove_cvref_t<typename EZ_TYPE_AT(UpstreamInputs{}, async_index)>;
+
+    using AsyncFactory = std::tuple_element_t<async_index, FactoryTuple>;
+    using Awaitable = std::invoke_result_t<decltype(AsyncFactory::transform)&, Value&&>;
+    using Result = typename trait::AwaitableTraits<Awaitable>::R;
+
+    static_assert(!std::is_void_v<Result>, "async_transform must produce a value.");
+
+    using DownstreamPipeline = Pipeline<ProcessingMode::Incremental, Result&&,
+                                        std::tuple_element_t<downstream, FactoryTuple>...>;
+
+    using Output =
+        std::remove_cvref_t<decltype(std::declval<DownstreamPipeline&>().first().flush())>;
+};
+
+template <typename Executor, typename View, typename FactoryTuple, size_t... upstream,
+          size_t... downstream>
+auto run_async(Executor& executor,
+               View view,
+               FactoryTuple factories,
+               IndexSequence<upstream...> upstream_indices,
+               IndexSequence<downstream...> downstream_indices)
+    -> async::Task<typename AsyncRunTypes<SourceElement<View>, FactoryTuple,
+                                          decltype(upstream_indices),
+                                          decltype(downstream_indices)>::Output>
+{
+    using Types = AsyncRunTypes<SourceElement<View>, FactoryTuple, decltype(upstream_indices),
+                                decltype(downstream_indices)>;
+    using Value = typename Types::Value;
+    using Result = typename Types::Result;
+    using Transform = decltype(Types::AsyncFactory::transform);
+    using Completions = AsyncCompletions<Executor, Result, Transform>;
+
+    auto& async_stage = std::get<Types::async_index>(factories);
+    const size_t limit = async_stage.concurrency;
+    const bool ordered = async_stage.order == AsyncOrder::Ordered;
+
+    // Elements produced by the upstream stages for the current source element.
+    std::vector<Value> values;
+    size_t value_index = 0;
+
+    typename Types::template UpstreamPipeline<std::vector<Value>> upstream_pipeline{
+        std::in_place, std::get<upstream>(factories)..., collect_into(&values)};
+    typename Types::DownstreamPipeline downstream_pipeline{std::in_place,
+                                                           std::get<downstream>(factories)...};
+
+    auto it = std::ranges::begin(view);
+    const auto end = std::ranges::end(view);
+    bool upstream_flushed = false;
+
+    // Returns false once the source and the upstream stages are exhausted.
+    auto next_value = [&]() -> bool {
+        while (value_index == values.size()) {
+            values.clear();
+            value_index = 0;
+
+            if (it != end && !upstream_pipeline.first().any_done()) {
+                using Element = SourceElement<View>;
+                upstream_pipeline.first().process_incremental(static_cast<Element>(*it));
+                ++it;
+            }
+            else if (!upstream_flushed) {
+                upstream_flushed = true;
+                unused(upstream_pipeline.first().flush());
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto completions = std::make_shared<Completions>(executor, std::move(async_stage.transform));
+
+    size_t next_index = 0;
+    size_t next_emitted = 0;
+    size_t in_flight = 0;
+    std::vector<Option<Result>> reorder_window(ordered ? limit : 0);
+    std::exception_ptr error;
+
+    auto can_start = [&] {
+        if (error || downstream_pipeline.first().any_done()) return false;
+        return ordered ? next_index - next_emitted < limit : in_flight < limit;
+    };
+
+    for (;;) {
+        try {
+            while (can_start() && next_value()) {
+                auto task = async_transform_one<Result>(
+                    completions, std::move(values[value_index++]), next_index++);
+                ++in_flight;
+                async::post(executor, [handle = task.handle] { handle.resume(); });
+            }
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        if (in_flight == 0) break;
+
+        // Completions keep being consumed after a failure: the task completes once no
+        // transformation is in flight.
+        for (AsyncCompletion<Result>& completion : co_await completions->wait()) {
+            --in_flight;
+            if (error || downstream_pipeline.first().any_done()) continue;
+
+            try {
+                if (completion.error) std::rethrow_exception(completion.error);
+
+                if (!ordered) {
+                    downstream_pipeline.first().process_incremental(std::move(*completion.value));
+                    continue;
+                }
+
+                reorder_window[completion.index % limit] = std::move(completion.value);
+                for (;;) {
+                    Option<Result>& slot = reorder_window[next_emitted % limit];
+                    if (!slot || downstream_pipeline.first().any_done()) break;
+                    downstream_pipeline.first().process_incremental(std::move(*slot));
+                    slot.reset();
+                    ++next_emitted;
+                }
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+    co_return downstream_pipeline.first().flush();
+}
+
+}  // namespace internal
+
+///////////////////////////////////////////////////////////////////////
+
+/// Runs a pipeline containing an `async_transform` stage as a task. The stages before it run
+/// element by element as transformations complete, so at most `concurrency` elements are
+/// buffered, and the stages after it receive the results on the executor.
+/// A pipeline holds a single `async_transform`. Failures are rethrown by the task once the
+/// transformations in flight are completed.
+/// An lvalue range is referenced by the task and must outlive it, an rvalue range is moved in.
+/// Usage:
+/// @code
+/// auto enriched = co_await rpl::run_async(
+///     context,
+///     user_ids,
+///     rpl::filter(is_active),
+///     rpl::async_transform([&](u64 id) -> async::Task<User> { co_return co_await fetch(id); },
+///                          128, rpl::AsyncOrder::Unordered),
+///     rpl::to_vector());
+/// @endcode
+template <typename Executor, std::ranges::viewable_range Range, typename... StageFactories>
+auto run_async(Executor& executor, Range&& range, StageFactories&&... factories)
+{
+    constexpr size_t stage_count = sizeof...(StageFactories);
+    constexpr size_t async_index =
+        internal::async_stage_index<std::remove_cvref_t<StageFactories>...>();
+
+    static_assert(async_index < stage_count, "run_async requires an async_transform stage.");
+    static_assert(async_index + 1 < stage_count,
+                  "run_async requires stages after async_transform (to_vector, for_each...).");
+
+    using FactoryTuple = std::tuple<std::remove_cvref_t<StageFactories>...>;
+
+    return internal::run_async(
+        executor, std::views::all(std::forward<Range>(range)),
+        FactoryTuple{std::forward<StageFactories>(factories)...},
+        std::make_index_sequence<async_index>{},
+        internal::offset_sequence<async_index + 1>(
+            std::make_index_sequence<stage_count - async_index - 1>{}));
+}
+
+}  // namespace ez::rpl
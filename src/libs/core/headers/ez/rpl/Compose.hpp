@@ -3,6 +3,8 @@
 #include <ez/rpl/Pipeline.hpp>
 #include <ez/rpl/StageFactory.hpp>
 
+#include <span>
+
 namespace ez::rpl {
 
 template <typename InputType, typename... StageFactories>
@@ -17,25 +19,76 @@ struct Compose {
     static constexpr ProcessingMode output_processing_mode =
         LastStageFactory::output_processing_mode;
 
+    static constexpr size_t batch_output_count =
+        ((StageFactories::output_processing_mode == ProcessingMode::Batch) + ... + 0);
+
     using PipelineType = Pipeline<input_processing_mode, InputType, StageFactories...>;
     using OutputType = PipelineType::OutputType;
     using InputTypeList = PipelineType::InputTypeList;
 
+    static constexpr bool shares_state = PipelineType::any_shares_state();
+
     PipelineType pipeline;
 
     Compose(auto&&... factories) : pipeline{std::in_place, EZ_FWD(factories)...} {}
 
+    // Done once one of the composed stages (take...) does not accept more elements.
+    bool done() const
+        requires(std::remove_cvref_t<decltype(pipeline.stages.get(Index<0>{}))>::
+                     any_can_short_circuit())
+    {
+        return pipeline.stages.get(Index<0>{}).any_done();
+    }
+
     void process_incremental(InputType val, auto&& )
     {
         pipeline.first().process_incremental(static_cast<InputType>(val));
     }
 
-    void process_batch(InputType val, auto&& next)
+    // Chunks are only taken when the first composed stage processes them at once.
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&&)
+        requires(std::remove_cvref_t<decltype(pipeline.stages.get(Index<0>{}))>::
+                     consumes_chunks())
     {
-        next.process_bach(pipeline.first().process_batch(static_cast<InputType>(val)));
+        pipeline.first().process_chunk(chunk);
+    }
+
+    decltype(auto) process_batch(InputType val, auto&& next)
+        requires(output_processing_mode == ProcessingMode::Batch)
+    {
+        return next.process_batch(pipeline.first().process_batch(static_cast<InputType>(val)));
+    }
+
+    void process_batch(InputType, auto&&)
+        requires(output_processing_mode != ProcessingMode::Batch)
+    {
+        static_assert(output_processing_mode == ProcessingMode::Batch,
+                      "Composition with batch input must end with a batch output stage.");
     }
 
     decltype(auto) flush_to(auto&& next) { return next.process_batch(pipeline.last().flush()); }
+
+    decltype(auto) snapshot_to(auto&& next)
+    {
+        return next.process_batch(pipeline.first().snapshot());
+    }
+
+    // Partial results are merged by the last stage when it is the only one outputting a batch:
+    // the stages before it apply to each element, a stage after a reducer would apply to the
+    // partial results.
+    template <typename T>
+    decltype(auto) combine(T&& lhs, T&& rhs)
+        requires(batch_output_count == 1 && output_processing_mode == ProcessingMode::Batch)
+    {
+        return pipeline.last().combine(std::forward<T>(lhs), std::forward<T>(rhs));
+    }
+
+    void begin_partial()
+        requires(batch_output_count == 1 && output_processing_mode == ProcessingMode::Batch &&
+                 requires { pipeline.last().begin_partial(); })
+    {
+        pipeline.last().begin_partial();
+    }
 };
 
 template <typename... StageFactories>
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <ez/rpl/Run.hpp>
+
+#include <ez/async/Executor.hpp>
+
+#include <ez/Option.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <latch>
+#include <memory>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+namespace ez::rpl {
+
+/// Execution policy running the pipeline on chunks of a random access range concurrently.
+/// Stages up to the first batch output stage (the reducer: count, accumulate, min, max,
+/// to_vector...) are cloned per chunk, the partial results are merged with the reducer's
+/// `combine` and the remaining stages run on the caller thread, which also processes the chunks
+/// the executor did not start yet: the caller may be a worker of the executor. A reducer folding
+/// into an initial value (accumulate) only starts from it in the first chunk.
+/// Usage:
+/// @code
+/// io::ThreadPool pool;
+/// auto sum = rpl::run(rpl::par(pool), values, rpl::filter(pred), rpl::accumulate<i64>());
+/// @endcode
+template <typename Executor>
+struct ParallelPolicy {
+    Executor* executor = nullptr;
+    size_t concurrency = 1;
+    size_t min_chunk_size = 1;
+};
+
+template <typename Executor>
+auto par(Executor& executor,
+         size_t concurrency = std::max(1u, std::thread::hardware_concurrency()),
+         size_t min_chunk_size = 1024)
+{
+    return ParallelPolicy<Executor>{&executor, std::max<size_t>(concurrency, 1),
+                                    std::max<size_t>(min_chunk_size, 1)};
+}
+
+template <typename Executor>
+struct IsExecutionPolicy<ParallelPolicy<Executor>> : std::true_type {
+};
+
+///////////////////////////////////////////////////////////////////////
+
+namespace internal {
+
+template <typename... StageFactories>
+consteval size_t reducer_stage_index()
+{
+    constexpr bool batch_outputs[] = {
+        (StageFactories::output_processing_mode == ProcessingMode::Batch)...};
+
+    for (size_t i = 0; i < sizeof...(StageFactories); ++i) {
+        if (batch_outputs[i]) return i;
+    }
+    return sizeof...(StageFactories) - 1;
+}
+
+template <size_t last, typename... StageFactories>
+consteval bool incremental_inputs_up_to()
+{
+    constexpr bool incremental_inputs[] = {
+        is_streaming(StageFactories::input_processing_mode)...};
+
+    for (size_t i = 0; i <= last; ++i) {
+        if (!incremental_inputs[i]) return false;
+    }
+    return true;
+}
+
+template <typename Pipeline, size_t... indices>
+consteval bool is_splittable(IndexSequence<indices...>)
+{
+    using Sequence = typename Pipeline::StageSequence;
+    return (!Pipeline::template StageT<indices, Sequence>::can_short_circuit && ...);
+}
+
+template <typename Pipeline, size_t... indices>
+consteval bool shares_state(IndexSequence<indices...>)
+{
+    using Sequence = typename Pipeline::StageSequence;
+    return (Pipeline::template StageT<indices, Sequence>::shares_state || ...);
+}
+
+template <size_t offset, size_t... indices>
+constexpr auto offset_sequence(IndexSequence<indices...>)
+{
+    return IndexSequence<(offset + indices)...>{};
+}
+
+template <typename InputType, typename FactoryTuple, size_t... indices>
+auto make_sub_pipeline(const FactoryTuple& factories, IndexSequence<indices...>)
+{
+    return Pipeline<ProcessingMode::Batch, InputType,
+                    std::tuple_element_t<indices, FactoryTuple>...>{
+        std::in_place,
+        std::tuple_element_t<indices, FactoryTuple>(std::get<indices>(factories))...};
+}
+
+}  // namespace internal
+
+///////////////////////////////////////////////////////////////////////
+
+template <typename Executor, std::ranges::random_access_range Range, typename... StageFactories>
+    requires std::ranges::sized_range<Range>
+auto run(ParallelPolicy<Executor> policy, Range&& range, StageFactories&&... factories)
+{
+    static_assert(sizeof...(StageFactories) > 0, "Parallel run requires at least one stage");
+
+    using FactoryTuple = std::tuple<std::remove_cvref_t<StageFactories>...>;
+    using Chunk = std::ranges::subrange<std::ranges::iterator_t<Range&>>;
+
+    constexpr size_t stage_count = sizeof...(StageFactories);
+    constexpr size_t reducer_index =
+        internal::reducer_stage_index<std::remove_cvref_t<StageFactories>...>();
+    constexpr bool has_reducer = ((std::remove_cvref_t<StageFactories>::output_processing_mode ==
+                                   ProcessingMode::Batch) ||
+                                  ...);
+
+    constexpr auto split_indices = std::make_index_sequence<reducer_index + 1>{};
+    constexpr auto tail_indices = internal::offset_sequence<reducer_index + 1>(
+        std::make_index_sequence<stage_count - reducer_index - 1>{});
+
+    static_assert(internal::incremental_inputs_up_to<reducer_index,
+                                                     std::remove_cvref_t<StageFactories>...>(),
+                  "Parallel run requires incremental stages up to the reducer stage.");
+
+    FactoryTuple factory_tuple{EZ_FWD(factories)...};
+
+    using SplitPipeline =
+        decltype(internal::make_sub_pipeline<Chunk&&>(factory_tuple, split_indices));
+    using Partial = std::remove_cvref_t<decltype(
+        std::declval<SplitPipeline&>().first().process_batch(std::declval<Chunk&&>()))>;
+
+    static_assert(internal::is_splittable<SplitPipeline>(split_indices),
+                  "Stages that can short-circuit (take...) cannot run in parallel.");
+    static_assert(!internal::shares_state<SplitPipeline>(split_indices),
+                  "Profiled stages (rpl::profiled) are not thread safe, "
+                  "they cannot run in parallel.");
+
+    const size_t size = std::ranges::size(range);
+    const size_t chunk_count =
+        std::clamp<size_t>(size / policy.min_chunk_size, 1, policy.concurrency);
+    const size_t chunk_size = size / chunk_count;
+
+    auto chunk_at = [&](size_t index) {
+        auto begin = std::ranges::begin(range) + index * chunk_size;
+        auto end = (index + 1 == chunk_count) ? std::ranges::end(range) : begin + chunk_size;
+        return Chunk{begin, end};
+    };
+
+    std::vector<Option<Partial>> partials(chunk_count);
+    std::vector<std::exception_ptr> errors(chunk_count);
+    std::latch pending{static_cast<std::ptrdiff_t>(chunk_count)};
+
+    auto process_chunk = [&](size_t index) {
+        try {
+            auto pipeline = internal::make_sub_pipeline<Chunk&&>(factory_tuple, split_indices);
+            if constexpr (has_reducer &&
+                          requires { pipeline.stages.get(Index<reducer_index>{}).begin_partial(); }) {
+                if (index != 0) pipeline.stages.get(Index<reducer_index>{}).begin_partial();
+            }
+            partials[index].emplace(pipeline.first().process_batch(chunk_at(index)));
+        }
+        catch (...) {
+            errors[index] = std::current_exception();
+        }
+        pending.count_down();
+    };
+
+    // The chunks are claimed in order by the caller and by the tasks posted to the executor. The
+    // caller takes over the chunks not started yet, then only waits for the running ones: a run
+    // from a worker of the executor, or with an executor driven by the calling thread, does not
+    // deadlock. A task run late finds nothing to claim and only reads the shared counter.
+    auto next_chunk = std::make_shared<std::atomic<size_t>>(0);
+    for (size_t index = 1; index < chunk_count; ++index) {
+        async::post(*policy.executor, [next_chunk, &process_chunk, chunk_count] {
+            const size_t index = next_chunk->fetch_add(1, std::memory_order::relaxed);
+            if (index < chunk_count) process_chunk(index);
+        });
+    }
+    while (true) {
+        const size_t index = next_chunk->fetch_add(1, std::memory_order::relaxed);
+        if (index >= chunk_count) break;
+        process_chunk(index);
+    }
+    pending.wait();
+
+    for (auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    Partial result = std::move(*partials.front());
+
+    // Without reducer the pipeline only has side effects and there is nothing to merge.
+    if constexpr (has_reducer) {
+        auto pipeline = internal::make_sub_pipeline<Chunk&&>(factory_tuple, split_indices);
+        auto& reducer = pipeline.stages.get(Index<reducer_index>{});
+        for (size_t index = 1; index < chunk_count; ++index) {
+            result = reducer.combine(std::move(result), std::move(*partials[index]));
+        }
+    }
+
+    if constexpr (reducer_index + 1 == stage_count) { return result; }
+    else {
+        return [&]<size_t... indices>(IndexSequence<indices...>) {
+            return rpl::run(std::move(result), std::get<indices>(std::move(factory_tuple))...);
+        }(tail_indices);
+    }
+}
+
+}  // namespace ez::rpl
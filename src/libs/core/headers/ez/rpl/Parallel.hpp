@@ -3,6 +3,15 @@
 #include <ez/rpl/Pipeline.hpp>
 #include <ez/rpl/StageFactory.hpp>
 
+#include <ez/async/Executor.hpp>
+
+#include <ez/SpscQueue.hpp>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <span>
+
 namespace ez::rpl {
 
 template <typename InputType, typename... StageFactories>
@@ -13,7 +22,7 @@ struct Parallel {
         ((StageFactories::input_processing_mode == ProcessingMode::Batch) && ...);
 
     static constexpr bool all_inputs_incremental =
-        ((StageFactories::input_processing_mode == ProcessingMode::Incremental) && ...);
+        (is_streaming(StageFactories::input_processing_mode) && ...);
 
     static constexpr bool all_outputs_batch =
         ((StageFactories::output_processing_mode == ProcessingMode::Batch) && ...);
@@ -28,12 +37,12 @@ struct Parallel {
     using LastStageFactory = EZ_TYPE_AT(meta::type_list<StageFactories...>, stage_count - 1);
 
     static constexpr ProcessingMode input_processing_mode =
-        FirstStageFactory::input_processing_mode;
+        all_inputs_batch ? ProcessingMode::Batch : ProcessingMode::Incremental;
     static constexpr ProcessingMode output_processing_mode =
         FirstStageFactory::output_processing_mode;
 
     template <typename Factory>
-    using PipelineType = Pipeline<input_processing_mode, InputType, Factory>;
+    using PipelineType = Pipeline<Factory::input_processing_mode, InputType, Factory>;
 
     using PipelineTuple = Tuple<PipelineType<StageFactories>...>;
     using OutputType = Tuple<typename PipelineType<StageFactories>::OutputType...>&&;
@@ -52,17 +61,40 @@ struct Parallel {
         });
     }
 
+    // Branches cannot share a chunk of rvalues, those are forwarded element by element, and so
+    // are the elements when a branch processes them one at a time.
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&&)
+        requires std::is_lvalue_reference_v<InputType> &&
+                 (internal::consumes_chunks<
+                      decltype(std::declval<PipelineType<StageFactories>&>().first())>() &&
+                  ...)
+    {
+        tuple::for_each(pipelines, [&](auto& pipeline) { pipeline.first().process_chunk(chunk); });
+    }
+
+    // Every branch but the last one works on its own copy of an rvalue input.
+    template <size_t index>
+    decltype(auto) branch_input(InputType val)
+    {
+        if constexpr (std::is_lvalue_reference_v<InputType> || index + 1 == stage_count) {
+            return static_cast<InputType>(val);
+        }
+        else {
+            return std::remove_cvref_t<InputType>(val);
+        }
+    }
+
     template <size_t... indices>
-    void process_batch_impl(InputType val, auto&& next, IndexSequence<indices...>)
+    decltype(auto) process_batch_impl(InputType val, auto&& next, IndexSequence<indices...>)
     {
-        next.process_bach(Tuple{
-            pipelines[let<indices>].first().process_batch(static_cast<InputType>(val))...});
+        return next.process_batch(Tuple{pipelines[let<indices>].first().process_batch(
+            static_cast<InputType>(branch_input<indices>(static_cast<InputType>(val))))...});
     }
 
-    void process_batch(InputType val, auto&& next)
+    decltype(auto) process_batch(InputType val, auto&& next)
     {
-        process_batch_impl(static_cast<InputType>(val), EZ_FWD(next),
-                           IndexSequenceFor<StageFactories...>{});
+        return process_batch_impl(static_cast<InputType>(val), EZ_FWD(next),
+                                  IndexSequenceFor<StageFactories...>{});
     }
 
     template <size_t... indices>
@@ -77,6 +109,197 @@ struct Parallel {
     }
 };
 
+///////////////////////////////////////////////////////////////////////
+
+/// Executor on which the branches of a concurrent parallel stage run.
+/// Each branch is fed through a bounded buffer of `buffer_capacity` elements.
+template <typename Executor>
+struct On {
+    Executor* executor = nullptr;
+    size_t buffer_capacity = 1024;
+};
+
+template <typename Executor>
+auto on(Executor& executor, size_t buffer_capacity = 1024)
+{
+    return On<Executor>{&executor, buffer_capacity};
+}
+
+///////////////////////////////////////////////////////////////////////
+
+template <typename InputType, typename Options, typename... StageFactories>
+struct ConcurrentParallel {
+    static constexpr size_t stage_count = sizeof...(StageFactories);
+
+    static_assert((is_streaming(StageFactories::input_processing_mode) && ...),
+                  "Concurrent parallel stages must have an incremental input processing mode");
+
+    using Value = std::remove_cvref_t<InputType>;
+
+    template <typename Factory>
+    using PipelineType = Pipeline<Factory::input_processing_mode, Value&&, Factory>;
+
+    using OutputType = Tuple<typename PipelineType<StageFactories>::OutputType...>&&;
+
+    // A branch is consumed by one thread at a time, the holder of the `consuming` flag: an
+    // executor task, or the producer when the buffer is full or when it waits for the branch to
+    // be idle. The producer then does not depend on the executor making progress, which may be
+    // driven by the calling thread itself. A thread finding the flag taken blocks until it is
+    // released. The posted tasks share the ownership of the branch, those running late find an
+    // empty buffer.
+    template <typename Factory>
+    struct Branch {
+        PipelineType<Factory> pipeline;
+        SpscQueue<Value> queue;
+        std::atomic_bool scheduled{false};
+        std::atomic_bool consuming{false};
+        std::exception_ptr error;
+
+        Branch(auto&& factory, size_t capacity)
+            : pipeline{std::in_place, EZ_FWD(factory)}, queue{capacity}
+        {
+        }
+    };
+
+    Options options;
+    Tuple<std::shared_ptr<Branch<StageFactories>>...> branches;
+
+    ConcurrentParallel(Options opts, auto&&... factories)
+        : options{opts},
+          branches{std::make_shared<Branch<StageFactories>>(EZ_FWD(factories),
+                                                            opts.buffer_capacity)...}
+    {
+    }
+
+    ConcurrentParallel(ConcurrentParallel&&) = default;
+
+    ~ConcurrentParallel()
+    {
+        tuple::for_each(branches, [&](auto& branch) {
+            if (branch) wait_idle(*branch);
+        });
+    }
+
+    void process_incremental(InputType val, auto&&)
+    {
+        tuple::for_each(branches, [&](auto& branch) { push(branch, std::as_const(val)); });
+    }
+
+    template <size_t... indices>
+    decltype(auto) flush_to_impl(auto&& next, IndexSequence<indices...>)
+    {
+        tuple::for_each(branches, [&](auto& branch) { wait_idle(*branch); });
+        tuple::for_each(branches, [&](auto& branch) {
+            if (branch->error) std::rethrow_exception(branch->error);
+        });
+
+        return next.process_batch(Tuple{branches[let<indices>]->pipeline.first().flush()...});
+    }
+
+    decltype(auto) flush_to(auto&& next)
+    {
+        return flush_to_impl(EZ_FWD(next), IndexSequenceFor<StageFactories...>{});
+    }
+
+private:
+    template <typename Branch>
+    void push(const std::shared_ptr<Branch>& branch, const Value& value)
+    {
+        while (!branch->queue.try_push(value)) {
+            schedule(branch);
+            if (!try_consume(*branch)) wait_released(*branch);
+        }
+        schedule(branch);
+    }
+
+    template <typename Branch>
+    void schedule(const std::shared_ptr<Branch>& branch)
+    {
+        if (branch->scheduled.exchange(true, std::memory_order::acq_rel)) return;
+        async::post(*options.executor, [branch] { drain(*branch); });
+    }
+
+    template <typename Branch>
+    static void drain(Branch& branch)
+    {
+        for (;;) {
+            if (!try_consume(branch)) wait_released(branch);
+
+            branch.scheduled.store(false, std::memory_order::release);
+
+            // Values pushed after the last pop but before the flag was cleared did not
+            // schedule a new drain.
+            if (branch.queue.empty() || branch.scheduled.exchange(true, std::memory_order::acq_rel))
+                break;
+        }
+    }
+
+    // Consumes the buffered values, false when another thread is already consuming them.
+    template <typename Branch>
+    static bool try_consume(Branch& branch)
+    {
+        if (branch.consuming.exchange(true, std::memory_order::acquire)) return false;
+
+        while (auto value = branch.queue.try_pop()) {
+            if (branch.error || branch.pipeline.first().any_done()) continue;
+            try {
+                branch.pipeline.first().process_incremental(std::move(*value));
+            }
+            catch (...) {
+                branch.error = std::current_exception();
+            }
+        }
+
+        branch.consuming.store(false, std::memory_order::release);
+        branch.consuming.notify_all();
+        return true;
+    }
+
+    // Blocks until the thread consuming the branch is done with the buffered values.
+    template <typename Branch>
+    static void wait_released(Branch& branch)
+    {
+        branch.consuming.wait(true, std::memory_order::acquire);
+    }
+
+    // Called by the producer, every value it pushed is then consumed.
+    template <typename Branch>
+    static void wait_idle(Branch& branch)
+    {
+        while (!try_consume(branch)) wait_released(branch);
+    }
+};
+
+template <typename Options, typename... StageFactories>
+auto concurrent_parallel(Options options, StageFactories&&... factories)
+{
+    static_assert(sizeof...(StageFactories) > 0, "Parallel requires at least one stage");
+
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, ConcurrentParallel,
+                        Options, StageFactories...>(std::move(options),
+                                                    std::forward<StageFactories>(factories)...);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/// Forks the stream to several sub pipelines and joins their outputs in a Tuple.
+/// Usage:
+/// @code
+/// auto [min, max] = rpl::run(values, rpl::parallel(rpl::min(), rpl::max()));
+/// @endcode
+/// When the first argument is `rpl::on(executor)`, each branch runs concurrently on the
+/// executor and is fed through a bounded single producer single consumer buffer. When a buffer
+/// is full, the producer consumes it itself rather than waiting for the executor.
+/// @code
+/// auto [hashes, sizes] = rpl::run(
+///     files, rpl::parallel(rpl::on(pool), rpl::compose(hash, rpl::to_vector()), size_stats));
+/// @endcode
+template <typename Executor, typename... StageFactories>
+auto parallel(On<Executor> options, StageFactories&&... factories)
+{
+    return concurrent_parallel(options, std::forward<StageFactories>(factories)...);
+}
+
 template <typename... StageFactories>
 auto parallel(StageFactories&&... factories)
 {
@@ -89,7 +312,9 @@ auto parallel(StageFactories&&... factories)
         using LastStageFactory = EZ_TYPE_AT(meta::type_list<StageFactories...>, stage_count - 1);
 
         static constexpr ProcessingMode input_processing_mode =
-            std::remove_cvref_t<FirstStageFactory>::input_processing_mode;
+            is_streaming(std::remove_cvref_t<FirstStageFactory>::input_processing_mode)
+                ? ProcessingMode::Incremental
+                : ProcessingMode::Batch;
         static constexpr ProcessingMode output_processing_mode =
             std::remove_cvref_t<LastStageFactory>::output_processing_mode;
 
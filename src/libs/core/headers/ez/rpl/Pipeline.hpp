@@ -15,7 +15,9 @@ struct PipelineTerminator {
     }
 
     void process_incremental(Unit&&, auto&&...) {}
+    void reserve(size_t) {}
     Unit flush() { return {}; }
+    Unit snapshot() { return {}; }
 };
 
 ///////////////////////////////////////////////////////////////////////
@@ -26,6 +28,21 @@ constexpr auto get_pipeline_input_types_impl()
     return meta::type_list<>;
 }
 
+// Single pass views (e.g. async::Generator) are only iterable as lvalues.
+template <typename Range>
+struct BatchValue {
+    using Type = decltype(*std::begin(std::declval<Range>()));
+};
+
+template <typename Range>
+    requires(!requires { std::begin(std::declval<Range>()); })
+struct BatchValue<Range> {
+    using Type = decltype(*std::ranges::begin(std::declval<std::remove_reference_t<Range>&>()));
+};
+
+template <typename Range>
+using BatchValueType = typename BatchValue<Range>::Type;
+
 template <ProcessingMode input_mode,
           typename InputType,
           typename StageFactory,
@@ -36,8 +53,8 @@ constexpr auto get_pipeline_input_types_impl()
     constexpr ProcessingMode stage_ouput_processing_mode = StageFactory::output_processing_mode;
 
     if constexpr (input_mode == ProcessingMode::Batch &&
-                  stage_input_processing_mode == ProcessingMode::Incremental) {
-        using ValueType = decltype(*std::begin(std::declval<InputType>()));
+                  is_streaming(stage_input_processing_mode)) {
+        using ValueType = BatchValueType<InputType>;
 
         using T = std::conditional_t<std::is_reference_v<ValueType>, ValueType,
                                      std::add_rvalue_reference_t<ValueType> >;
@@ -130,8 +147,20 @@ struct PipelineStages<input_mode, InputType, IndexSequence<indices...>, StageFac
         {
             return ((indices >= index && this->get(Index<indices>{}).done()) || ...);
         }
+
+        template <size_t index>
+        static consteval bool any_can_short_circuit(Index<index>)
+        {
+            return ((indices >= index && StageT<indices, StageSequence>::can_short_circuit) ||
+                    ...);
+        }
     };
 
+    static consteval bool any_shares_state()
+    {
+        return (StageT<indices, StageSequence>::shares_state || ...);
+    }
+
     StageSequence stages;
     PipelineStages(Inplace, auto&&... factories) : stages{EZ_FWD(factories)...} {}
 
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <ez/rpl/Compose.hpp>
+#include <ez/rpl/StageFactory.hpp>
+
+#include <ez/ExecutionReport.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ez::rpl {
+
+struct StageProfile {
+    using Duration = std::chrono::nanoseconds;
+
+    std::string name;
+    size_t elements_in = 0;
+    size_t elements_out = 0;
+    bool short_circuited = false;
+
+    // Elements received one by one are timed every `sample_period` calls, chunks, batches and
+    // flushes are always timed. Durations include the time spent in the downstream stages.
+    size_t incremental_calls = 0;
+    size_t sampled_calls = 0;
+    Duration sampled_time{};
+    Duration timed_time{};
+
+    /// Time spent in this stage and in the following ones, extrapolated from the samples.
+    Duration total_time() const
+    {
+        if (sampled_calls == 0) return timed_time;
+        return timed_time + sampled_time * incremental_calls / sampled_calls;
+    }
+};
+
+/// Statistics of the stages wrapped by `rpl::profiled`. Not thread safe: `rpl::par` rejects the
+/// pipelines cloning a profiled stage per chunk.
+struct PipelineProfile {
+    explicit PipelineProfile(size_t period = 64) : sample_period{std::max<size_t>(period, 1)} {}
+
+    size_t sample_period = 64;
+    std::vector<StageProfile> stages;
+
+    /// Time spent in the stage itself: its total time minus the total time of the next stage.
+    StageProfile::Duration self_time(size_t index) const
+    {
+        auto total = stages[index].total_time();
+        if (index + 1 < stages.size()) total -= stages[index + 1].total_time();
+        return std::max(total, StageProfile::Duration::zero());
+    }
+
+    std::string to_json() const
+    {
+        std::string json = std::format(R"({{"sample_period":{},"stages":[)", sample_period);
+        for (size_t i = 0; i < stages.size(); ++i) {
+            const StageProfile& stage = stages[i];
+            json += std::format(
+                R"({}{{"name":"{}","elements_in":{},"elements_out":{},"short_circuited":{},)"
+                R"("total_ns":{},"self_ns":{}}})",
+                i == 0 ? "" : ",", json_escape(stage.name), stage.elements_in, stage.elements_out,
+                stage.short_circuited, stage.total_time().count(), self_time(i).count());
+        }
+        return json + "]}";
+    }
+
+    /// Adds a sub report per stage to `report`, the statistics are logged as info messages.
+    void export_to(ExecutionReport& report) const
+    {
+        for (size_t i = 0; i < stages.size(); ++i) {
+            const StageProfile& stage = stages[i];
+            ExecutionReport stage_report = report.create_sub_report(reporting::name = stage.name);
+            auto message = stage_report.info();
+            message << std::format(
+                "in: {}, out: {}, self: {}, total: {}{}", stage.elements_in, stage.elements_out,
+                std::chrono::duration_cast<std::chrono::microseconds>(self_time(i)),
+                std::chrono::duration_cast<std::chrono::microseconds>(stage.total_time()),
+                stage.short_circuited ? ", short circuited" : "");
+            stage_report.set_status(ExecutionStatus::Finished);
+        }
+    }
+
+private:
+    // Stage names are user provided: quotes, backslashes and control characters are escaped.
+    static std::string json_escape(std::string_view text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                escaped += std::format("\\u{:04x}", int(c));
+            }
+            else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////
+
+namespace internal {
+
+class ProfileTimer {
+public:
+    explicit ProfileTimer(StageProfile::Duration& total) : m_total{total} {}
+    ~ProfileTimer() { m_total += std::chrono::steady_clock::now() - m_start; }
+
+    ProfileTimer(const ProfileTimer&) = delete;
+    ProfileTimer& operator=(const ProfileTimer&) = delete;
+
+private:
+    StageProfile::Duration& m_total;
+    std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+};
+
+// Next stage seen by a profiled stage, counts the emitted elements.
+template <typename Next>
+struct ProfiledNext {
+    Next& next;
+    StageProfile& profile;
+
+    template <typename T>
+    void process_incremental(T&& value)
+    {
+        ++profile.elements_out;
+        next.process_incremental(std::forward<T>(value));
+    }
+
+    template <typename T>
+    void process_chunk(std::span<T> chunk)
+    {
+        profile.elements_out += chunk.size();
+        next.process_chunk(chunk);
+    }
+
+    template <typename T>
+    decltype(auto) process_batch(T&& value)
+    {
+        ++profile.elements_out;
+        return next.process_batch(std::forward<T>(value));
+    }
+
+    decltype(auto) flush() { return next.flush(); }
+    decltype(auto) snapshot() { return next.snapshot(); }
+    bool any_done() const { return internal::is_done(next); }
+    static consteval bool any_can_short_circuit() { return internal::can_short_circuit<Next>(); }
+    static consteval bool consumes_chunks() { return internal::consumes_chunks<Next>(); }
+    void reserve(size_t count) { next.reserve(count); }
+};
+
+}  // namespace internal
+
+template <typename InputType, typename Factory, typename...>
+struct Profiled {
+    using Inner = Factory::template Stage<InputType>;
+    using OutputType = Inner::OutputType;
+    using Element = std::remove_reference_t<InputType>;
+
+    static constexpr bool preserves_size = requires { requires Inner::preserves_size; };
+
+    // The copies of the stage update the same statistics: it cannot be cloned by `rpl::par`.
+    static constexpr bool shares_state = true;
+
+    Inner inner;
+    PipelineProfile* pipeline_profile = nullptr;
+    size_t index = 0;
+    size_t calls_until_sample = 0;
+
+    Profiled(Inner&& stage, PipelineProfile* pipeline, size_t i)
+        : inner{std::move(stage)}, pipeline_profile{pipeline}, index{i}
+    {
+    }
+
+    StageProfile& profile() const { return pipeline_profile->stages[index]; }
+
+    auto wrap(auto& next) const
+    {
+        return internal::ProfiledNext<std::remove_reference_t<decltype(next)>>{next, profile()};
+    }
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        StageProfile& stats = profile();
+        ++stats.elements_in;
+        auto wrapped = wrap(next);
+        ++stats.incremental_calls;
+        if (calls_until_sample-- != 0) {
+            inner.process_incremental(static_cast<InputType>(input), wrapped);
+            return;
+        }
+        calls_until_sample = pipeline_profile->sample_period - 1;
+        ++stats.sampled_calls;
+        internal::ProfileTimer timer{stats.sampled_time};
+        inner.process_incremental(static_cast<InputType>(input), wrapped);
+    }
+
+    void process_chunk(std::span<Element> chunk, auto&& next)
+        requires requires(internal::ProfiledNext<std::remove_reference_t<decltype(next)>> n) {
+            inner.process_chunk(chunk, n);
+        }
+    {
+        StageProfile& stats = profile();
+        stats.elements_in += chunk.size();
+        auto wrapped = wrap(next);
+        internal::ProfileTimer timer{stats.timed_time};
+        inner.process_chunk(chunk, wrapped);
+    }
+
+    decltype(auto) process_batch(InputType input, auto&& next)
+        requires requires(internal::ProfiledNext<std::remove_reference_t<decltype(next)>> n) {
+            inner.process_batch(static_cast<InputType>(input), n);
+        }
+    {
+        StageProfile& stats = profile();
+        ++stats.elements_in;
+        auto wrapped = wrap(next);
+        internal::ProfileTimer timer{stats.timed_time};
+        return inner.process_batch(static_cast<InputType>(input), wrapped);
+    }
+
+    decltype(auto) flush_to(auto&& next)
+    {
+        internal::ProfileTimer timer{profile().timed_time};
+        auto wrapped = wrap(next);
+        if constexpr (requires { inner.flush_to(wrapped); }) { return inner.flush_to(wrapped); }
+        else {
+            return next.flush();
+        }
+    }
+
+    decltype(auto) snapshot_to(auto&& next)
+    {
+        auto wrapped = wrap(next);
+        if constexpr (requires { inner.snapshot_to(wrapped); }) {
+            return inner.snapshot_to(wrapped);
+        }
+        else {
+            static_assert(!requires { inner.flush_to(wrapped); },
+                          "Profiled stage does not implement snapshot_to.");
+            return next.snapshot();
+        }
+    }
+
+    void reserve(size_t count, auto&& next)
+    {
+        auto wrapped = wrap(next);
+        if constexpr (requires { inner.reserve(count, wrapped); }) {
+            inner.reserve(count, wrapped);
+        }
+        else if constexpr (preserves_size) {
+            next.reserve(count);
+        }
+    }
+
+    bool done() const
+        requires requires(const Inner& stage) { stage.done(); }
+    {
+        const bool done = inner.done();
+        if (done) profile().short_circuited = true;
+        return done;
+    }
+};
+
+template <typename Factory>
+struct ProfiledFactory {
+    template <typename InputType>
+    using Stage = Profiled<InputType, Factory>;
+
+    static constexpr ProcessingMode input_processing_mode = Factory::input_processing_mode;
+    static constexpr ProcessingMode output_processing_mode = Factory::output_processing_mode;
+
+    Factory factory;
+    PipelineProfile* profile = nullptr;
+    size_t index = 0;
+
+    template <typename InputType>
+    auto make(Type<InputType> type) &
+    {
+        return Stage<InputType>{factory.make(type), profile, index};
+    }
+
+    template <typename InputType>
+    auto make(Type<InputType> type) &&
+    {
+        return Stage<InputType>{std::move(factory).make(type), profile, index};
+    }
+};
+
+/// Composition of `factories` recording in `profile`, for each stage, the elements received and
+/// emitted, the time spent and whether it short-circuited the input. Only the calls sampled
+/// every `profile.sample_period` elements are timed. The pipelines without `profiled` are not
+/// instrumented at all.
+/// Usage:
+/// @code
+/// rpl::PipelineProfile profile;
+/// auto result = rpl::run(values, rpl::profiled(profile, rpl::filter(f), rpl::to_vector()));
+/// profile.stages[0].name = "filter";
+/// std::string json = profile.to_json();
+/// @endcode
+template <typename... StageFactories>
+auto profiled(PipelineProfile& profile, StageFactories&&... factories)
+{
+    profile.stages.clear();
+    for (size_t i = 0; i < sizeof...(StageFactories); ++i) {
+        profile.stages.push_back(StageProfile{.name = std::format("stage {}", i)});
+    }
+
+    return [&]<size_t... indices>(std::index_sequence<indices...>) {
+        return compose(ProfiledFactory<std::remove_cvref_t<StageFactories>>{
+            std::forward<StageFactories>(factories), &profile, indices}...);
+    }(std::index_sequence_for<StageFactories...>{});
+}
+
+}  // namespace ez::rpl
@@ -4,7 +4,15 @@
 
 namespace ez::rpl {
 
+template <typename T>
+struct IsExecutionPolicy : std::false_type {
+};
+
+template <typename T>
+concept ExecutionPolicy = IsExecutionPolicy<std::remove_cvref_t<T>>::value;
+
 template <typename Range, typename... StageFactories>
+    requires(!ExecutionPolicy<Range>)
 auto run(Range&& range, StageFactories&&... factories)
 {
     if constexpr (sizeof...(StageFactories) == 0) {
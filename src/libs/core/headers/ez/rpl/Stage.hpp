@@ -4,6 +4,13 @@
 
 #include <ez/TypeUtils.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
 namespace ez::rpl {
 
 template <size_t Id, typename Sequence, typename InputType, typename StageFactory>
@@ -11,11 +18,36 @@ class Stage {
 public:
     using StageImpl = StageFactory::template Stage<InputType>;
     using OutputType = typename StageImpl::OutputType;
+    using Element = std::remove_reference_t<InputType>;
+
+    static constexpr bool chunked_input =
+        StageFactory::input_processing_mode == ProcessingMode::Chunked;
+
+    // Elements received one by one are gathered in chunks when they can be moved or copied
+    // without changing the semantics: mutable lvalues and non-copyable ones are handed over one
+    // at a time, downstream stages must see the elements themselves.
+    static constexpr bool buffered_input =
+        chunked_input && (std::is_rvalue_reference_v<InputType> ||
+                          (std::is_const_v<Element> && std::is_copy_constructible_v<Element>));
 
 private:
     StageImpl m_stage;
 
+    // Elements received one by one by a chunked stage, handed over once a chunk is complete.
+    [[no_unique_address]] std::conditional_t<buffered_input,
+                                             std::vector<std::remove_cvref_t<InputType>>,
+                                             Unit>
+        m_pending;
+
 public:
+    static constexpr bool can_short_circuit = requires(const StageImpl& stage) { stage.done(); };
+
+    // Stages writing to a state shared by their copies (rpl::profiled) cannot be cloned per chunk.
+    static constexpr bool shares_state = requires { requires StageImpl::shares_state; };
+
+    // Stages emitting exactly one element per input element forward the size hints.
+    static constexpr bool preserves_size = requires { requires StageImpl::preserves_size; };
+
     static_assert(std::is_reference_v<InputType>, "InputType must be a reference.");
     static_assert(std::is_lvalue_reference_v<OutputType> || std::is_rvalue_reference_v<OutputType>,
                   "OutputType must be a reference.");
@@ -46,10 +78,27 @@ public:
 
     constexpr bool any_done() const { return sequence().any_done(Index<Id>{}); }
 
+    // Whether this stage or a later one may stop accepting elements.
+    static consteval bool any_can_short_circuit()
+    {
+        return Sequence::any_can_short_circuit(Index<Id>{});
+    }
+
+    // Whether this stage implements process_chunk for its input and next stage.
+    static consteval bool consumes_chunks()
+    {
+        using Next = decltype(std::declval<Stage&>().next());
+        return requires(StageImpl& stage, std::span<Element> chunk, Next next_stage) {
+            stage.process_chunk(chunk, next_stage);
+        };
+    }
+
     constexpr decltype(auto) flush()
     {
-        static_assert(StageFactory::input_processing_mode == ProcessingMode::Incremental,
+        static_assert(is_streaming(StageFactory::input_processing_mode),
                       "flush called on non incremental processing stage.");
+        if constexpr (buffered_input) process_pending();
+
         if constexpr (requires { m_stage.flush_to(next()); }) {
             static_assert(!std::is_void_v<decltype(m_stage.flush_to(next()))>,
                           "flush must not return void.");
@@ -60,10 +109,102 @@ public:
         }
     }
 
+    // Result of the elements received so far, the stages keep their state: the reducing stages
+    // hand over a copy of their aggregate, the other ones forward the call.
+    constexpr decltype(auto) snapshot()
+    {
+        static_assert(is_streaming(StageFactory::input_processing_mode),
+                      "snapshot called on non incremental processing stage.");
+        if constexpr (buffered_input) process_pending();
+
+        if constexpr (requires { m_stage.snapshot_to(next()); }) {
+            return m_stage.snapshot_to(next());
+        }
+        else {
+            static_assert(!requires { m_stage.flush_to(next()); },
+                          "Stage does not implement snapshot_to, its result is only known at the "
+                          "end of the input.");
+            return next().snapshot();
+        }
+    }
+
+    // Hint that about `count` more elements are going to be processed, stages collecting the
+    // elements can pre-allocate their storage.
+    void reserve(size_t count)
+    {
+        if constexpr (requires { m_stage.reserve(count, next()); }) {
+            m_stage.reserve(count, next());
+        }
+        else if constexpr (preserves_size) {
+            next().reserve(count);
+        }
+    }
+
+    // Merges two partial results produced by independent copies of this stage.
+    template <typename T>
+    decltype(auto) combine(T&& lhs, T&& rhs)
+    {
+        static_assert(requires { m_stage.combine(std::forward<T>(lhs), std::forward<T>(rhs)); },
+                      "Stage does not implement combine.");
+        return m_stage.combine(std::forward<T>(lhs), std::forward<T>(rhs));
+    }
+
+    // Resets a reducer which folds into an initial value before it processes a chunk of a parallel
+    // run other than the first.
+    void begin_partial()
+        requires requires(StageImpl& stage) { stage.begin_partial(); }
+    {
+        m_stage.begin_partial();
+    }
+
     // Only accept InputType with exactly matching reference type.
     template <typename T>
     void process_incremental(T&& t) = delete;
     void process_incremental(InputType t)
+    {
+        if constexpr (buffered_input) {
+            if (m_pending.empty()) m_pending.reserve(chunk_size);
+            m_pending.push_back(static_cast<InputType>(t));
+            if (m_pending.size() == chunk_size) process_pending();
+        }
+        else if constexpr (chunked_input) {
+            m_stage.process_chunk(std::span<Element>{std::addressof(t), 1}, next());
+        }
+        else {
+            process_element(static_cast<InputType>(t));
+        }
+    }
+
+    // Processes contiguous elements at once when the stage implements process_chunk, element by
+    // element otherwise.
+    void process_chunk(std::span<Element> chunk)
+    {
+        constexpr bool has_process_chunk = requires { m_stage.process_chunk(chunk, next()); };
+
+        static_assert(!chunked_input || has_process_chunk,
+                      "Stage with chunked processing mode does not implement process_chunk.");
+
+        if constexpr (has_process_chunk) {
+            if constexpr (buffered_input) process_pending();
+            m_stage.process_chunk(chunk, next());
+        }
+        else {
+            for (Element& input : chunk) {
+                if (any_done()) break;
+                process_element(static_cast<InputType>(input));
+            }
+        }
+    }
+
+private:
+    void process_pending()
+    {
+        if (m_pending.empty()) return;
+        m_stage.process_chunk(std::span<Element>{m_pending}, next());
+        m_pending.clear();
+    }
+
+    void process_element(InputType t)
     {
         constexpr bool has_process_incremental = requires
         {
@@ -81,6 +222,7 @@ public:
         }
     }
 
+public:
     // // Only accept InputType with exactly matching reference type.
     // template <typename T,
     //           typename = std::enable_if_t<input_processing_mode == ProcessingMode::Batch>>
@@ -103,23 +245,28 @@ public:
     }
 
     template <typename Container,
-              typename = std::enable_if_t<StageFactory::input_processing_mode ==
-                                              ProcessingMode::Incremental &&
+              typename = std::enable_if_t<is_streaming(StageFactory::input_processing_mode) &&
                                           !std::is_same_v<Container, InputType>>>
     decltype(auto) process_batch(Container&& container)
     {
-        constexpr bool has_process_incremental = requires
-        {
-            m_stage.process_incremental(std::declval<InputType>(), next());
-        };
+        if constexpr (std::ranges::sized_range<Container>) reserve(std::ranges::size(container));
 
-        static_assert(
-            has_process_incremental,
-            "Stage with incremental processing mode does not implement process_incremental.");
+        // Contiguous containers are handed over by chunks without copy.
+        if constexpr (std::ranges::contiguous_range<Container> &&
+                      std::ranges::sized_range<Container> &&
+                      std::is_same_v<std::ranges::range_reference_t<Container>, InputType>) {
+            std::span<Element> values{std::ranges::data(container), std::ranges::size(container)};
 
-        for (InputType input : std::forward<Container>(container)) {
-            if (any_done()) break;
-            m_stage.process_incremental(static_cast<InputType>(input), next());
+            for (size_t offset = 0; offset < values.size(); offset += chunk_size) {
+                if (any_done()) break;
+                process_chunk(values.subspan(offset, std::min(chunk_size, values.size() - offset)));
+            }
+        }
+        else {
+            for (InputType input : std::forward<Container>(container)) {
+                if (any_done()) break;
+                process_incremental(static_cast<InputType>(input));
+            }
         }
         return flush();
     }
@@ -2,8 +2,56 @@
 
 #include <ez/Utils.hpp>
 
+#include <type_traits>
+
 namespace ez::rpl {
 
-enum class ProcessingMode { Incremental, Batch };
+/// Incremental stages receive the elements one by one, chunked stages receive them by spans of
+/// at most `chunk_size` elements and batch stages receive the whole input at once.
+enum class ProcessingMode { Incremental, Chunked, Batch };
+
+/// Maximum number of elements handed from one stage to the next at once in chunked mode.
+inline constexpr size_t chunk_size = 256;
+
+/// Incremental and chunked stages both consume a stream of elements.
+constexpr bool is_streaming(ProcessingMode mode) { return mode != ProcessingMode::Batch; }
+
+namespace internal {
+
+/// Stages emitting several elements from flush_to stop once the downstream stages are done.
+constexpr bool is_done(const auto& next)
+{
+    if constexpr (requires { next.any_done(); }) { return next.any_done(); }
+    else {
+        return false;
+    }
+}
+
+/// Whether a stage from `next` on may stop accepting elements (take, find...). A chunk is then
+/// not transformed or filtered ahead of it, the work on the elements past the end would be lost.
+template <typename Next>
+consteval bool can_short_circuit()
+{
+    using T = std::remove_cvref_t<Next>;
+    if constexpr (requires { T::any_can_short_circuit(); }) { return T::any_can_short_circuit(); }
+    else {
+        return requires(const T& next) { next.any_done(); };
+    }
+}
+
+/// Whether the stage `next` processes a chunk at once. Otherwise a chunk is not transformed or
+/// filtered ahead of it: each element reaches `next` before the following one is processed, the
+/// side effects of the stages keep the order of the element by element path.
+template <typename Next>
+consteval bool consumes_chunks()
+{
+    using T = std::remove_cvref_t<Next>;
+    if constexpr (requires { T::consumes_chunks(); }) { return T::consumes_chunks(); }
+    else {
+        return false;
+    }
+}
+
+}  // namespace internal
 
 }  // namespace ez::rpl
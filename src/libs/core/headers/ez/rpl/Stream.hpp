@@ -0,0 +1,287 @@
+#pragma once
+
+#include <ez/rpl/Pipeline.hpp>
+
+#include <ez/async/Task.hpp>
+#include <ez/async/internal/WaiterList.hpp>
+
+#include <ez/Contract.hpp>
+#include <ez/Option.hpp>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace ez::rpl {
+
+/// Pipeline driven by pushing the elements one by one, for inputs that are not available as a
+/// range (sockets, channels, callbacks...). The stages keep their state between pushes, the
+/// result is produced by `finish`, or by `checkpoint` without ending the stream.
+/// Usage:
+/// @code
+/// auto stream = rpl::make_stream<Event>(rpl::filter(is_error), rpl::group_by(&Event::host));
+/// stream.push(event);
+/// auto errors_per_host = std::move(stream).finish();
+/// @endcode
+template <typename T, typename... StageFactories>
+class Stream {
+public:
+    using PipelineType = Pipeline<ProcessingMode::Incremental, T&&, StageFactories...>;
+    using Output = std::remove_cvref_t<decltype(std::declval<PipelineType&>().first().flush())>;
+
+    explicit Stream(auto&&... factories) : m_pipeline{std::in_place, EZ_FWD(factories)...} {}
+
+    decltype(auto) first() { return m_pipeline.first(); }
+
+    /// True once a stage (take...) does not accept more elements.
+    bool done() const { return m_pipeline.stages.get(Index<0>{}).any_done(); }
+
+    /// Size hint for the collecting stages, when the number of elements to push is known.
+    void reserve(size_t count) { first().reserve(count); }
+
+    void push(T value)
+    {
+        if (!done()) first().process_incremental(std::move(value));
+    }
+
+    void push(std::span<T> values)
+    {
+        if (!done()) first().process_chunk(values);
+    }
+
+    /// Result of the elements pushed so far, the stream can still receive elements. The reducing
+    /// stages (count, accumulate, group_by, to_vector...) copy their current aggregate, the other
+    /// stages keep their state untouched.
+    Output checkpoint() { return m_pipeline.first().snapshot(); }
+
+    Output finish() && { return m_pipeline.first().flush(); }
+
+private:
+    PipelineType m_pipeline;
+};
+
+template <typename T, typename... StageFactories>
+auto make_stream(StageFactories&&... factories)
+{
+    return Stream<T, std::remove_cvref_t<StageFactories>...>{
+        std::forward<StageFactories>(factories)...};
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/// Bounded buffer between producers and the task consuming a stream. Producers awaiting `push`
+/// are suspended while the buffer is full, which propagates backpressure to their own input
+/// (socket reads...). Suspended coroutines are resumed on the thread unblocking them.
+/// A single consumer awaits `pop` at a time. An awaiter destroyed while suspended (a `when_any`
+/// loser, a destroyed task) withdraws, a value already handed to it goes to the next pop.
+template <typename T>
+class LiveSource {
+public:
+    explicit LiveSource(size_t capacity) : m_capacity{std::max<size_t>(capacity, 1)} {}
+
+    LiveSource(const LiveSource&) = delete;
+    LiveSource& operator=(const LiveSource&) = delete;
+
+    size_t capacity() const { return m_capacity; }
+
+    /// Awaitable returning false when the source is closed, the value is dropped in that case.
+    auto push(T value) { return PushAwaiter{{}, this, std::move(value)}; }
+
+    /// Awaitable returning the next value, or nothing once the source is closed and drained.
+    auto pop() { return PopAwaiter{{}, this}; }
+
+    /// Wakes up the consumer and the producers, values already buffered can still be popped.
+    void close()
+    {
+        std::vector<std::shared_ptr<async::internal::WakeUp>> wake_ups;
+        {
+            std::lock_guard lock{m_mutex};
+            m_closed = true;
+            if (PopAwaiter* consumer = m_consumers.pop_front()) {
+                consumer->waiting = false;
+                wake_ups.push_back(consumer->wake_up);
+            }
+            while (PushAwaiter* producer = m_producers.pop_front()) {
+                producer->waiting = false;
+                wake_ups.push_back(producer->wake_up);
+            }
+        }
+
+        // Resuming one of them may destroy the others, the awaiters are not touched anymore.
+        for (auto& wake_up : wake_ups) wake_up->resume_if_unclaimed();
+    }
+
+private:
+    // Same protocol as the waiters of `async::Channel`: the thread resuming a queued awaiter and
+    // the awaiter destroyed before its resumption race to claim its `wake_up`.
+    template <typename Self>
+    struct Waiter {
+        Self* prev = nullptr;
+        Self* next = nullptr;
+        std::shared_ptr<async::internal::WakeUp> wake_up;
+        bool waiting = false;  // Guarded by the mutex of the source.
+    };
+
+    struct PushAwaiter : Waiter<PushAwaiter> {
+        LiveSource* source;
+        T value;
+        bool accepted = false;
+
+        ~PushAwaiter() { source->withdraw(source->m_producers, *this); }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(async::CoHandle<> coroutine)
+        {
+            std::unique_lock lock{source->m_mutex};
+            if (source->m_closed) return false;
+
+            accepted = true;
+            if (source->hand_over(value, lock)) return false;
+            if (source->m_buffer.size() < source->m_capacity) {
+                source->m_buffer.push_back(std::move(value));
+                return false;
+            }
+
+            accepted = false;
+            enqueue(source->m_producers, *this, coroutine);
+            return true;
+        }
+
+        bool await_resume() const noexcept { return accepted; }
+    };
+
+    struct PopAwaiter : Waiter<PopAwaiter> {
+        LiveSource* source;
+        Option<T> value;
+
+        ~PopAwaiter() { source->withdraw(source->m_consumers, *this); }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(async::CoHandle<> coroutine)
+        {
+            std::unique_lock lock{source->m_mutex};
+            if (!source->m_buffer.empty()) {
+                value = std::move(source->m_buffer.front());
+                source->m_buffer.pop_front();
+
+                // A slot was freed, the first waiting producer fills it.
+                PushAwaiter* producer = source->m_producers.pop_front();
+                if (producer == nullptr) return false;
+                source->m_buffer.push_back(std::move(producer->value));
+                producer->accepted = true;
+                producer->waiting = false;
+                std::shared_ptr<async::internal::WakeUp> wake_up = producer->wake_up;
+                lock.unlock();
+                wake_up->resume_if_unclaimed();
+                return false;
+            }
+            if (source->m_closed) return false;
+
+            EZ_ASSERT(source->m_consumers.empty());
+            enqueue(source->m_consumers, *this, coroutine);
+            return true;
+        }
+
+        Option<T> await_resume() { return std::move(value); }
+    };
+
+    template <typename Awaiter>
+    static void enqueue(async::internal::WaiterList<Awaiter>& list,
+                        Awaiter& awaiter,
+                        async::CoHandle<> handle)
+    {
+        awaiter.wake_up = std::make_shared<async::internal::WakeUp>(handle);
+        awaiter.waiting = true;
+        list.push_back(&awaiter);
+    }
+
+    // A pop handed a value but destroyed before its resumption gives it to the next pop, a push
+    // already delivered its value.
+    template <typename Awaiter>
+    void withdraw(async::internal::WaiterList<Awaiter>& list, Awaiter& awaiter)
+    {
+        if (!awaiter.wake_up) return;
+
+        {
+            std::lock_guard lock{m_mutex};
+            if (awaiter.waiting) {
+                list.remove(&awaiter);
+                return;
+            }
+        }
+        if (!awaiter.wake_up->claim()) return;
+
+        if constexpr (std::is_same_v<Awaiter, PopAwaiter>) {
+            if (awaiter.value) give_back(*awaiter.value);
+        }
+    }
+
+    void give_back(T& value)
+    {
+        std::unique_lock lock{m_mutex};
+        if (!hand_over(value, lock)) m_buffer.push_front(std::move(value));
+    }
+
+    // Hands `value` to the suspended consumer, resumed once unlocked.
+    bool hand_over(T& value, std::unique_lock<std::mutex>& lock)
+    {
+        PopAwaiter* consumer = m_consumers.pop_front();
+        if (consumer == nullptr) return false;
+
+        consumer->value = std::move(value);
+        consumer->waiting = false;
+        std::shared_ptr<async::internal::WakeUp> wake_up = consumer->wake_up;
+        lock.unlock();
+        wake_up->resume_if_unclaimed();
+        return true;
+    }
+
+    size_t m_capacity = 1;
+    std::mutex m_mutex;
+    std::deque<T> m_buffer;
+    async::internal::WaiterList<PushAwaiter> m_producers;
+    async::internal::WaiterList<PopAwaiter> m_consumers;
+    bool m_closed = false;
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Pushes the values of `source` to `stream` until the source is closed or the stream is done,
+/// in which case the source is closed, and returns the final result. When `checkpoint_every`
+/// is not zero, `on_checkpoint` receives the intermediate result every `checkpoint_every`
+/// elements.
+/// Usage:
+/// @code
+/// LiveSource<ByteArray> messages{64};
+/// scope << receive_messages(socket, messages);  // co_await messages.push(...), then close()
+///
+/// auto stream = rpl::make_stream<ByteArray>(rpl::transform(parse), rpl::group_by(&Event::host));
+/// auto result = co_await rpl::consume(messages, stream, 1000, [](const auto& partial) {});
+/// @endcode
+template <typename T, typename... StageFactories, typename OnCheckpoint = Noop>
+async::Task<typename Stream<T, StageFactories...>::Output> consume(
+    LiveSource<T>& source,
+    Stream<T, StageFactories...>& stream,
+    size_t checkpoint_every = 0,
+    OnCheckpoint on_checkpoint = {})
+{
+    size_t count = 0;
+    while (!stream.done()) {
+        Option<T> value = co_await source.pop();
+        if (!value) break;
+
+        stream.push(std::move(*value));
+        if (checkpoint_every != 0 && ++count % checkpoint_every == 0) {
+            std::invoke(on_checkpoint, stream.checkpoint());
+        }
+    }
+    if (stream.done()) source.close();
+    co_return std::move(stream).finish();
+}
+
+}  // namespace ez::rpl
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <ez/rpl/StageBase.hpp>
+
+#include <ez/Utils.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+/// Chunk kernels used when a pipeline processes contiguous arithmetic values.
+/// The loops work on fixed size lanes so that the compiler can keep the lanes in vector
+/// registers (auto vectorization) without depending on a SIMD library.
+namespace ez::rpl::internal::simd {
+
+/// Number of independent accumulators, one 512 bits register worth of values.
+template <typename T>
+inline constexpr size_t lanes = std::max<size_t>(64 / sizeof(T), 1);
+
+template <typename T>
+concept Arithmetic = std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+/// Arithmetic input that may be handed over as copies: taken by value or by const reference.
+/// Through a mutable reference, the next stages must see the source elements.
+template <typename T>
+concept CopyableArithmetic =
+    Arithmetic<T> &&
+    !(std::is_lvalue_reference_v<T> && !std::is_const_v<std::remove_reference_t<T>>);
+
+/// Lane-wise summation gives the same result as `init = init + value` in sequence for unsigned
+/// integers, which wrap around. Floating point sums are reassociated and signed lanes may
+/// overflow where the sequential sum does not: only when `reassociate` is set.
+template <typename Init, typename Value, bool reassociate>
+concept LaneSummable = Arithmetic<Init> && Arithmetic<Value> && !std::is_same_v<Init, bool> &&
+                       !std::is_same_v<std::remove_cvref_t<Value>, bool> &&
+                       (std::is_floating_point_v<Init>
+                            ? reassociate
+                            : (std::is_integral_v<std::remove_cvref_t<Value>> &&
+                               sizeof(Init) >= sizeof(std::remove_cvref_t<Value>) &&
+                               (std::is_unsigned_v<Init> || reassociate)));
+
+/// Calls `f` on consecutive sub spans of at most `chunk_size` elements.
+template <typename T>
+void for_each_chunk(std::span<T> values, auto&& f)
+{
+    for (size_t offset = 0; offset < values.size(); offset += chunk_size) {
+        f(values.subspan(offset, std::min(chunk_size, values.size() - offset)));
+    }
+}
+
+template <typename R, typename T>
+R sum(std::span<T> values, R init)
+{
+    constexpr size_t width = lanes<R>;
+
+    std::array<R, width> accumulators{};
+    const size_t vectorized_size = values.size() - values.size() % width;
+
+    for (size_t i = 0; i < vectorized_size; i += width) {
+        for (size_t lane = 0; lane < width; ++lane) { accumulators[lane] += R(values[i + lane]); }
+    }
+
+    for (size_t i = vectorized_size; i < values.size(); ++i) { init += R(values[i]); }
+    for (R accumulator : accumulators) { init += accumulator; }
+    return init;
+}
+
+/// Returns the element `e` for which `compare(e, other)` holds against all the others.
+/// `values` must not be empty.
+template <typename T, typename Compare>
+std::remove_cv_t<T> select(std::span<T> values, Compare compare)
+{
+    using V = std::remove_cv_t<T>;
+    constexpr size_t width = lanes<V>;
+
+    V result = values.front();
+
+    if (values.size() >= width) {
+        std::array<V, width> selected;
+        std::copy_n(values.begin(), width, selected.begin());
+
+        const size_t vectorized_size = values.size() - values.size() % width;
+        for (size_t i = width; i < vectorized_size; i += width) {
+            for (size_t lane = 0; lane < width; ++lane) {
+                selected[lane] =
+                    compare(values[i + lane], selected[lane]) ? values[i + lane] : selected[lane];
+            }
+        }
+
+        result = selected.front();
+        for (V value : selected) { result = compare(value, result) ? value : result; }
+
+        values = values.subspan(vectorized_size);
+    }
+
+    for (V value : values) { result = compare(value, result) ? value : result; }
+    return result;
+}
+
+/// Branchless compaction: copies the values matching the predicate to `out` and returns their
+/// count. `out` must be able to hold `values.size()` elements.
+template <typename T, typename Predicate>
+size_t compact(std::span<T> values, Predicate& predicate, std::remove_cv_t<T>* out)
+{
+    size_t count = 0;
+    for (const auto& value : values) {
+        out[count] = value;
+        count += static_cast<bool>(std::invoke(predicate, std::as_const(value)));
+    }
+    return count;
+}
+
+}  // namespace ez::rpl::internal::simd
@@ -1,26 +1,113 @@
 #pragma once
 
 #include <ez/rpl/StageFactory.hpp>
+#include <ez/rpl/internal/Simd.hpp>
 
 #include <ez/Option.hpp>
 
+#include <functional>
+#include <span>
+#include <type_traits>
+
 namespace ez::rpl {
 
-template <typename InputType, typename Init, typename BinaryOp>
+// Combiner of an accumulate given none: its partial results cannot be merged.
+struct NoCombine {
+};
+
+// Identity of an accumulate given none: only a plain sum may start a partial result from `Init{}`.
+struct NoIdentity {
+};
+
+/// Addition which may be reassociated: contiguous floating point or signed values are summed on
+/// independent lane accumulators, which round differently and may overflow where the sum in
+/// sequence does not.
+struct UnorderedPlus : std::plus<> {
+};
+
+template <typename InputType,
+          typename Init,
+          typename BinaryOp,
+          typename Combine = NoCombine,
+          typename Identity = NoIdentity>
 struct Accumulate {
     using OutputType = Init&&;
 
+    static constexpr bool is_unordered_sum = std::is_same_v<BinaryOp, UnorderedPlus>;
+    static constexpr bool is_sum = std::is_same_v<BinaryOp, std::plus<>> ||
+                                   std::is_same_v<BinaryOp, std::plus<Init>> || is_unordered_sum;
+    static constexpr bool has_combine = !std::is_same_v<Combine, NoCombine>;
+    static constexpr bool has_identity = !std::is_same_v<Identity, NoIdentity>;
+
     Init init;
     BinaryOp binary_op;
+    Combine combine_op;
+    [[no_unique_address]] Identity identity;
 
     void process_incremental(InputType input, auto&&)
     {
         init = binary_op(std::move(init), static_cast<InputType>(input));
     }
 
+    // Plain sums use independent lane accumulators when the result is the same as in sequence,
+    // or when the caller allows reassociation with UnorderedPlus.
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&&)
+        requires internal::simd::LaneSummable<Init, InputType, is_unordered_sum> && is_sum
+    {
+        init = internal::simd::sum(chunk, std::move(init));
+    }
+
     decltype(auto) flush_to(auto&& next) { return next.process_batch(std::move(init)); }
+    decltype(auto) snapshot_to(auto&& next) { return next.process_batch(Init(init)); }
+
+    // Under `rpl::par` only the first chunk folds from `init`, the others from the identity of
+    // the combiner: `init` is counted once in the merged result.
+    void begin_partial()
+        requires(has_identity || (is_sum && !has_combine))
+    {
+        if constexpr (has_identity) { init = identity; }
+        else {
+            init = Init{};
+        }
+    }
+
+    // Merges the partial results of `rpl::par`. A fold like `acc * 10 + x` or `acc + 1` is not
+    // a merge of two partial results: only a plain sum can use its own operation.
+    Init combine(Init&& lhs, Init&& rhs)
+    {
+        static_assert(is_sum || has_combine,
+                      "rpl::accumulate needs a combiner to run in parallel: "
+                      "accumulate(init, op, combine, identity)");
+        static_assert(has_identity || (is_sum && !has_combine),
+                      "rpl::accumulate needs the identity of its combiner to run in parallel: "
+                      "accumulate(init, op, combine, identity)");
+
+        if constexpr (!has_combine) {
+            return binary_op(std::move(lhs), std::move(rhs));
+        }
+        else {
+            return combine_op(std::move(lhs), std::move(rhs));
+        }
+    }
 };
 
+/// Folds the elements into `init` with `binary_op(acc, element)`.
+/// Under `rpl::par` each chunk is folded separately and the partial results are merged with
+/// `combine(lhs, rhs)`. The chunks after the first fold from `identity`, the value leaving any
+/// partial result unchanged through `combine`. Both may be omitted for plain sums only, which
+/// use `Init{}`.
+/// Floating point and signed sums are computed in sequence, `rpl::UnorderedPlus` lets them run
+/// on independent lanes.
+/// Usage:
+/// @code
+/// auto total = rpl::run(prices, rpl::accumulate(0.0));
+/// auto faster = rpl::run(prices, rpl::accumulate(0.0, rpl::UnorderedPlus{}));
+/// auto count = rpl::run(rpl::par(pool), values, rpl::accumulate(0, [](int acc, auto&&) {
+///     return acc + 1;
+/// }, std::plus<>{}, 0));
+/// auto product = rpl::run(rpl::par(pool), values,
+///                         rpl::accumulate(1, std::multiplies<>{}, std::multiplies<>{}, 1));
+/// @endcode
 template <typename Init, typename BinaryOp = std::plus<>>
 inline auto accumulate(Init&& init = {}, BinaryOp&& binary_op = {})
 {
@@ -28,4 +115,29 @@ inline auto accumulate(Init&& init = {}, BinaryOp&& binary_op = {})
                         BinaryOp>(std::forward<Init>(init), std::forward<BinaryOp>(binary_op));
 }
 
+template <typename Init, typename BinaryOp, typename Combine>
+inline auto accumulate(Init&& init, BinaryOp&& binary_op, Combine&& combine)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, Accumulate, Init,
+                        BinaryOp, Combine>(std::forward<Init>(init),
+                                           std::forward<BinaryOp>(binary_op),
+                                           std::forward<Combine>(combine));
+}
+
+template <typename Init, typename BinaryOp, typename Combine, typename Identity>
+inline auto accumulate(Init&& init, BinaryOp&& binary_op, Combine&& combine, Identity&& identity)
+{
+    using InitType = std::remove_cvref_t<Init>;
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, Accumulate, Init,
+                        BinaryOp, Combine, InitType>(
+        std::forward<Init>(init), std::forward<BinaryOp>(binary_op),
+        std::forward<Combine>(combine), InitType(std::forward<Identity>(identity)));
+}
+
+template <typename T>
+inline auto sum()
+{
+    return accumulate<T>();
+}
+
 }  // namespace ez::rpl
@@ -1,8 +1,14 @@
 #pragma once
 
 #include <ez/rpl/StageFactory.hpp>
+#include <ez/rpl/internal/Simd.hpp>
+
+#include <ez/FlatHashMap.hpp>
 
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -10,24 +16,56 @@ namespace ez::rpl {
 
 namespace internal {
 
-template <typename T>
-void append(auto&& value, std::vector<T>& v)
+template <typename T, typename... Ts>
+void append(auto&& value, std::vector<T, Ts...>& v)
 {
     v.push_back(EZ_FWD(value));
 }
 
-template <typename K, typename V>
-void append(auto&& pair, std::map<K, V>& map)
+template <typename K, typename V, typename... Ts>
+void append(auto&& pair, std::map<K, V, Ts...>& map)
 {
     map.insert({std::get<0>(EZ_FWD(pair)), std::get<1>(EZ_FWD(pair))});
 }
 
-template <typename K, typename V>
-void append(auto&& pair, std::unordered_map<K, V>& map)
+template <typename K, typename V, typename... Ts>
+void append(auto&& pair, std::unordered_map<K, V, Ts...>& map)
 {
     map.insert({std::get<0>(EZ_FWD(pair)), std::get<1>(EZ_FWD(pair))});
 }
 
+template <typename K, typename V, typename... Ts>
+void append(auto&& pair, FlatHashMap<K, V, Ts...>& map)
+{
+    map.try_emplace(std::get<0>(EZ_FWD(pair)), std::get<1>(EZ_FWD(pair)));
+}
+
+template <typename T, typename... Ts>
+void merge(std::vector<T, Ts...>& into, std::vector<T, Ts...>&& from)
+{
+    into.insert(into.end(), std::make_move_iterator(from.begin()),
+                std::make_move_iterator(from.end()));
+}
+
+template <typename K, typename V, typename... Ts>
+void merge(std::map<K, V, Ts...>& into, std::map<K, V, Ts...>&& from)
+{
+    into.merge(from);
+}
+
+template <typename K, typename V, typename... Ts>
+void merge(std::unordered_map<K, V, Ts...>& into, std::unordered_map<K, V, Ts...>&& from)
+{
+    into.merge(from);
+}
+
+template <typename K, typename V, typename... Ts>
+void merge(FlatHashMap<K, V, Ts...>& into, FlatHashMap<K, V, Ts...>&& from)
+{
+    into.reserve(into.size() + from.size());
+    for (auto& [key, value] : from) into.try_emplace(std::move(key), std::move(value));
+}
+
 template <typename ValueType, template <typename...> typename Container>
 struct ContainerType {
     using Type = Container<ValueType>;
@@ -43,21 +81,98 @@ struct ContainerType<Tuple<K, V>, Container> {
     using Type = Container<std::remove_cvref_t<K>, std::remove_cvref_t<V>>;
 };
 
+template <typename ValueType>
+struct KeyValueTypes;
+
+template <typename K, typename V>
+struct KeyValueTypes<std::pair<K, V>> {
+    using Key = std::remove_cvref_t<K>;
+    using Value = std::remove_cvref_t<V>;
+};
+
+template <typename K, typename V>
+struct KeyValueTypes<Tuple<K, V>> : KeyValueTypes<std::pair<K, V>> {
+};
+
+template <typename Allocator, typename T>
+using RebindAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+// Containers supporting a custom allocator, the allocator is rebound to their node type.
+template <typename ValueType, template <typename...> typename Container, typename Allocator>
+struct AllocatedContainerType;
+
+template <typename T, typename Allocator>
+struct AllocatedContainerType<T, std::vector, Allocator> {
+    using Type = std::vector<T, RebindAllocator<Allocator, T>>;
+};
+
+template <typename T, typename Allocator>
+struct AllocatedContainerType<T, std::map, Allocator> {
+    using Key = KeyValueTypes<T>::Key;
+    using Value = KeyValueTypes<T>::Value;
+    using Type = std::map<Key, Value, std::less<Key>,
+                          RebindAllocator<Allocator, std::pair<const Key, Value>>>;
+};
+
+template <typename T, typename Allocator>
+struct AllocatedContainerType<T, std::unordered_map, Allocator> {
+    using Key = KeyValueTypes<T>::Key;
+    using Value = KeyValueTypes<T>::Value;
+    using Type = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>,
+                                    RebindAllocator<Allocator, std::pair<const Key, Value>>>;
+};
+
+template <typename T>
+concept Allocator = requires(T& allocator) {
+    typename T::value_type;
+    allocator.allocate(size_t{1});
+};
+
 }  // namespace internal
 
-template <typename InputType, template <typename...> typename Container>
+template <typename InputType, template <typename...> typename Container, typename Allocator = void>
 struct CopyToImpl {
     using ValueType = std::remove_cvref_t<InputType>;
 
-    using ContainerType = internal::ContainerType<ValueType, Container>::Type;
+    using ContainerType = std::conditional_t<
+        std::is_void_v<Allocator>,
+        internal::ContainerType<ValueType, Container>,
+        internal::AllocatedContainerType<ValueType, Container, Allocator>>::Type;
 
     using OutputType = ContainerType&&;
 
     ContainerType result;
 
+    CopyToImpl() = default;
+
+    template <typename A>
+    explicit CopyToImpl(const A& allocator)
+        : result(typename ContainerType::allocator_type(allocator))
+    {
+    }
+
     void process_incremental(InputType input, auto&&) { internal::append(EZ_FWD(input), result); }
 
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&&)
+        requires internal::simd::Arithmetic<InputType> &&
+                 std::is_same_v<typename ContainerType::value_type, ValueType>
+    {
+        result.insert(result.end(), chunk.begin(), chunk.end());
+    }
+
+    void reserve(size_t count, auto&&)
+    {
+        if constexpr (requires { result.reserve(count); }) result.reserve(result.size() + count);
+    }
+
     decltype(auto) flush_to(auto&& next) { return next.process_batch(std::move(result)); }
+    decltype(auto) snapshot_to(auto&& next) { return next.process_batch(ContainerType(result)); }
+
+    ContainerType combine(ContainerType&& lhs, ContainerType&& rhs)
+    {
+        internal::merge(lhs, std::move(rhs));
+        return std::move(lhs);
+    }
 };
 
 template <template <typename...> typename Container>
@@ -66,6 +181,23 @@ struct CopyTo {
     using Stage = CopyToImpl<InputType, Container>;
 };
 
+template <template <typename...> typename Container>
+struct AllocatedCopyTo {
+    template <typename InputType, typename Allocator>
+    using Stage = CopyToImpl<InputType, Container, Allocator>;
+};
+
+/// Collects the elements in a container. The storage is reserved upfront when the input size is
+/// known, from a sized range through the stages emitting one element per input (transform,
+/// enumerate...). The std containers accept an allocator, rebound to their element type, or a
+/// memory resource.
+/// Usage:
+/// @code
+/// std::array<std::byte, 4096> buffer;
+/// std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+/// std::pmr::vector<int> squares =
+///     rpl::run(values, rpl::transform(square), rpl::to_vector(&arena));
+/// @endcode
 template <template <typename...> typename Container>
 auto to()
 {
@@ -73,8 +205,50 @@ auto to()
                         CopyTo<Container>::template Stage>();
 }
 
+template <template <typename...> typename Container, internal::Allocator Allocator>
+auto to(const Allocator& allocator)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch,
+                        AllocatedCopyTo<Container>::template Stage, const Allocator&>(allocator);
+}
+
+template <template <typename...> typename Container>
+auto to(std::pmr::memory_resource* resource)
+{
+    return to<Container>(std::pmr::polymorphic_allocator<>{resource});
+}
+
 inline auto to_vector() { return to<std::vector>(); }
 inline auto to_map() { return to<std::map>(); }
 inline auto to_unordered_map() { return to<std::unordered_map>(); }
 
+/// Collects key value pairs in an open addressing hash map, keeping the first value of each key.
+inline auto to_flat_map() { return to<FlatHashMap>(); }
+
+template <internal::Allocator Allocator>
+auto to_vector(const Allocator& allocator)
+{
+    return to<std::vector>(allocator);
+}
+
+template <internal::Allocator Allocator>
+auto to_map(const Allocator& allocator)
+{
+    return to<std::map>(allocator);
+}
+
+template <internal::Allocator Allocator>
+auto to_unordered_map(const Allocator& allocator)
+{
+    return to<std::unordered_map>(allocator);
+}
+
+inline auto to_vector(std::pmr::memory_resource* resource) { return to<std::vector>(resource); }
+inline auto to_map(std::pmr::memory_resource* resource) { return to<std::map>(resource); }
+
+inline auto to_unordered_map(std::pmr::memory_resource* resource)
+{
+    return to<std::unordered_map>(resource);
+}
+
 }  // namespace ez::rpl
@@ -2,6 +2,8 @@
 
 #include <ez/rpl/StageFactory.hpp>
 
+#include <span>
+
 namespace ez::rpl {
 
 template <typename InputType, typename...>
@@ -12,7 +14,15 @@ struct Count {
 
     decltype(auto) process_incremental(InputType, auto&&) { ++count; }
 
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&&)
+    {
+        count += chunk.size();
+    }
+
     decltype(auto) flush_to(auto&& next) { return next.process_batch(count); }
+    decltype(auto) snapshot_to(auto&& next) { return next.process_batch(size_t{count}); }
+
+    size_t combine(size_t lhs, size_t rhs) const { return lhs + rhs; }
 };
 
 inline auto count()
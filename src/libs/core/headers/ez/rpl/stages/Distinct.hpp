@@ -0,0 +1,137 @@
+#pragma once
+
+#include <ez/rpl/StageFactory.hpp>
+
+#include <ez/FlatHashMap.hpp>
+#include <ez/Sketches.hpp>
+
+#include <functional>
+
+namespace ez::rpl {
+
+namespace internal {
+
+struct StdHash {
+    template <typename T>
+    size_t operator()(const T& value) const
+    {
+        return std::hash<T>{}(value);
+    }
+};
+
+}  // namespace internal
+
+template <typename InputType, typename Hash, typename Equal, typename...>
+struct Distinct {
+    using OutputType = InputType;
+    using ValueType = std::remove_cvref_t<InputType>;
+
+    FlatHashMap<ValueType, Unit, Hash, Equal> seen;
+
+    Distinct(auto&& hash, auto&& equal) : seen{0, EZ_FWD(hash), EZ_FWD(equal)} {}
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        if (seen.try_emplace(std::as_const(input)).second) {
+            next.process_incremental(static_cast<InputType>(input));
+        }
+    }
+};
+
+template <typename InputType, typename Hash, typename...>
+struct DistinctApprox {
+    using OutputType = InputType;
+
+    BloomFilter seen;
+    Hash hash;
+
+    DistinctApprox(auto&& h, size_t expected_count, double false_positive_rate)
+        : seen{expected_count, false_positive_rate}, hash{EZ_FWD(h)}
+    {
+    }
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        if (seen.insert(u64(std::invoke(hash, std::as_const(input))))) {
+            next.process_incremental(static_cast<InputType>(input));
+        }
+    }
+};
+
+template <typename InputType, typename Hash, typename Equal, typename...>
+struct CountDistinct {
+    using OutputType = size_t&&;
+    using ValueType = std::remove_cvref_t<InputType>;
+
+    FlatHashMap<ValueType, Unit, Hash, Equal> seen;
+
+    CountDistinct(auto&& hash, auto&& equal) : seen{0, EZ_FWD(hash), EZ_FWD(equal)} {}
+
+    void process_incremental(InputType input, auto&&) { seen.try_emplace(std::as_const(input)); }
+
+    decltype(auto) flush_to(auto&& next) { return next.process_batch(seen.size()); }
+    decltype(auto) snapshot_to(auto&& next) { return next.process_batch(seen.size()); }
+};
+
+template <typename InputType, typename Hash, typename...>
+struct CountDistinctApprox {
+    using OutputType = size_t&&;
+
+    HyperLogLog sketch;
+    Hash hash;
+
+    CountDistinctApprox(auto&& h, size_t precision) : sketch{precision}, hash{EZ_FWD(h)} {}
+
+    void process_incremental(InputType input, auto&&)
+    {
+        sketch.add(u64(std::invoke(hash, std::as_const(input))));
+    }
+
+    decltype(auto) flush_to(auto&& next) { return next.process_batch(sketch.estimate()); }
+    decltype(auto) snapshot_to(auto&& next) { return next.process_batch(sketch.estimate()); }
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Forwards the first occurrence of each element, in any order. The elements seen are copied
+/// in an open addressing set, the memory grows with the number of distinct elements.
+/// Usage:
+/// @code
+/// rpl::run(events, rpl::transform(&Event::user), rpl::distinct(), rpl::to_vector());
+/// @endcode
+template <typename Hash = internal::StdHash, typename Equal = std::equal_to<>>
+auto distinct(Hash&& hash = {}, Equal&& equal = {})
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, Distinct, Hash,
+                        Equal>(std::forward<Hash>(hash), std::forward<Equal>(equal));
+}
+
+/// Approximate distinct with a memory bounded by a bloom filter sized for `expected_count`
+/// elements. There are no duplicates in the output, but a fraction `false_positive_rate` of the
+/// distinct elements is dropped as well.
+template <typename Hash = internal::StdHash>
+auto distinct_approx(size_t expected_count, double false_positive_rate = 0.01, Hash&& hash = {})
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, DistinctApprox,
+                        Hash, size_t, double>(std::forward<Hash>(hash), size_t{expected_count},
+                                              double{false_positive_rate});
+}
+
+/// Number of distinct elements.
+template <typename Hash = internal::StdHash, typename Equal = std::equal_to<>>
+auto count_distinct(Hash&& hash = {}, Equal&& equal = {})
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, CountDistinct, Hash,
+                        Equal>(std::forward<Hash>(hash), std::forward<Equal>(equal));
+}
+
+/// Estimation of the number of distinct elements with a HyperLogLog sketch of `2^precision`
+/// bytes, whatever the cardinality. See HyperLogLog for the accuracy.
+template <typename Hash = internal::StdHash>
+auto count_distinct_approx(size_t precision = 12, Hash&& hash = {})
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, CountDistinctApprox,
+                        Hash, size_t>(std::forward<Hash>(hash), size_t{precision});
+}
+
+}  // namespace ez::rpl
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <ez/rpl/StageFactory.hpp>
+
+#include <ez/Option.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#if !defined(_MSC_VER)
+#include <sys/types.h>
+#endif
+
+namespace ez::rpl {
+
+namespace internal {
+
+/// Anonymous temporary file holding sorted runs one after the other, removed when closed.
+template <typename T>
+class RunFile {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Spilled values must be trivially copyable.");
+
+    RunFile() : m_file{std::tmpfile()}
+    {
+        if (!m_file) throw std::system_error{errno, std::generic_category(), "tmpfile"};
+    }
+
+    /// Number of values in the file.
+    size_t size() const { return m_size; }
+
+    void append(std::span<const T> values)
+    {
+        seek(0, SEEK_END);
+        if (std::fwrite(values.data(), sizeof(T), values.size(), m_file.get()) != values.size())
+            throw std::system_error{errno, std::generic_category(), "fwrite"};
+        m_size += values.size();
+    }
+
+    void read(size_t offset, std::span<T> values)
+    {
+        seek(offset, SEEK_SET);
+        if (std::fread(values.data(), sizeof(T), values.size(), m_file.get()) != values.size())
+            throw std::system_error{errno, std::generic_category(), "fread"};
+    }
+
+private:
+    // 64 bits offsets: `long` is 32 bits on Windows.
+    void seek(size_t offset, int origin)
+    {
+#if defined(_MSC_VER)
+        const int result = _fseeki64(m_file.get(), __int64(offset * sizeof(T)), origin);
+#else
+        const int result = fseeko(m_file.get(), off_t(offset * sizeof(T)), origin);
+#endif
+        if (result != 0) throw std::system_error{errno, std::generic_category(), "fseek"};
+    }
+
+    struct Close {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+
+    std::unique_ptr<std::FILE, Close> m_file;
+    size_t m_size = 0;
+};
+
+struct Run {
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+/// Buffered cursor over a sorted run of a file.
+template <typename T>
+class RunReader {
+public:
+    RunReader(RunFile<T>& file, Run run, size_t buffer_size) : m_file{&file}, m_run{run}
+    {
+        m_buffer.resize(std::clamp<size_t>(buffer_size, 1, std::max<size_t>(run.size, 1)));
+        refill();
+    }
+
+    bool exhausted() const { return m_position == m_size; }
+    T& current() { return m_buffer[m_position]; }
+
+    void advance()
+    {
+        if (++m_position == m_size) refill();
+    }
+
+private:
+    void refill()
+    {
+        m_position = 0;
+        m_size = std::min(m_buffer.size(), m_run.size);
+        if (m_size != 0) m_file->read(m_run.offset, std::span{m_buffer}.first(m_size));
+        m_run.offset += m_size;
+        m_run.size -= m_size;
+    }
+
+    RunFile<T>* m_file;
+    Run m_run;
+    std::vector<T> m_buffer;
+    size_t m_position = 0;
+    size_t m_size = 0;
+};
+
+/// K-way merge of sorted runs, `output` is called with the values in order until it returns
+/// false.
+template <typename T>
+void merge_runs(RunFile<T>& file,
+                std::span<const Run> runs,
+                size_t buffer_size,
+                auto& less,
+                auto&& output)
+{
+    std::vector<RunReader<T>> readers;
+    readers.reserve(runs.size());
+    for (const Run& run : runs) {
+        if (run.size != 0) readers.emplace_back(file, run, buffer_size);
+    }
+
+    auto greater = [&](size_t lhs, size_t rhs) {
+        return less(readers[rhs].current(), readers[lhs].current());
+    };
+
+    std::vector<size_t> heap(readers.size());
+    std::iota(heap.begin(), heap.end(), size_t{0});
+    std::make_heap(heap.begin(), heap.end(), greater);
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        RunReader<T>& reader = readers[heap.back()];
+
+        if (!output(std::move(reader.current()))) return;
+
+        reader.advance();
+        if (reader.exhausted()) { heap.pop_back(); }
+        else {
+            std::push_heap(heap.begin(), heap.end(), greater);
+        }
+    }
+}
+
+}  // namespace internal
+
+template <typename InputType, typename Less, typename...>
+struct ExternalSort {
+    using ValueType = std::remove_cvref_t<InputType>;
+    using OutputType = ValueType&&;
+
+    // Runs merged at once: more runs are merged in several passes. The fan-in is also bounded
+    // so that each read buffer holds at least `min_read_bytes`.
+    static constexpr size_t max_fan_in = 64;
+    static constexpr size_t min_read_bytes = 4096;
+
+    Less less;
+    size_t run_capacity = 1;
+
+    std::vector<ValueType> buffer;
+    Option<internal::RunFile<ValueType>> file;
+    std::vector<internal::Run> runs;
+
+    ExternalSort(auto&& l, size_t budget)
+        : less{EZ_FWD(l)}, run_capacity{std::max<size_t>(budget / sizeof(ValueType), 1)}
+    {
+    }
+
+    void process_incremental(InputType input, auto&&)
+    {
+        if (buffer.empty()) buffer.reserve(run_capacity);
+        buffer.push_back(static_cast<InputType>(input));
+        if (buffer.size() == run_capacity) spill();
+    }
+
+    decltype(auto) flush_to(auto&& next)
+    {
+        if (runs.empty()) {
+            std::sort(buffer.begin(), buffer.end(), less);
+            for (ValueType& value : buffer) {
+                if (internal::is_done(next)) break;
+                next.process_incremental(std::move(value));
+            }
+            buffer.clear();
+        }
+        else {
+            merge_to(next);
+        }
+        return next.flush();
+    }
+
+private:
+    // The runs are appended to a single file, whatever their number.
+    void spill()
+    {
+        std::sort(buffer.begin(), buffer.end(), less);
+        if (!file) file.emplace();
+        runs.push_back({file->size(), buffer.size()});
+        file->append(buffer);
+        buffer.clear();
+    }
+
+    void merge_to(auto& next)
+    {
+        // The remainder is spilled too and its memory released: the read buffers get the whole
+        // budget.
+        if (!buffer.empty()) spill();
+        std::vector<ValueType>{}.swap(buffer);
+
+        const size_t min_read_size = std::max<size_t>(min_read_bytes / sizeof(ValueType), 1);
+        const size_t fan_in = std::clamp<size_t>(run_capacity / min_read_size, 2, max_fan_in);
+
+        // One more buffer for the output of the intermediate passes.
+        const size_t buffer_size = std::max<size_t>(run_capacity / (fan_in + 1), 1);
+
+        while (runs.size() > fan_in) merge_pass(fan_in, buffer_size);
+
+        if (!internal::is_done(next)) {
+            internal::merge_runs(*file, std::span{runs}, buffer_size, less, [&](ValueType&& value) {
+                next.process_incremental(std::move(value));
+                return !internal::is_done(next);
+            });
+        }
+        runs.clear();
+        file.reset();
+    }
+
+    // Merges the runs by groups of `fan_in` into the runs of a new file.
+    void merge_pass(size_t fan_in, size_t buffer_size)
+    {
+        internal::RunFile<ValueType> merged;
+        std::vector<internal::Run> merged_runs;
+        std::vector<ValueType> output;
+        output.reserve(buffer_size);
+
+        for (size_t first = 0; first < runs.size(); first += fan_in) {
+            const size_t offset = merged.size();
+            const auto group =
+                std::span{runs}.subspan(first, std::min(fan_in, runs.size() - first));
+
+            internal::merge_runs(*file, group, buffer_size, less, [&](ValueType&& value) {
+                output.push_back(std::move(value));
+                if (output.size() == buffer_size) {
+                    merged.append(output);
+                    output.clear();
+                }
+                return true;
+            });
+            merged.append(output);
+            output.clear();
+            merged_runs.push_back({offset, merged.size() - offset});
+        }
+
+        file.emplace(std::move(merged));
+        runs = std::move(merged_runs);
+    }
+};
+
+/// Sorts streams larger than memory. Runs of `memory_budget` bytes are sorted in memory and
+/// spilled to an anonymous temporary file, then merged while streaming to the next stage, in
+/// several passes when there are many runs. The merge buffers stay within the budget.
+/// Values must be trivially copyable.
+/// Usage:
+/// @code
+/// rpl::run(records, rpl::external_sort(by_timestamp, 256 * 1024 * 1024), rpl::take(100),
+///          rpl::to_vector());
+/// @endcode
+template <typename Less = std::less<>>
+auto external_sort(Less&& less = {}, size_t memory_budget = 64 * 1024 * 1024)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, ExternalSort,
+                        Less, size_t>(std::forward<Less>(less), size_t{memory_budget});
+}
+
+}  // namespace ez::rpl
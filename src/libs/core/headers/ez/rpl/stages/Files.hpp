@@ -0,0 +1,266 @@
+#pragma once
+
+#include <ez/MappedFile.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ez::rpl {
+
+namespace internal {
+
+// Copies of a file source share the mapping, the views they yield stay valid as long as one of
+// them is alive.
+using SharedMappedFile = std::shared_ptr<const MappedFile>;
+
+inline SharedMappedFile map_file(const std::filesystem::path& path)
+{
+    return std::make_shared<const MappedFile>(path, MappedFile::Access::Sequential);
+}
+
+}  // namespace internal
+
+///////////////////////////////////////////////////////////////////////
+
+/// Range of the lines of a memory mapped file, without the line terminators.
+class Lines {
+public:
+    class Iterator {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        explicit Iterator(std::string_view content) : m_remaining{content} { next(); }
+
+        std::string_view operator*() const { return m_line; }
+
+        Iterator& operator++()
+        {
+            next();
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator result = *this;
+            next();
+            return result;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return m_at_end == other.m_at_end && m_remaining.data() == other.m_remaining.data();
+        }
+        bool operator==(std::default_sentinel_t) const { return m_at_end; }
+
+    private:
+        void next()
+        {
+            if (m_remaining.empty()) {
+                m_at_end = true;
+                return;
+            }
+
+            const auto* end = static_cast<const char*>(
+                std::memchr(m_remaining.data(), '\n', m_remaining.size()));
+            const size_t length = end ? size_t(end - m_remaining.data()) : m_remaining.size();
+
+            m_line = m_remaining.substr(0, length);
+            m_remaining.remove_prefix(std::min(length + 1, m_remaining.size()));
+            if (m_line.ends_with('\r')) m_line.remove_suffix(1);
+        }
+
+        std::string_view m_remaining;
+        std::string_view m_line;
+        bool m_at_end = false;
+    };
+
+    explicit Lines(internal::SharedMappedFile file) : m_file{std::move(file)} {}
+
+    Iterator begin() const { return Iterator{m_file->view()}; }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    internal::SharedMappedFile m_file;
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Contiguous range of fixed size records read in place from a memory mapped file.
+/// Trailing bytes that do not form a complete record are ignored.
+template <typename T>
+class MappedRecords {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Mapped records must be trivially copyable.");
+
+    explicit MappedRecords(internal::SharedMappedFile file) : m_file{std::move(file)} {}
+
+    // The mapping is page aligned, records are correctly aligned.
+    const T* data() const { return reinterpret_cast<const T*>(m_file->data()); }
+    size_t size() const { return m_file->size() / sizeof(T); }
+
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+
+    std::span<const T> records() const { return {data(), size()}; }
+
+private:
+    internal::SharedMappedFile m_file;
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Range of the rows of a memory mapped CSV file. Each row is a span of field views that is
+/// only valid until the iterator moves to the next row.
+/// Quoted fields can contain delimiters and line breaks, the quotes are removed but doubled
+/// quotes inside a field are kept as they are in the file.
+class Csv {
+public:
+    class Iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = std::span<const std::string_view>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(std::string_view content, char delimiter)
+            : m_remaining{content}, m_delimiter{delimiter}
+        {
+            next();
+        }
+
+        std::span<const std::string_view> operator*() const { return m_fields; }
+
+        Iterator& operator++()
+        {
+            next();
+            return *this;
+        }
+
+        void operator++(int) { next(); }
+
+        bool operator==(std::default_sentinel_t) const { return m_at_end; }
+
+    private:
+        void next()
+        {
+            m_fields.clear();
+            if (m_remaining.empty()) {
+                m_at_end = true;
+                return;
+            }
+
+            for (;;) {
+                std::string_view field = next_field();
+                m_fields.push_back(field);
+
+                if (m_remaining.empty()) return;
+
+                const char separator = m_remaining.front();
+                m_remaining.remove_prefix(1);
+
+                if (separator == '\n') return;
+                if (separator == '\r') {
+                    if (m_remaining.starts_with('\n')) m_remaining.remove_prefix(1);
+                    return;
+                }
+            }
+        }
+
+        // Consumes a field and leaves the separator that follows it in `m_remaining`.
+        std::string_view next_field()
+        {
+            if (m_remaining.starts_with('"')) {
+                size_t position = 1;
+                for (;;) {
+                    position = m_remaining.find('"', position);
+                    if (position == std::string_view::npos) {
+                        std::string_view field = m_remaining.substr(1);
+                        m_remaining = {};
+                        return field;
+                    }
+                    if (position + 1 < m_remaining.size() && m_remaining[position + 1] == '"') {
+                        position += 2;
+                        continue;
+                    }
+                    break;
+                }
+
+                std::string_view field = m_remaining.substr(1, position - 1);
+                m_remaining.remove_prefix(position + 1);
+                skip_to_separator();
+                return field;
+            }
+
+            const char* begin = m_remaining.data();
+            skip_to_separator();
+            return {begin, size_t(m_remaining.data() - begin)};
+        }
+
+        void skip_to_separator()
+        {
+            size_t position = 0;
+            while (position < m_remaining.size() && m_remaining[position] != m_delimiter &&
+                   m_remaining[position] != '\n' && m_remaining[position] != '\r') {
+                ++position;
+            }
+            m_remaining.remove_prefix(position);
+        }
+
+        std::string_view m_remaining;
+        char m_delimiter = ',';
+        std::vector<std::string_view> m_fields;
+        bool m_at_end = false;
+    };
+
+    Csv(internal::SharedMappedFile file, char delimiter)
+        : m_file{std::move(file)}, m_delimiter{delimiter}
+    {
+    }
+
+    Iterator begin() const { return Iterator{m_file->view(), m_delimiter}; }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    internal::SharedMappedFile m_file;
+    char m_delimiter = ',';
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Sources reading memory mapped files. They yield views into the mapping without copying,
+/// pages are only read when the pipeline reaches them so `take` stops the reading early.
+/// Usage:
+/// @code
+/// auto errors = rpl::run(rpl::lines("server.log"),
+///                        rpl::filter([](std::string_view line) { return line.contains("E:"); }),
+///                        rpl::take(10),
+///                        rpl::to_vector());
+///
+/// auto total = rpl::run(rpl::mmap_records<Trade>("trades.bin"),
+///                       rpl::transform(&Trade::volume),
+///                       rpl::sum<i64>());
+///
+/// rpl::run(rpl::csv("users.csv"), rpl::for_each([](std::span<const std::string_view> row) {}));
+/// @endcode
+inline Lines lines(const std::filesystem::path& path) { return Lines{internal::map_file(path)}; }
+
+template <typename T>
+MappedRecords<T> mmap_records(const std::filesystem::path& path)
+{
+    return MappedRecords<T>{internal::map_file(path)};
+}
+
+inline Csv csv(const std::filesystem::path& path, char delimiter = ',')
+{
+    return Csv{internal::map_file(path), delimiter};
+}
+
+}  // namespace ez::rpl
@@ -2,9 +2,13 @@
 
 #include <ez/rpl/StageFactory.hpp>
 #include <ez/rpl/internal/Functional.hpp>
+#include <ez/rpl/internal/Simd.hpp>
 
 #include <ez/Option.hpp>
 
+#include <array>
+#include <span>
+
 namespace ez::rpl {
 
 template <typename InputType, typename Predicate>
@@ -21,6 +25,24 @@ struct Filter {
             next.process_incremental(static_cast<InputType>(val));
         }
     }
+
+    // Arithmetic values are compacted to a local buffer, the next stage receives copies
+    // instead of references to the source elements. Mutable references go element by element,
+    // and so do the elements ahead of a stage that processes them one at a time or may
+    // short-circuit.
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&& next)
+        requires internal::simd::CopyableArithmetic<InputType> &&
+                 internal::consumes_chunks<decltype(next)>() &&
+                 (!internal::can_short_circuit<decltype(next)>())
+    {
+        using Value = std::remove_cvref_t<InputType>;
+
+        std::array<Value, chunk_size> selected;
+        internal::simd::for_each_chunk(chunk, [&](auto values) {
+            const size_t count = internal::simd::compact(values, predicate, selected.data());
+            next.process_chunk(std::span<Value>{selected.data(), count});
+        });
+    }
 };
 
 template <typename InputType, typename Equals>
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <ez/rpl/Pipeline.hpp>
+#include <ez/rpl/StageFactory.hpp>
+#include <ez/rpl/internal/Functional.hpp>
+#include <ez/rpl/stages/Copy.hpp>
+
+#include <ez/FlatHashMap.hpp>
+
+namespace ez::rpl {
+
+template <typename InputType, typename KeyFn, typename Aggregator, typename...>
+struct GroupBy {
+    static_assert(is_streaming(Aggregator::input_processing_mode) &&
+                      Aggregator::output_processing_mode == ProcessingMode::Batch,
+                  "group_by aggregator must consume elements and output a batch.");
+
+    using Key = std::remove_cvref_t<decltype(internal::apply_fn(
+        std::declval<KeyFn&>(), std::declval<const std::remove_reference_t<InputType>&>()))>;
+
+    // Each group is aggregated by its own instance of the aggregator pipeline.
+    using GroupPipeline = Pipeline<Aggregator::input_processing_mode, InputType, Aggregator>;
+    using Aggregate = std::remove_cvref_t<typename GroupPipeline::OutputType>;
+
+    static constexpr bool shares_state = GroupPipeline::any_shares_state();
+
+    using ResultType = FlatHashMap<Key, Aggregate>;
+    using OutputType = ResultType&&;
+
+    static constexpr bool resets_partials =
+        requires(GroupPipeline& pipeline) { pipeline.first().begin_partial(); };
+
+    KeyFn key_fn;
+    Aggregator aggregator;
+    FlatHashMap<Key, GroupPipeline> groups;
+    bool partial = false;
+
+    GroupBy(auto&& k, auto&& a, size_t capacity = 0)
+        : key_fn{EZ_FWD(k)}, aggregator{EZ_FWD(a)}, groups{capacity}
+    {
+    }
+
+    void process_incremental(InputType input, auto&&)
+    {
+        auto group = groups.try_emplace(internal::apply_fn(key_fn, std::as_const(input)),
+                                        std::in_place, aggregator);
+        if constexpr (resets_partials) {
+            if (group.second && partial) group.first->second.first().begin_partial();
+        }
+        group.first->second.first().process_incremental(static_cast<InputType>(input));
+    }
+
+    decltype(auto) flush_to(auto&& next)
+    {
+        ResultType result{groups.size()};
+        for (auto& [key, pipeline] : groups) {
+            result.try_emplace(std::move(key), pipeline.first().flush());
+        }
+        groups.clear();
+        return next.process_batch(std::move(result));
+    }
+
+    // The aggregates are read from their pipelines, which keep aggregating.
+    decltype(auto) snapshot_to(auto&& next)
+    {
+        ResultType result{groups.size()};
+        for (auto& [key, pipeline] : groups) result.try_emplace(key, pipeline.first().snapshot());
+        return next.process_batch(std::move(result));
+    }
+
+    // Groups of a chunk other than the first start from the identity of the aggregator
+    // (accumulate...) instead of its initial value. An aggregator without identity cannot be
+    // combined: its combine rejects the parallel run.
+    void begin_partial() { partial = true; }
+
+    // Partial aggregates of the same key are merged with the aggregator's combine. `rhs` comes from
+    // a later chunk than `lhs`: its groups new to `lhs` are merged with the initial aggregate.
+    ResultType combine(ResultType&& lhs, ResultType&& rhs)
+    {
+        GroupPipeline reducer{std::in_place, aggregator};
+
+        for (auto& [key, aggregate] : rhs) {
+            if constexpr (resets_partials) {
+                if (!lhs.contains(key)) {
+                    GroupPipeline initial{std::in_place, aggregator};
+                    aggregate =
+                        reducer.first().combine(initial.first().flush(), std::move(aggregate));
+                }
+            }
+            auto group = lhs.try_emplace(std::move(key), std::move(aggregate));
+            if (!group.second) {
+                group.first->second =
+                    reducer.first().combine(std::move(group.first->second), std::move(aggregate));
+            }
+        }
+        return std::move(lhs);
+    }
+};
+
+/// Aggregates the elements sharing the same key in a hash table.
+/// `aggregator` is any stage consuming elements and outputting a batch (count, accumulate, min,
+/// max, to_vector, a composition...), one instance runs per group. `capacity` pre-sizes the
+/// table for the expected number of groups. Under `rpl::par` the aggregates are merged with the
+/// aggregator's combine, a composition must then end with its only reducer. The groups met after
+/// the first chunk start from the identity of the aggregator, which an accumulate with a custom
+/// combiner must be given.
+/// Usage:
+/// @code
+/// FlatHashMap<std::string, size_t> hits =
+///     rpl::run(events, rpl::group_by(&Event::user, rpl::count()));
+/// FlatHashMap<int, i64> totals = rpl::run(
+///     orders,
+///     rpl::group_by([](const Order& order) { return order.client; },
+///                   rpl::compose(rpl::transform(&Order::amount), rpl::sum<i64>())));
+/// @endcode
+template <typename KeyFn, typename Aggregator = decltype(to_vector())>
+auto group_by(KeyFn&& key_fn, Aggregator&& aggregator = to_vector(), size_t capacity = 0)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, GroupBy, KeyFn,
+                        Aggregator, size_t>(std::forward<KeyFn>(key_fn),
+                                            std::forward<Aggregator>(aggregator), size_t{capacity});
+}
+
+}  // namespace ez::rpl
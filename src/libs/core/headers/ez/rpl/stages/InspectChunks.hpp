@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ez/rpl/StageFactory.hpp>
+
+#include <functional>
+#include <span>
+
+namespace ez::rpl {
+
+template <typename InputType, typename F>
+struct InspectChunks {
+    using OutputType = InputType;
+    using Element = std::remove_reference_t<InputType>;
+
+    F f;
+
+    InspectChunks(auto&& f) : f{EZ_FWD(f)} {}
+
+    void process_chunk(std::span<Element> chunk, auto&& next)
+    {
+        std::invoke(f, std::span<const Element>{chunk});
+        next.process_chunk(chunk);
+    }
+};
+
+/// Calls `f` with read only spans of consecutive elements, then forwards the elements unchanged.
+/// Useful for prefetching, bulk writes or progress reporting. Elements received one by one are
+/// gathered in chunks when moved or read only, mutable lvalues are handed over one at a time.
+/// Usage:
+/// @code
+/// auto total = rpl::run(
+///     values,
+///     rpl::inspect_chunks([&](std::span<const int> chunk) { progress += chunk.size(); }),
+///     rpl::accumulate<i64>());
+/// @endcode
+template <typename F>
+auto inspect_chunks(F&& f)
+{
+    return make_factory<ProcessingMode::Chunked, ProcessingMode::Chunked, InspectChunks, F>(
+        std::forward<F>(f));
+}
+
+}  // namespace ez::rpl
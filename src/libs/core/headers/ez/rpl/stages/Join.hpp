@@ -0,0 +1,268 @@
+#pragma once
+
+#include <ez/rpl/StageFactory.hpp>
+#include <ez/rpl/stages/Zip.hpp>
+
+#include <ez/FlatHashMap.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ez::rpl {
+
+/// Range of the pairs of elements with equal keys from two ranges sorted by key. Runs of equal
+/// keys produce their cartesian product, the right range is iterated again for each element of
+/// the left run.
+template <typename Left, typename Right, typename LeftKey, typename RightKey>
+class MergeJoin {
+public:
+    class Iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type =
+            Tuple<internal::SourceReference<Left>, internal::SourceReference<Right>>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        explicit Iterator(const MergeJoin& join)
+            : m_join{&join},
+              m_left{std::ranges::begin(join.m_left)},
+              m_left_end{std::ranges::end(join.m_left)},
+              m_right_run{std::ranges::begin(join.m_right)},
+              m_right{m_right_run},
+              m_right_end{std::ranges::end(join.m_right)}
+        {
+            find_match();
+        }
+
+        value_type operator*() const { return value_type{*m_left, *m_right}; }
+
+        Iterator& operator++()
+        {
+            if (++m_right != m_right_end && same_key(*m_left, *m_right)) return *this;
+
+            if (++m_left != m_left_end && same_key(*m_left, *m_right_run)) {
+                m_right = m_right_run;
+                return *this;
+            }
+            find_match();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return m_left == m_left_end || m_right == m_right_end;
+        }
+
+    private:
+        decltype(auto) left_key(auto&& left) const
+        {
+            return std::invoke(m_join->m_left_key, EZ_FWD(left));
+        }
+
+        decltype(auto) right_key(auto&& right) const
+        {
+            return std::invoke(m_join->m_right_key, EZ_FWD(right));
+        }
+
+        bool same_key(auto&& left, auto&& right) const
+        {
+            const auto& lhs = left_key(EZ_FWD(left));
+            const auto& rhs = right_key(EZ_FWD(right));
+            return !(lhs < rhs) && !(rhs < lhs);
+        }
+
+        void find_match()
+        {
+            while (m_left != m_left_end && m_right != m_right_end) {
+                // The keys can reference the elements, which are kept alive while compared.
+                auto&& left = *m_left;
+                auto&& right = *m_right;
+                const auto& lhs = left_key(EZ_FWD(left));
+                const auto& rhs = right_key(EZ_FWD(right));
+                if (lhs < rhs) { ++m_left; }
+                else if (rhs < lhs) {
+                    ++m_right;
+                }
+                else {
+                    m_right_run = m_right;
+                    return;
+                }
+            }
+        }
+
+        const MergeJoin* m_join = nullptr;
+        std::ranges::iterator_t<const Left> m_left;
+        std::ranges::sentinel_t<const Left> m_left_end;
+        std::ranges::iterator_t<const Right> m_right_run;
+        std::ranges::iterator_t<const Right> m_right;
+        std::ranges::sentinel_t<const Right> m_right_end;
+    };
+
+    MergeJoin(Left left, Right right, LeftKey left_key, RightKey right_key)
+        : m_left{std::move(left)},
+          m_right{std::move(right)},
+          m_left_key{std::move(left_key)},
+          m_right_key{std::move(right_key)}
+    {
+    }
+
+    Iterator begin() const { return Iterator{*this}; }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    Left m_left;
+    Right m_right;
+    LeftKey m_left_key;
+    RightKey m_right_key;
+};
+
+///////////////////////////////////////////////////////////////////////
+
+namespace internal {
+
+/// Build side of a hash join. Rows with the same key are chained by index in insertion order,
+/// the table only allocates the key map and two arrays.
+template <typename View, typename KeyFn>
+class HashJoinTable {
+public:
+    using Reference = SourceReference<View>;
+    using Key = std::remove_cvref_t<std::invoke_result_t<KeyFn&, Reference>>;
+
+    static_assert(std::is_lvalue_reference_v<Reference>,
+                  "The build side of a hash join must yield lvalue references.");
+
+    HashJoinTable(View view, KeyFn key) : m_view{std::move(view)}
+    {
+        if constexpr (std::ranges::sized_range<const View>) {
+            m_rows.reserve(std::ranges::size(m_view));
+            m_next.reserve(std::ranges::size(m_view));
+        }
+
+        for (Reference row : m_view) {
+            const size_t index = m_rows.size();
+            m_rows.push_back(std::addressof(row));
+            m_next.push_back(npos);
+
+            auto [it, inserted] = m_chains.try_emplace(std::invoke(key, row), Chain{index, index});
+            if (!inserted) {
+                m_next[it->second.last] = index;
+                it->second.last = index;
+            }
+        }
+    }
+
+    // Calls `f` on each row matching `key` while it returns true.
+    void for_each_match(const Key& key, auto&& f) const
+    {
+        auto it = m_chains.find(key);
+        if (it == m_chains.end()) return;
+
+        for (size_t index = it->second.first; index != npos; index = m_next[index]) {
+            if (!f(static_cast<Reference>(*m_rows[index]))) return;
+        }
+    }
+
+private:
+    static constexpr size_t npos = size_t(-1);
+
+    struct Chain {
+        size_t first = npos;
+        size_t last = npos;
+    };
+
+    View m_view;
+    std::vector<std::remove_reference_t<Reference>*> m_rows;
+    std::vector<size_t> m_next;
+    FlatHashMap<Key, Chain> m_chains;
+};
+
+}  // namespace internal
+
+template <typename InputType, typename SharedTable, typename ProbeKey, typename...>
+struct HashJoin {
+    using Probe = std::remove_reference_t<InputType>&;
+    using Row = typename SharedTable::element_type::Reference;
+    using OutputType = Tuple<Probe, Row>&&;
+
+    SharedTable table;
+    ProbeKey probe_key;
+
+    HashJoin(SharedTable t, auto&& key)
+        : table{std::move(t)}, probe_key{EZ_FWD(key)}
+    {
+    }
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        Probe probe = input;
+        table->for_each_match(std::invoke(probe_key, std::as_const(probe)), [&](Row row) {
+            next.process_incremental(Tuple<Probe, Row>{probe, row});
+            return !internal::is_done(next);
+        });
+    }
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Inner join of two ranges sorted by key, emitting `Tuple{left, right}` of references.
+/// Keys are compared with `<`, a single key function is used for both sides unless two are
+/// given. The right range must be a forward range.
+/// Usage:
+/// @code
+/// rpl::run(rpl::merge_join(orders, payments, &Event::order_id),
+///          rpl::filter([](const Event& order, const Event& payment) { return ...; }),
+///          rpl::count());
+/// @endcode
+template <internal::SourceRange Left, internal::SourceRange Right, typename LeftKey,
+          typename RightKey>
+    requires std::ranges::forward_range<const std::views::all_t<Right>>
+auto merge_join(Left&& left, Right&& right, LeftKey&& left_key, RightKey&& right_key)
+{
+    return MergeJoin<std::views::all_t<Left>, std::views::all_t<Right>,
+                     std::decay_t<LeftKey>, std::decay_t<RightKey>>{
+        std::views::all(std::forward<Left>(left)), std::views::all(std::forward<Right>(right)),
+        std::forward<LeftKey>(left_key), std::forward<RightKey>(right_key)};
+}
+
+template <internal::SourceRange Left, internal::SourceRange Right, typename Key>
+auto merge_join(Left&& left, Right&& right, Key&& key)
+{
+    auto right_key = key;
+    return merge_join(std::forward<Left>(left), std::forward<Right>(right), std::forward<Key>(key),
+                      std::move(right_key));
+}
+
+/// Joins the incoming elements with the rows of `build` having the same key and emits
+/// `Tuple{element, row}` for each match. The hash table is built once, when the stage factory
+/// is created, and shared by the copies of the pipeline of a parallel run.
+/// Usage:
+/// @code
+/// rpl::run(orders, rpl::hash_join(customers, &Customer::id, &Order::customer_id),
+///          rpl::apply([](const Order& order, const Customer& customer) { ... }),
+///          rpl::to_vector());
+/// @endcode
+template <internal::SourceRange Build, typename BuildKey, typename ProbeKey>
+auto hash_join(Build&& build, BuildKey&& build_key, ProbeKey&& probe_key)
+{
+    using Table = internal::HashJoinTable<std::views::all_t<Build>, std::decay_t<BuildKey>>;
+
+    auto table = std::make_shared<const Table>(std::views::all(std::forward<Build>(build)),
+                                               std::forward<BuildKey>(build_key));
+
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, HashJoin,
+                        std::shared_ptr<const Table>, ProbeKey>(
+        std::move(table), std::forward<ProbeKey>(probe_key));
+}
+
+template <internal::SourceRange Build, typename Key>
+auto hash_join(Build&& build, Key&& key)
+{
+    auto probe_key = key;
+    return hash_join(std::forward<Build>(build), std::forward<Key>(key), std::move(probe_key));
+}
+
+}  // namespace ez::rpl
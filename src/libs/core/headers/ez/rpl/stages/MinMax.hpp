@@ -1,9 +1,12 @@
 #pragma once
 
 #include <ez/rpl/StageFactory.hpp>
+#include <ez/rpl/internal/Simd.hpp>
 
 #include <ez/Option.hpp>
 
+#include <span>
+
 namespace ez::rpl {
 
 template <typename InputType, typename Less>
@@ -20,7 +23,23 @@ struct Min {
         if (!result || less(std::as_const(input), result)) result = static_cast<InputType>(input);
     }
 
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&&)
+        requires std::is_integral_v<std::remove_cvref_t<InputType>> &&
+                 std::is_same_v<Less, std::less<>>
+    {
+        if (chunk.empty()) return;
+        auto value = internal::simd::select(chunk, less);
+        if (!result || less(value, *result)) result = value;
+    }
+
     decltype(auto) flush_to(auto&& next) { return next.process_batch(std::move(result)); }
+    decltype(auto) snapshot_to(auto&& next) { return next.process_batch(R(result)); }
+
+    R combine(R&& lhs, R&& rhs)
+    {
+        if (!lhs || (rhs && less(std::as_const(*rhs), std::as_const(*lhs)))) return std::move(rhs);
+        return std::move(lhs);
+    }
 };
 
 template <typename InputType, typename Greater>
@@ -38,7 +57,24 @@ struct Max {
             result = static_cast<InputType>(input);
     }
 
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&&)
+        requires std::is_integral_v<std::remove_cvref_t<InputType>> &&
+                 std::is_same_v<Greater, std::greater<>>
+    {
+        if (chunk.empty()) return;
+        auto value = internal::simd::select(chunk, greater);
+        if (!result || greater(value, *result)) result = value;
+    }
+
     decltype(auto) flush_to(auto&& next) { return next.process_batch(std::move(result)); }
+    decltype(auto) snapshot_to(auto&& next) { return next.process_batch(R(result)); }
+
+    R combine(R&& lhs, R&& rhs)
+    {
+        if (!lhs || (rhs && greater(std::as_const(*rhs), std::as_const(*lhs))))
+            return std::move(rhs);
+        return std::move(lhs);
+    }
 };
 
 template <typename Less = std::less<>>
@@ -11,6 +11,8 @@ struct ReorderImpl {
     using OutputTuple = Tuple<decltype(std::get<indices>(std::declval<InputType>()))...>;
     using OutputType = OutputTuple&&;
 
+    static constexpr bool preserves_size = true;
+
     void process_incremental(InputType input, auto&& next)
     {
         next.process_incremental(OutputTuple{std::get<indices>(static_cast<InputType>(input))...});
@@ -15,4 +15,28 @@ auto sort(Less&& less = {})
     });
 }
 
+/// Keeps the `k` first elements of the container according to `less`, sorted.
+template <typename Less = std::less<>>
+auto partial_sort(size_t k, Less&& less = {})
+{
+    return transform_batch([k, less = std::forward<Less>(less)](auto&& range) -> decltype(auto) {
+        auto middle = std::begin(range) + std::min<size_t>(k, std::size(range));
+        std::partial_sort(std::begin(range), middle, std::end(range), less);
+        range.erase(middle, range.end());
+        return EZ_FWD(range);
+    });
+}
+
+/// Places the element that would be at position `n` if the container was sorted, with the
+/// smaller elements before it and the greater ones after it.
+template <typename Less = std::less<>>
+auto nth_element(size_t n, Less&& less = {})
+{
+    return transform_batch([n, less = std::forward<Less>(less)](auto&& range) -> decltype(auto) {
+        auto nth = std::begin(range) + std::min<size_t>(n, std::size(range));
+        std::nth_element(std::begin(range), nth, std::end(range), less);
+        return EZ_FWD(range);
+    });
+}
+
 }  // namespace ez::rpl
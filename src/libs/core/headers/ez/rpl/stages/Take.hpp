@@ -2,6 +2,8 @@
 
 #include <ez/rpl/StageFactory.hpp>
 
+#include <algorithm>
+
 namespace ez::rpl {
 
 template <typename InputType, typename...>
@@ -19,6 +21,8 @@ struct Take {
         ++count;
     }
 
+    void reserve(size_t n, auto&& next) { next.reserve(std::min(n, max - std::min(count, max))); }
+
     bool done() const { return count >= max; }
 };
 
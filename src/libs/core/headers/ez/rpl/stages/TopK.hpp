@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ez/rpl/StageFactory.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace ez::rpl {
+
+template <typename InputType, typename Less, typename...>
+struct TopK {
+    using ValueType = std::remove_cvref_t<InputType>;
+    using ResultType = std::vector<ValueType>;
+    using OutputType = ResultType&&;
+
+    Less less;
+    size_t k = 0;
+
+    // Max heap according to `less`: the front is the first element to evict.
+    ResultType heap;
+
+    TopK(auto&& l, size_t count) : less{EZ_FWD(l)}, k{count} {}
+
+    // The heap grows with the input: `k` may be much larger than the input ("all").
+    void reserve(size_t count, auto&&) { heap.reserve(std::min(k, heap.size() + count)); }
+
+    void process_incremental(InputType input, auto&&)
+    {
+        if (heap.size() < k) {
+            heap.push_back(static_cast<InputType>(input));
+            std::push_heap(heap.begin(), heap.end(), less);
+        }
+        else if (k > 0 && less(std::as_const(input), heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), less);
+            heap.back() = static_cast<InputType>(input);
+            std::push_heap(heap.begin(), heap.end(), less);
+        }
+    }
+
+    decltype(auto) flush_to(auto&& next)
+    {
+        std::sort_heap(heap.begin(), heap.end(), less);
+        return next.process_batch(std::move(heap));
+    }
+
+    decltype(auto) snapshot_to(auto&& next)
+    {
+        ResultType sorted = heap;
+        std::sort_heap(sorted.begin(), sorted.end(), less);
+        return next.process_batch(std::move(sorted));
+    }
+
+    ResultType combine(ResultType&& lhs, ResultType&& rhs)
+    {
+        lhs.insert(lhs.end(), std::make_move_iterator(rhs.begin()),
+                   std::make_move_iterator(rhs.end()));
+        auto middle = lhs.begin() + std::min(k, lhs.size());
+        std::partial_sort(lhs.begin(), middle, lhs.end(), less);
+        lhs.erase(middle, lhs.end());
+        return std::move(lhs);
+    }
+};
+
+/// Keeps the `k` first elements according to `less` and outputs them sorted, in O(k) memory.
+/// Usage:
+/// @code
+/// auto best_scores = rpl::run(scores, rpl::top_k(100, std::greater<>()));
+/// @endcode
+template <typename Less = std::less<>>
+auto top_k(size_t k, Less&& less = {})
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Batch, TopK, Less, size_t>(
+        std::forward<Less>(less), size_t{k});
+}
+
+}  // namespace ez::rpl
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <ez/rpl/StageFactory.hpp>
+#include <ez/rpl/internal/Simd.hpp>
 
+#include <array>
 #include <functional>
+#include <span>
 #include <type_traits>
 
 namespace ez::rpl {
@@ -15,6 +18,8 @@ struct Transform {
                                           Unit&&,
                                           std::add_rvalue_reference_t<InvokeResult>>;
 
+    static constexpr bool preserves_size = true;
+
     T transform;
 
     Transform(auto&& t) : transform{EZ_FWD(t)} {}
@@ -29,6 +34,22 @@ struct Transform {
             next.process_incremental(std::invoke(transform, static_cast<InputType>(input)));
         }
     }
+
+    // The whole chunk is transformed before the next stage sees it: only ahead of a stage which
+    // processes chunks at once, and not ahead of a take.
+    void process_chunk(std::span<std::remove_reference_t<InputType>> chunk, auto&& next)
+        requires std::is_arithmetic_v<InvokeResult> &&
+                 internal::consumes_chunks<decltype(next)>() &&
+                 (!internal::can_short_circuit<decltype(next)>())
+    {
+        std::array<InvokeResult, chunk_size> results;
+        internal::simd::for_each_chunk(chunk, [&](auto values) {
+            for (size_t i = 0; i < values.size(); ++i) {
+                results[i] = std::invoke(transform, static_cast<InputType>(values[i]));
+            }
+            next.process_chunk(std::span<InvokeResult>{results.data(), values.size()});
+        });
+    }
 };
 
 template <typename InputType, typename T>
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <ez/rpl/StageFactory.hpp>
+
+#include <ez/Option.hpp>
+#include <ez/RingBuffer.hpp>
+#include <ez/Tuple.hpp>
+
+#include <chrono>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace ez::rpl {
+
+template <typename InputType, typename...>
+struct Window {
+    using ValueType = std::remove_cvref_t<InputType>;
+    using View = std::span<const ValueType>;
+    using OutputType = View&&;
+
+    size_t size = 1;
+    std::vector<ValueType> buffer;
+
+    Window(size_t n) : size{std::max<size_t>(n, 1)} { buffer.reserve(size); }
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        buffer.push_back(static_cast<InputType>(input));
+        if (buffer.size() == size) {
+            next.process_incremental(View{buffer});
+            buffer.clear();
+        }
+    }
+
+    decltype(auto) flush_to(auto&& next)
+    {
+        if (!buffer.empty() && !internal::is_done(next)) next.process_incremental(View{buffer});
+        buffer.clear();
+        return next.flush();
+    }
+};
+
+// Every element is written twice, `size` slots apart, so that the last `size` elements are
+// always contiguous.
+template <typename InputType, typename...>
+struct Sliding {
+    using ValueType = std::remove_cvref_t<InputType>;
+    using View = std::span<const ValueType>;
+    using OutputType = View&&;
+
+    size_t size = 1;
+    size_t step = 1;
+    size_t position = 0;
+    size_t count = 0;
+    std::vector<ValueType> ring;
+
+    Sliding(size_t n, size_t s)
+        : size{std::max<size_t>(n, 1)}, step{std::max<size_t>(s, 1)}, ring(2 * size)
+    {
+    }
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        ring[position] = static_cast<InputType>(input);
+        ring[position + size] = ring[position];
+        if (++position == size) position = 0;
+
+        if (++count >= size && (count - size) % step == 0) {
+            next.process_incremental(View{ring.data() + position, size});
+        }
+    }
+};
+
+template <typename InputType, typename Duration, typename TimestampFn, typename...>
+struct Tumbling {
+    using ValueType = std::remove_cvref_t<InputType>;
+    using TimePoint = std::remove_cvref_t<std::invoke_result_t<TimestampFn&, const ValueType&>>;
+    using View = std::span<const ValueType>;
+    using OutputType = Tuple<TimePoint, View>&&;
+
+    Duration duration;
+    TimestampFn timestamp;
+
+    Option<TimePoint> start;
+    std::vector<ValueType> buffer;
+
+    Tumbling(Duration d, auto&& ts) : duration{d}, timestamp{EZ_FWD(ts)} {}
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        const TimePoint window_start = window_of(std::invoke(timestamp, std::as_const(input)));
+
+        if (start && *start != window_start) emit(next);
+        start = window_start;
+        buffer.push_back(static_cast<InputType>(input));
+    }
+
+    decltype(auto) flush_to(auto&& next)
+    {
+        if (!buffer.empty() && !internal::is_done(next)) emit(next);
+        return next.flush();
+    }
+
+private:
+    // Windows are aligned on multiples of the duration since the clock epoch.
+    TimePoint window_of(TimePoint time) const
+    {
+        const auto since_epoch = time.time_since_epoch();
+        auto index = since_epoch / duration;
+        if (index * duration > since_epoch) --index;
+        using TimeDuration = typename TimePoint::duration;
+        return TimePoint{std::chrono::duration_cast<TimeDuration>(index * duration)};
+    }
+
+    void emit(auto& next)
+    {
+        next.process_incremental(Tuple<TimePoint, View>{*start, View{buffer}});
+        buffer.clear();
+    }
+};
+
+///////////////////////////////////////////////////////////////////////
+
+template <typename InputType, typename...>
+struct RollingSum {
+    using ValueType = std::remove_cvref_t<InputType>;
+    using SumType = decltype(std::declval<ValueType>() + std::declval<ValueType>());
+    using OutputType = SumType&&;
+
+    RingBuffer<ValueType> values;
+    SumType sum{};
+
+    RollingSum(size_t n) : values{n} {}
+
+    // Returns true once the window is full.
+    bool push(InputType input)
+    {
+        if (values.full()) {
+            sum -= values.front();
+            values.pop_front();
+        }
+        sum += input;
+        values.push_back(static_cast<InputType>(input));
+        return values.full();
+    }
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        if (push(static_cast<InputType>(input))) next.process_incremental(SumType{sum});
+    }
+};
+
+template <typename InputType, typename...>
+struct RollingMean : RollingSum<InputType> {
+    using OutputType = double&&;
+
+    using RollingSum<InputType>::RollingSum;
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        if (this->push(static_cast<InputType>(input))) {
+            next.process_incremental(double(this->sum) / double(this->values.capacity()));
+        }
+    }
+};
+
+// Monotonic deque: the candidates are kept ordered by `compare` and the front is the extremum
+// of the window. Each element is pushed and popped at most once.
+template <typename InputType, typename Compare, typename...>
+struct RollingExtremum {
+    using ValueType = std::remove_cvref_t<InputType>;
+    using OutputType = ValueType&&;
+
+    Compare compare;
+    size_t size = 1;
+    size_t index = 0;
+    RingBuffer<std::pair<size_t, ValueType>> candidates;
+
+    RollingExtremum(auto&& c, size_t n)
+        : compare{EZ_FWD(c)}, size{std::max<size_t>(n, 1)}, candidates{size}
+    {
+    }
+
+    void process_incremental(InputType input, auto&& next)
+    {
+        if (!candidates.empty() && candidates.front().first + size <= index) {
+            candidates.pop_front();
+        }
+        while (!candidates.empty() && !compare(candidates.back().second, std::as_const(input))) {
+            candidates.pop_back();
+        }
+        candidates.push_back(std::pair<size_t, ValueType>{index, static_cast<InputType>(input)});
+
+        if (++index >= size) next.process_incremental(ValueType{candidates.front().second});
+    }
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Groups the elements by consecutive windows of `n` elements, the last one can be shorter.
+/// The windows are views over an internal buffer, valid until the next window is emitted.
+/// Usage:
+/// @code
+/// rpl::run(values, rpl::window(64), rpl::for_each([](std::span<const int> batch) {}));
+/// @endcode
+inline auto window(size_t n)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, Window>(
+        size_t{n});
+}
+
+/// Emits a view over the last `n` elements every `step` elements, once `n` elements are
+/// received. The views are valid until the next element is processed.
+inline auto sliding(size_t n, size_t step = 1)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, Sliding>(
+        size_t{n}, size_t{step});
+}
+
+/// Groups the elements by time windows of `duration` aligned on the clock epoch and emits
+/// `Tuple{window_start, elements}`. Timestamps must not decrease.
+/// Usage:
+/// @code
+/// rpl::run(samples,
+///          rpl::tumbling(std::chrono::minutes{1}, &Sample::time),
+///          rpl::apply([](auto start, std::span<const Sample> samples) { return samples.size(); }),
+///          rpl::to_vector());
+/// @endcode
+template <typename Rep, typename Period, typename TimestampFn>
+auto tumbling(std::chrono::duration<Rep, Period> duration, TimestampFn&& timestamp)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, Tumbling,
+                        std::chrono::duration<Rep, Period>, TimestampFn>(
+        std::move(duration), std::forward<TimestampFn>(timestamp));
+}
+
+/// Rolling aggregates over the last `n` elements, emitted for every element once `n` elements
+/// are received. Each update is O(1) (amortized for min and max).
+inline auto rolling_sum(size_t n)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, RollingSum>(
+        size_t{n});
+}
+
+inline auto rolling_mean(size_t n)
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, RollingMean>(
+        size_t{n});
+}
+
+template <typename Less = std::less<>>
+auto rolling_min(size_t n, Less&& less = {})
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, RollingExtremum,
+                        Less, size_t>(std::forward<Less>(less), size_t{n});
+}
+
+template <typename Greater = std::greater<>>
+auto rolling_max(size_t n, Greater&& greater = {})
+{
+    return make_factory<ProcessingMode::Incremental, ProcessingMode::Incremental, RollingExtremum,
+                        Greater, size_t>(std::forward<Greater>(greater), size_t{n});
+}
+
+}  // namespace ez::rpl
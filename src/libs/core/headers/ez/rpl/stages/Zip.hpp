@@ -0,0 +1,170 @@
+#pragma once
+
+#include <ez/Tuple.hpp>
+
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+
+namespace ez::rpl {
+
+namespace internal {
+
+// Sources keep lvalue ranges by reference and take ownership of rvalue ones.
+template <typename R>
+concept SourceRange = std::ranges::viewable_range<R> &&
+                      std::ranges::input_range<const std::views::all_t<R>>;
+
+template <typename View>
+using SourceReference = std::ranges::range_reference_t<const View>;
+
+}  // namespace internal
+
+/// Range of tuples of references to the elements at the same position in each range. Stops at
+/// the end of the shortest range.
+template <typename... Views>
+class Zip {
+public:
+    class Iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = Tuple<internal::SourceReference<Views>...>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        explicit Iterator(const std::tuple<Views...>& views)
+            : m_iterators{std::apply(
+                  [](const auto&... view) { return std::tuple{std::ranges::begin(view)...}; },
+                  views)},
+              m_ends{std::apply(
+                  [](const auto&... view) { return std::tuple{std::ranges::end(view)...}; },
+                  views)}
+        {
+        }
+
+        value_type operator*() const
+        {
+            return std::apply([](const auto&... it) { return value_type{*it...}; }, m_iterators);
+        }
+
+        Iterator& operator++()
+        {
+            std::apply([](auto&... it) { (++it, ...); }, m_iterators);
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return [&]<size_t... indices>(std::index_sequence<indices...>) {
+                return ((std::get<indices>(m_iterators) == std::get<indices>(m_ends)) || ...);
+            }(std::index_sequence_for<Views...>{});
+        }
+
+    private:
+        std::tuple<std::ranges::iterator_t<const Views>...> m_iterators;
+        std::tuple<std::ranges::sentinel_t<const Views>...> m_ends;
+    };
+
+    explicit Zip(Views... views) : m_views{std::move(views)...} {}
+
+    Iterator begin() const { return Iterator{m_views}; }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    std::tuple<Views...> m_views;
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Range of the elements of the first range followed by the elements of the second one.
+template <typename First, typename Second>
+class Concat {
+public:
+    using Reference = std::common_reference_t<internal::SourceReference<First>,
+                                              internal::SourceReference<Second>>;
+
+    class Iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = std::remove_cvref_t<Reference>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(const First& first, const Second& second)
+            : m_first{std::ranges::begin(first)},
+              m_first_end{std::ranges::end(first)},
+              m_second{std::ranges::begin(second)},
+              m_second_end{std::ranges::end(second)}
+        {
+        }
+
+        Reference operator*() const
+        {
+            if (m_first != m_first_end) return static_cast<Reference>(*m_first);
+            return static_cast<Reference>(*m_second);
+        }
+
+        Iterator& operator++()
+        {
+            if (m_first != m_first_end) { ++m_first; }
+            else {
+                ++m_second;
+            }
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return m_first == m_first_end && m_second == m_second_end;
+        }
+
+    private:
+        std::ranges::iterator_t<const First> m_first;
+        std::ranges::sentinel_t<const First> m_first_end;
+        std::ranges::iterator_t<const Second> m_second;
+        std::ranges::sentinel_t<const Second> m_second_end;
+    };
+
+    Concat(First first, Second second) : m_first{std::move(first)}, m_second{std::move(second)}
+    {
+    }
+
+    Iterator begin() const { return Iterator{m_first, m_second}; }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    First m_first;
+    Second m_second;
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/// Sources combining several ranges. Lvalue ranges are referenced and must outlive the source,
+/// rvalue ranges are moved into it. Elements are neither copied nor buffered.
+/// Usage:
+/// @code
+/// rpl::run(rpl::zip(names, ages), rpl::filter([](const auto& name, int age) { return age > 18; }),
+///          rpl::to_vector());
+///
+/// rpl::run(rpl::concat(yesterday, today), rpl::count());
+/// @endcode
+template <internal::SourceRange... Ranges>
+    requires(sizeof...(Ranges) > 0)
+auto zip(Ranges&&... ranges)
+{
+    return Zip<std::views::all_t<Ranges>...>{std::views::all(std::forward<Ranges>(ranges))...};
+}
+
+template <internal::SourceRange First, internal::SourceRange Second>
+auto concat(First&& first, Second&& second)
+{
+    return Concat<std::views::all_t<First>, std::views::all_t<Second>>{
+        std::views::all(std::forward<First>(first)), std::views::all(std::forward<Second>(second))};
+}
+
+}  // namespace ez::rpl
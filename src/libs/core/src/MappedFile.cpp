@@ -0,0 +1,106 @@
+#include <ez/MappedFile.hpp>
+
+#include <ez/Os.hpp>
+
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#if !defined(EZ_OS_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ez {
+
+namespace {
+
+[[noreturn]] void throw_system_error(const std::filesystem::path& path)
+{
+    throw std::system_error{errno, std::generic_category(), path.string()};
+}
+
+#if !defined(EZ_OS_WINDOWS)
+int to_advice(MappedFile::Access access)
+{
+    switch (access) {
+        case MappedFile::Access::Sequential: return MADV_SEQUENTIAL;
+        case MappedFile::Access::Random: return MADV_RANDOM;
+        case MappedFile::Access::Normal: break;
+    }
+    return MADV_NORMAL;
+}
+#endif
+
+}  // namespace
+
+MappedFile::MappedFile(const std::filesystem::path& path, [[maybe_unused]] Access access)
+{
+#if !defined(EZ_OS_WINDOWS)
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw_system_error(path);
+
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw_system_error(path);
+    }
+
+    m_size = size_t(status.st_size);
+
+    // Mapping an empty file fails, there is nothing to map anyway.
+    if (m_size > 0) {
+        void* address = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            throw_system_error(path);
+        }
+        ::madvise(address, m_size, to_advice(access));
+        m_data = static_cast<const char*>(address);
+    }
+
+    // The mapping stays valid once the descriptor is closed.
+    ::close(fd);
+#else
+    std::ifstream stream{path, std::ios::binary};
+    if (!stream) throw_system_error(path);
+    m_fallback.assign(std::istreambuf_iterator<char>{stream}, {});
+    m_data = m_fallback.data();
+    m_size = m_fallback.size();
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data{std::exchange(other.m_data, nullptr)},
+      m_size{std::exchange(other.m_size, 0)},
+      m_fallback{std::move(other.m_fallback)}
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_fallback = std::move(other.m_fallback);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { release(); }
+
+void MappedFile::release() noexcept
+{
+#if !defined(EZ_OS_WINDOWS)
+    if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_fallback.clear();
+}
+
+}  // namespace ez
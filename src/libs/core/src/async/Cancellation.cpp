@@ -0,0 +1,57 @@
+#include <ez/async/Cancellation.hpp>
+
+namespace ez::async::internal {
+
+bool CancellationState::request()
+{
+    {
+        std::lock_guard lock{m_mutex};
+        if (m_requested.load(std::memory_order::relaxed)) return false;
+        m_requested.store(true, std::memory_order::release);
+        m_requesting_thread = std::this_thread::get_id();
+    }
+
+    std::unique_lock lock{m_mutex};
+    while (CancellationRegistration* registration = m_registrations.pop_front()) {
+        registration->queued = false;
+        m_running.store(registration, std::memory_order::relaxed);
+        lock.unlock();
+
+        // The callback may destroy its own registration (a resumed coroutine leaving the
+        // awaiter), it must not be touched afterwards.
+        registration->invoke(registration);
+
+        lock.lock();
+        m_running.store(nullptr, std::memory_order::release);
+        m_running.notify_all();
+    }
+    return true;
+}
+
+bool CancellationState::add(CancellationRegistration* registration)
+{
+    std::lock_guard lock{m_mutex};
+    if (m_requested.load(std::memory_order::relaxed)) return false;
+    m_registrations.push_back(registration);
+    registration->queued = true;
+    return true;
+}
+
+void CancellationState::remove(CancellationRegistration* registration)
+{
+    std::unique_lock lock{m_mutex};
+    if (registration->queued) {
+        m_registrations.remove(registration);
+        registration->queued = false;
+        return;
+    }
+    if (m_running.load(std::memory_order::relaxed) != registration) return;
+
+    // Removed from its own callback.
+    if (m_requesting_thread == std::this_thread::get_id()) return;
+
+    lock.unlock();
+    m_running.wait(registration, std::memory_order::acquire);
+}
+
+}  // namespace ez::async::internal
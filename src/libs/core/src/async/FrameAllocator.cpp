@@ -0,0 +1,131 @@
+#include <ez/async/FrameAllocator.hpp>
+
+#include <cstddef>
+#include <new>
+
+namespace ez::async {
+
+namespace {
+
+// Every block starts with the arena it comes from, the frame keeps the default new alignment.
+constexpr size_t header_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+constexpr size_t class_granularity = 64;
+constexpr size_t class_count = 16;
+constexpr size_t max_pooled_block = class_granularity * class_count;
+constexpr u32 max_cached_blocks = 128;
+
+struct FrameHeader {
+    std::pmr::memory_resource* arena;
+};
+static_assert(sizeof(FrameHeader) <= header_size);
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// Trivially destructible, still usable while the thread local objects are destroyed.
+struct FrameCache {
+    FreeBlock* heads[class_count];
+    u32 counts[class_count];
+    bool released;
+};
+
+thread_local constinit FrameCache t_cache{};
+thread_local constinit FrameAllocationStats t_stats{};
+
+struct FrameCacheReleaser {
+    ~FrameCacheReleaser()
+    {
+        release_cached_frames();
+        t_cache.released = true;
+    }
+};
+
+thread_local FrameCacheReleaser t_releaser;
+
+size_t size_class(size_t block) { return (block - 1) / class_granularity; }
+
+}  // namespace
+
+FrameAllocationStats frame_allocation_stats() noexcept
+{
+    return t_stats;
+}
+
+void reset_frame_allocation_stats() noexcept
+{
+    t_stats = {};
+}
+
+void release_cached_frames() noexcept
+{
+    for (size_t i = 0; i < class_count; ++i) {
+        while (FreeBlock* block = t_cache.heads[i]) {
+            t_cache.heads[i] = block->next;
+            ::operator delete(block);
+        }
+        t_cache.counts[i] = 0;
+    }
+}
+
+namespace internal {
+
+void* allocate_frame(size_t size, std::pmr::memory_resource* arena)
+{
+    ++t_stats.allocations;
+    t_stats.bytes += size;
+
+    const size_t block_size = size + header_size;
+    void* block = nullptr;
+    if (arena != nullptr) {
+        ++t_stats.arena;
+        block = arena->allocate(block_size, header_size);
+    }
+    else if (block_size <= max_pooled_block) {
+        const size_t index = size_class(block_size);
+        if (FreeBlock* cached = t_cache.heads[index]) {
+            ++t_stats.pooled;
+            t_cache.heads[index] = cached->next;
+            --t_cache.counts[index];
+            block = cached;
+        }
+        else {
+            block = ::operator new((index + 1) * class_granularity);
+        }
+    }
+    else {
+        block = ::operator new(block_size);
+    }
+
+    new (block) FrameHeader{arena};
+    return static_cast<std::byte*>(block) + header_size;
+}
+
+void deallocate_frame(void* frame, size_t size) noexcept
+{
+    ++t_stats.deallocations;
+
+    void* block = static_cast<std::byte*>(frame) - header_size;
+    const size_t block_size = size + header_size;
+    if (auto* arena = static_cast<FrameHeader*>(block)->arena) {
+        arena->deallocate(block, block_size, header_size);
+        return;
+    }
+
+    const size_t index = size_class(block_size);
+    if (block_size > max_pooled_block || t_cache.released ||
+        t_cache.counts[index] == max_cached_blocks) {
+        ::operator delete(block);
+        return;
+    }
+
+    // Registers the release of the cache at thread exit.
+    static_cast<void>(&t_releaser);
+    t_cache.heads[index] = new (block) FreeBlock{t_cache.heads[index]};
+    ++t_cache.counts[index];
+}
+
+}  // namespace internal
+
+}  // namespace ez::async
@@ -0,0 +1,130 @@
+#include <ez/async/Scope.hpp>
+
+namespace ez::async::internal {
+
+ScopeState::ScopeState(void* context, Post post, size_t max_active)
+    : m_context{context}, m_post{post}, m_max_active{std::max<size_t>(max_active, 1)}
+{
+}
+
+ScopeState::~ScopeState()
+{
+    for (auto* list : {&m_active, &m_queued}) {
+        while (ScopeTaskPromise* task = list->pop_front()) {
+            CoHandle<ScopeTaskPromise>::from_promise(*task).destroy();
+        }
+    }
+}
+
+bool ScopeState::spawn(CoHandle<ScopeTaskPromise> task, ScopeSpawner* spawner)
+{
+    task.promise().scope = this;
+    {
+        std::lock_guard lock{m_mutex};
+        ++m_stats.spawned;
+        if (m_stats.active == m_max_active) {
+            m_queued.push_back(&task.promise());
+            if (spawner) {
+                task.promise().spawner = spawner;
+                spawner->queued = &task.promise();
+            }
+            ++m_stats.queued;
+            return false;
+        }
+        start_locked(task.promise());
+    }
+
+    m_post(m_context, task);
+    return true;
+}
+
+void ScopeState::start_locked(ScopeTaskPromise& task)
+{
+    m_active.push_back(&task);
+    ++m_stats.active;
+    m_stats.peak_active = std::max(m_stats.peak_active, m_stats.active);
+}
+
+void ScopeState::complete(ScopeTaskPromise& task)
+{
+    ScopeTaskPromise* next = nullptr;
+    CoHandle<> producer;
+    std::vector<CoHandle<>> joiners;
+    {
+        std::lock_guard lock{m_mutex};
+        m_active.remove(&task);
+        --m_stats.active;
+        ++m_stats.completed;
+        if (task.error) {
+            ++m_stats.failed;
+            if (m_errors.size() < max_errors) m_errors.push_back(std::move(task.error));
+        }
+
+        if ((next = m_queued.pop_front())) {
+            --m_stats.queued;
+            start_locked(*next);
+            if (ScopeSpawner* spawner = std::exchange(next->spawner, nullptr)) {
+                spawner->queued = nullptr;
+                producer = spawner->producer;
+            }
+        }
+        else if (m_stats.active == 0) {
+            while (ScopeJoiner* joiner = m_joiners.pop_front()) {
+                joiner->queued = false;
+                joiners.push_back(joiner->continuation);
+            }
+        }
+    }
+
+    // Resumed from the context, the completion may run on another thread. Once something is
+    // posted, a joiner may already have destroyed the scope: nothing of it is read anymore.
+    const Post post = m_post;
+    void* const context = m_context;
+    if (next) post(context, CoHandle<ScopeTaskPromise>::from_promise(*next));
+    if (producer) post(context, producer);
+    for (CoHandle<> joiner : joiners) post(context, joiner);
+}
+
+bool ScopeState::add_joiner(ScopeJoiner& joiner)
+{
+    std::lock_guard lock{m_mutex};
+    if (m_stats.active == 0 && m_stats.queued == 0) return false;
+    m_joiners.push_back(&joiner);
+    joiner.queued = true;
+    return true;
+}
+
+void ScopeState::remove_joiner(ScopeJoiner& joiner)
+{
+    std::lock_guard lock{m_mutex};
+    if (!joiner.queued) return;
+    m_joiners.remove(&joiner);
+    joiner.queued = false;
+}
+
+void ScopeState::remove_spawner(ScopeSpawner& spawner)
+{
+    std::lock_guard lock{m_mutex};
+    if (spawner.queued) spawner.queued->spawner = nullptr;
+    spawner.queued = nullptr;
+}
+
+bool ScopeState::is_idle() const
+{
+    std::lock_guard lock{m_mutex};
+    return m_stats.active == 0 && m_stats.queued == 0;
+}
+
+ScopeStats ScopeState::stats() const
+{
+    std::lock_guard lock{m_mutex};
+    return m_stats;
+}
+
+std::vector<std::exception_ptr> ScopeState::take_errors()
+{
+    std::lock_guard lock{m_mutex};
+    return std::exchange(m_errors, {});
+}
+
+}  // namespace ez::async::internal
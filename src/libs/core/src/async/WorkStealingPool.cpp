@@ -0,0 +1,196 @@
+#include <ez/async/WorkStealingPool.hpp>
+
+#include <algorithm>
+
+namespace ez::async {
+
+namespace {
+
+// Consecutive jobs taken from the LIFO slot before the deque gets a chance, a chain of
+// continuations must not starve the other jobs.
+constexpr size_t max_lifo_streak = 16;
+
+// Rounds of job search before parking.
+constexpr size_t spin_count = 64;
+
+}  // namespace
+
+struct WorkStealingPool::Worker {
+    WorkStealingPool* pool = nullptr;
+    size_t index = 0;
+
+    ChaseLevDeque<Job*> deque;
+    Job* lifo_slot = nullptr;
+    size_t lifo_streak = 0;
+    u64 random_state = 0;
+
+    std::thread thread;
+
+    // xorshift, picks the first victim to steal from.
+    size_t next_random(size_t bound)
+    {
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 7;
+        random_state ^= random_state << 17;
+        return size_t(random_state % bound);
+    }
+};
+
+thread_local WorkStealingPool::Worker* WorkStealingPool::s_current_worker = nullptr;
+
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+{
+    thread_count = std::max<size_t>(thread_count, 1);
+    m_workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->pool = this;
+        worker->index = i;
+        worker->random_state = 0x9E3779B97F4A7C15ull * (i + 1);
+        m_workers.push_back(std::move(worker));
+    }
+    // Started once every deque exists, the workers steal from each other.
+    for (auto& worker : m_workers) {
+        worker->thread = std::thread{[this, &worker = *worker] { run(worker); }};
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    m_stopping.store(true, std::memory_order::seq_cst);
+    m_wake_epoch.fetch_add(1, std::memory_order::seq_cst);
+    m_wake_epoch.notify_all();
+
+    for (auto& worker : m_workers) worker->thread.join();
+
+    // Jobs posted from outside while the last workers were exiting. They may post in turn: the
+    // jobs are taken one at a time and run outside of the lock.
+    while (true) {
+        Job* job = nullptr;
+        {
+            std::lock_guard lock{m_injection_mutex};
+            if (m_injection.empty()) break;
+            job = m_injection.front();
+            m_injection.pop_front();
+            m_injection_size.fetch_sub(1, std::memory_order::relaxed);
+        }
+        job->run_and_delete(job);
+    }
+}
+
+bool WorkStealingPool::is_worker_thread() const noexcept
+{
+    return s_current_worker != nullptr && s_current_worker->pool == this;
+}
+
+void WorkStealingPool::submit(Job* job)
+{
+    if (Worker* worker = s_current_worker; worker != nullptr && worker->pool == this) {
+        Job* previous = std::exchange(worker->lifo_slot, job);
+        if (previous == nullptr) return;  // The worker runs it next, nothing to steal.
+        worker->deque.push(previous);
+    }
+    else {
+        std::lock_guard lock{m_injection_mutex};
+        m_injection.push_back(job);
+        m_injection_size.fetch_add(1, std::memory_order::relaxed);
+    }
+    wake_one();
+}
+
+// Pairs with the park sequence in run: either the sleeping count is seen here, or the new job
+// is seen by the worker before it waits.
+void WorkStealingPool::wake_one()
+{
+    std::atomic_thread_fence(std::memory_order::seq_cst);
+    if (m_sleeping.load(std::memory_order::relaxed) == 0) return;
+
+    m_wake_epoch.fetch_add(1, std::memory_order::release);
+    m_wake_epoch.notify_one();
+}
+
+bool WorkStealingPool::has_stealable_jobs() const
+{
+    if (m_injection_size.load(std::memory_order::relaxed) != 0) return true;
+    return std::ranges::any_of(m_workers,
+                               [](const auto& worker) { return !worker->deque.empty(); });
+}
+
+void WorkStealingPool::run(Worker& worker)
+{
+    s_current_worker = &worker;
+
+    while (true) {
+        Job* job = nullptr;
+        for (size_t i = 0; i < spin_count && job == nullptr; ++i) {
+            job = find_job(worker);
+            if (job == nullptr && i != 0) std::this_thread::yield();
+        }
+
+        if (job != nullptr) {
+            job->run_and_delete(job);
+            continue;
+        }
+
+        const u32 epoch = m_wake_epoch.load(std::memory_order::acquire);
+        m_sleeping.fetch_add(1, std::memory_order::seq_cst);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+
+        if (has_stealable_jobs()) {
+            m_sleeping.fetch_sub(1, std::memory_order::relaxed);
+            continue;
+        }
+        if (m_stopping.load(std::memory_order::seq_cst)) {
+            m_sleeping.fetch_sub(1, std::memory_order::relaxed);
+            break;
+        }
+
+        m_wake_epoch.wait(epoch, std::memory_order::acquire);
+        m_sleeping.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    s_current_worker = nullptr;
+}
+
+auto WorkStealingPool::find_job(Worker& worker) -> Job*
+{
+    if (worker.lifo_slot != nullptr) {
+        if (worker.lifo_streak++ < max_lifo_streak) return std::exchange(worker.lifo_slot, nullptr);
+
+        // The streak is over, the oldest job of the deque runs first.
+        worker.lifo_streak = 0;
+        worker.deque.push(std::exchange(worker.lifo_slot, nullptr));
+        if (Job* job = worker.deque.steal()) return job;
+    }
+    worker.lifo_streak = 0;
+
+    if (Job* job = worker.deque.pop()) return job;
+
+    if (m_injection_size.load(std::memory_order::relaxed) != 0) {
+        std::lock_guard lock{m_injection_mutex};
+        if (!m_injection.empty()) {
+            Job* job = m_injection.front();
+            m_injection.pop_front();
+            m_injection_size.fetch_sub(1, std::memory_order::relaxed);
+            return job;
+        }
+    }
+
+    return steal(worker);
+}
+
+auto WorkStealingPool::steal(Worker& worker) -> Job*
+{
+    const size_t count = m_workers.size();
+    if (count == 1) return nullptr;
+
+    const size_t start = worker.next_random(count);
+    for (size_t i = 0; i < count; ++i) {
+        Worker& victim = *m_workers[(start + i) % count];
+        if (&victim == &worker) continue;
+        if (Job* job = victim.deque.steal()) return job;
+    }
+    return nullptr;
+}
+
+}  // namespace ez::async
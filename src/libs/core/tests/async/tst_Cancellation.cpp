@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/Operation.hpp>
+#include <ez/async/Task.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WhenAll.hpp>
+#include <ez/async/WhenAny.hpp>
+
+#include <functional>
+#include <thread>
+
+using namespace ez;
+
+namespace {
+
+// Completes when `complete` or `cancel` is called, records the cancellations.
+struct ManualOp {
+    std::function<void()>& complete;
+    int& cancel_count;
+    bool cancelled = false;
+
+    bool done() const { return false; }
+    void start(auto continuation) { complete = std::move(continuation); }
+    void cancel()
+    {
+        ++cancel_count;
+        cancelled = true;
+        if (complete) std::exchange(complete, nullptr)();
+    }
+    int result()
+    {
+        if (cancelled) throw async::OperationCancelled{};
+        return 42;
+    }
+};
+
+async::Operation<ManualOp> manual_op(std::function<void()>& complete, int& cancel_count)
+{
+    return {complete, cancel_count};
+}
+
+async::Task<int> wait_for_cancellation()
+{
+    auto token = co_await async::current_cancellation_token();
+    co_await token;
+    co_return 0;
+}
+
+async::Task<int> immediate(int value) { co_return value; }
+
+}  // namespace
+
+TEST(Cancellation, default_token)
+{
+    async::CancellationToken token;
+    ASSERT_FALSE(token.can_be_cancelled());
+    ASSERT_FALSE(token.is_cancellation_requested());
+    ASSERT_NO_THROW(token.throw_if_cancellation_requested());
+}
+
+TEST(Cancellation, callbacks)
+{
+    async::CancellationSource source;
+    auto token = source.token();
+    ASSERT_TRUE(token.can_be_cancelled());
+
+    int called = 0;
+    async::CancellationCallback registered{token, [&] { ++called; }};
+    {
+        async::CancellationCallback unregistered{token, [&] { called += 10; }};
+    }
+
+    ASSERT_TRUE(source.request_cancellation());
+    ASSERT_FALSE(source.request_cancellation());
+    ASSERT_EQ(called, 1);
+    ASSERT_TRUE(token.is_cancellation_requested());
+    ASSERT_THROW(token.throw_if_cancellation_requested(), async::OperationCancelled);
+
+    async::CancellationCallback late{token, [&] { ++called; }};
+    ASSERT_EQ(called, 2);
+}
+
+TEST(Cancellation, await_token)
+{
+    async::CancellationSource source;
+    std::jthread canceller{[&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        source.request_cancellation();
+    }};
+
+    ASSERT_EQ(async::sync_wait(wait_for_cancellation().with_cancellation(source.token())), 0);
+}
+
+TEST(Cancellation, tasks_inherit_the_token)
+{
+    async::CancellationSource source;
+    source.request_cancellation();
+
+    auto inner = []() -> async::Task<bool> {
+        auto token = co_await async::current_cancellation_token();
+        co_return token.is_cancellation_requested();
+    };
+    auto outer = [&]() -> async::Task<bool> {
+        auto [first, second] = co_await async::when_all(inner(), inner());
+        co_return first && second && co_await inner();
+    };
+
+    ASSERT_TRUE(async::sync_wait(outer().with_cancellation(source.token())));
+    ASSERT_FALSE(async::sync_wait(outer()));
+}
+
+TEST(Cancellation, when_any_cancels_the_losers)
+{
+    auto result = async::sync_wait(async::when_any(wait_for_cancellation(), immediate(7)));
+    ASSERT_EQ(result, 7);
+
+    std::function<void()> complete;
+    int cancel_count = 0;
+    result = async::sync_wait(async::when_any(manual_op(complete, cancel_count), immediate(8)));
+    ASSERT_EQ(result, 8);
+    ASSERT_EQ(cancel_count, 1);
+}
+
+TEST(Cancellation, operation)
+{
+    std::function<void()> complete;
+    int cancel_count = 0;
+
+    async::CancellationSource source;
+    auto task = [&]() -> async::Task<int> {
+        try {
+            co_return co_await manual_op(complete, cancel_count);
+        }
+        catch (const async::OperationCancelled&) {
+            co_return -1;
+        }
+    };
+
+    // Cancelled before the start: the operation is cancelled right after it.
+    source.request_cancellation();
+    ASSERT_EQ(async::sync_wait(task().with_cancellation(source.token())), -1);
+    ASSERT_EQ(cancel_count, 1);
+
+    // Completed normally, the later cancellation is not forwarded.
+    async::CancellationSource other;
+    auto running = task().with_cancellation(other.token());
+    running.resume();
+    ASSERT_FALSE(running.done());
+    std::exchange(complete, nullptr)();
+    ASSERT_TRUE(running.done());
+    other.request_cancellation();
+    ASSERT_EQ(cancel_count, 1);
+}
+
+TEST(Cancellation, destroyed_operation_is_cancelled)
+{
+    std::function<void()> complete;
+    int cancel_count = 0;
+    bool resumed = false;
+
+    auto task = [&]() -> async::Task<> {
+        co_await manual_op(complete, cancel_count);
+        resumed = true;
+    };
+
+    {
+        auto pending = task();
+        pending.resume();
+    }
+    ASSERT_EQ(cancel_count, 1);
+    ASSERT_FALSE(resumed);
+}
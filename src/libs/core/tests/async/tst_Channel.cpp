@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/Channel.hpp>
+#include <ez/async/Schedule.hpp>
+#include <ez/async/Task.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WhenAll.hpp>
+#include <ez/async/WhenAny.hpp>
+#include <ez/async/WorkStealingPool.hpp>
+
+#include <ez/Option.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace ez;
+
+namespace {
+
+// Returns the number of values sent, when_all does not take void tasks.
+template <typename C>
+async::Task<int> produce(C& channel, int first, int count, bool close = true)
+{
+    int sent = 0;
+    for (int i = first; i < first + count; ++i) sent += co_await channel.send(i);
+    if (close) channel.close();
+    co_return sent;
+}
+
+template <typename C>
+async::Task<std::vector<int>> consume(C& channel)
+{
+    std::vector<int> values;
+    while (auto value = co_await channel.receive()) values.push_back(*value);
+    co_return values;
+}
+
+}  // namespace
+
+TEST(Channel, send_receive)
+{
+    async::Channel<int> channel{2};
+    auto [sent, values] = async::sync_wait(async::when_all(produce(channel, 0, 100),
+                                                           consume(channel)));
+    ASSERT_EQ(sent, 100);
+    ASSERT_EQ(values.size(), 100u);
+    for (int i = 0; i < 100; ++i) ASSERT_EQ(values[size_t(i)], i);
+}
+
+TEST(Channel, close)
+{
+    async::Channel<int> channel{4};
+    int value = 1;
+    ASSERT_TRUE(channel.try_send(value));
+    value = 2;
+    ASSERT_TRUE(channel.try_send(value));
+    channel.close();
+
+    ASSERT_TRUE(channel.is_closed());
+    value = 3;
+    ASSERT_FALSE(channel.try_send(value));
+    ASSERT_FALSE(async::sync_wait([&]() -> async::Task<bool> {
+        co_return co_await channel.send(4);
+    }()));
+    ASSERT_EQ(async::sync_wait(consume(channel)), (std::vector<int>{1, 2}));
+    ASSERT_FALSE(channel.try_receive());
+}
+
+TEST(Channel, select)
+{
+    async::Channel<int> numbers{1};
+    async::Channel<std::string> names{1};
+
+    auto select = [&]() -> async::Task<OneOf<Option<int>, Option<std::string>>> {
+        co_return co_await async::when_any(numbers.receive(), names.receive());
+    };
+
+    // Suspended on both, the receive on names is withdrawn once numbers won.
+    auto task = select();
+    task.resume();
+    ASSERT_FALSE(task.done());
+    int number = 10;
+    ASSERT_TRUE(numbers.try_send(number));
+    ASSERT_TRUE(task.done());
+    task = select();
+
+    std::string name = "name";
+    ASSERT_TRUE(names.try_send(name));
+    ASSERT_EQ(names.size(), 1u);
+
+    // Both ready, only the first one is consumed.
+    number = 11;
+    ASSERT_TRUE(numbers.try_send(number));
+    auto result = async::sync_wait(select());
+    ASSERT_TRUE(result.is<Option<int>>());
+    ASSERT_EQ(result.as<Option<int>>(), 11);
+    ASSERT_EQ(names.size(), 1u);
+}
+
+TEST(Channel, receive_destroyed_once_woken_up)
+{
+    async::Channel<int> channel{1};
+    Option<async::Task<int>> victim;
+
+    auto receive = [&]() -> async::Task<int> {
+        co_await channel.receive();
+        co_return 0;
+    };
+    auto destroy_victim = [&]() -> async::Task<int> {
+        co_await channel.receive();
+        victim.reset();
+        co_return 0;
+    };
+
+    // Both woken up by the close, the first one destroys the second before its resumption.
+    auto first = destroy_victim();
+    first.resume();
+    victim.emplace(receive());
+    victim->resume();
+    channel.close();
+
+    ASSERT_TRUE(first.done());
+    ASSERT_FALSE(victim);
+}
+
+TEST(Channel, multiple_producers_and_consumers)
+{
+    constexpr int producer_count = 4;
+    constexpr int count = 10'000;
+
+    async::WorkStealingPool pool{4};
+    async::Channel<int> channel{16};
+    std::atomic<int> running_producers = producer_count;
+
+    auto producer = [&](int first) -> async::Task<int> {
+        co_await async::schedule_on(pool);
+        int sent = co_await produce(channel, first, count, false);
+        if (--running_producers == 0) channel.close();
+        co_return sent;
+    };
+    auto consumer = [&]() -> async::Task<std::vector<int>> {
+        co_await async::schedule_on(pool);
+        co_return co_await consume(channel);
+    };
+
+    auto [p0, p1, p2, p3, c0, c1] = async::sync_wait(
+        async::when_all(producer(0), producer(count), producer(2 * count), producer(3 * count),
+                        consumer(), consumer()));
+
+    ASSERT_EQ(p0 + p1 + p2 + p3, producer_count * count);
+    std::vector<int> values = c0;
+    values.insert(values.end(), c1.begin(), c1.end());
+    std::ranges::sort(values);
+    ASSERT_EQ(values.size(), size_t(producer_count * count));
+    for (int i = 0; i < producer_count * count; ++i) ASSERT_EQ(values[size_t(i)], i);
+}
+
+TEST(SpscChannel, send_receive)
+{
+    async::SpscChannel<int> channel{4};
+    auto [sent, values] = async::sync_wait(async::when_all(produce(channel, 0, 100),
+                                                           consume(channel)));
+    ASSERT_EQ(sent, 100);
+    ASSERT_EQ(values.size(), 100u);
+    for (int i = 0; i < 100; ++i) ASSERT_EQ(values[size_t(i)], i);
+}
+
+TEST(SpscChannel, threads)
+{
+    constexpr int count = 100'000;
+
+    async::WorkStealingPool pool{2};
+    async::SpscChannel<int> channel{64};
+
+    auto producer = [&]() -> async::Task<int> {
+        co_await async::schedule_on(pool);
+        co_return co_await produce(channel, 0, count);
+    };
+    auto consumer = [&]() -> async::Task<std::vector<int>> {
+        co_await async::schedule_on(pool);
+        co_return co_await consume(channel);
+    };
+
+    auto [sent, values] = async::sync_wait(async::when_all(producer(), consumer()));
+    ASSERT_EQ(sent, count);
+    ASSERT_EQ(values.size(), size_t(count));
+    for (int i = 0; i < count; ++i) ASSERT_EQ(values[size_t(i)], i);
+}
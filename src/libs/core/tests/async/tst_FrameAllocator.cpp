@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/Task.hpp>
+#include <ez/async/Wait.hpp>
+
+#include <array>
+#include <memory_resource>
+
+using namespace ez;
+
+namespace {
+
+async::Task<int> square(int value)
+{
+    co_return value * value;
+}
+
+async::Task<int> sum_of_squares(int count)
+{
+    int sum = 0;
+    for (int i = 1; i <= count; ++i) sum += co_await square(i);
+    co_return sum;
+}
+
+async::Task<int> square_in(std::allocator_arg_t, std::pmr::memory_resource*, int value)
+{
+    co_return value * value;
+}
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocated = 0;
+    size_t deallocated = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocated;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        ++deallocated;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+}  // namespace
+
+TEST(FrameAllocator, pooled)
+{
+    async::release_cached_frames();
+    async::reset_frame_allocation_stats();
+
+    ASSERT_EQ(async::sync_wait(sum_of_squares(10)), 385);
+
+    auto stats = async::frame_allocation_stats();
+    ASSERT_EQ(stats.allocations, 11u);
+    ASSERT_EQ(stats.deallocations, 11u);
+    // The frame of the first square is reused by the following ones.
+    ASSERT_EQ(stats.pooled, 9u);
+    ASSERT_GT(stats.bytes, 0u);
+
+    async::reset_frame_allocation_stats();
+    ASSERT_EQ(async::sync_wait(sum_of_squares(10)), 385);
+    ASSERT_EQ(async::frame_allocation_stats().pooled, 11u);
+}
+
+TEST(FrameAllocator, arena)
+{
+    async::reset_frame_allocation_stats();
+
+    CountingResource resource;
+    {
+        auto task = square_in(std::allocator_arg, &resource, 7);
+        ASSERT_EQ(resource.allocated, 1u);
+        ASSERT_EQ(async::sync_wait(std::move(task)), 49);
+    }
+    ASSERT_EQ(resource.deallocated, 1u);
+
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(),
+                                              std::pmr::null_memory_resource()};
+    ASSERT_EQ(async::sync_wait(square_in(std::allocator_arg, &arena, 3)), 9);
+
+    auto stats = async::frame_allocation_stats();
+    ASSERT_EQ(stats.allocations, 2u);
+    ASSERT_EQ(stats.arena, 2u);
+    ASSERT_EQ(stats.deallocations, 2u);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/AsyncGenerator.hpp>
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/Generator.hpp>
+#include <ez/async/Schedule.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WorkStealingPool.hpp>
+
+#include <ez/rpl/All.hpp>
+
+#include <ez/Lambda.hpp>
+
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ez;
+using namespace ez::lambda::args;
+
+namespace {
+
+async::Generator<int> iota(int count)
+{
+    for (int i = 0; i < count; ++i) co_yield i;
+}
+
+async::Generator<int> naturals()
+{
+    for (int i = 0;; ++i) co_yield i;
+}
+
+async::Generator<std::string> words()
+{
+    std::string word = "lvalue";
+    co_yield word;  // Copied in the frame.
+    co_yield std::string{"rvalue"};
+}
+
+async::AsyncGenerator<int> async_iota(int count)
+{
+    for (int i = 0; i < count; ++i) co_yield i;
+}
+
+}  // namespace
+
+static_assert(std::ranges::input_range<async::Generator<int>>);
+static_assert(std::ranges::view<async::Generator<int>>);
+
+TEST(Generator, range)
+{
+    std::vector<int> values;
+    for (int value : iota(5)) values.push_back(value);
+    ASSERT_EQ(values, (std::vector{0, 1, 2, 3, 4}));
+
+    values.clear();
+    for (int value : naturals() | std::views::take(3)) values.push_back(value);
+    ASSERT_EQ(values, (std::vector{0, 1, 2}));
+
+    std::vector<std::string> moved;
+    for (auto&& word : words()) moved.push_back(std::move(word));
+    ASSERT_EQ(moved, (std::vector<std::string>{"lvalue", "rvalue"}));
+}
+
+TEST(Generator, references)
+{
+    std::vector<int> values{1, 2, 3};
+    auto elements = [](std::vector<int>& values) -> async::Generator<int&> {
+        for (int& value : values) co_yield value;
+    };
+
+    for (int& value : elements(values)) value *= 10;
+    ASSERT_EQ(values, (std::vector{10, 20, 30}));
+}
+
+TEST(Generator, rpl)
+{
+    auto result = rpl::run(iota(10), rpl::filter(arg1 % 2 == 0), rpl::to_vector());
+    ASSERT_EQ(result, (std::vector{0, 2, 4, 6, 8}));
+}
+
+TEST(Generator, exceptions)
+{
+    auto failing = []() -> async::Generator<int> {
+        co_yield 1;
+        throw std::runtime_error{"failure"};
+    };
+
+    auto generator = failing();
+    auto it = generator.begin();
+    ASSERT_EQ(*it, 1);
+    ASSERT_THROW(++it, std::runtime_error);
+}
+
+TEST(Generator, single_allocation)
+{
+    async::reset_frame_allocation_stats();
+    long sum = 0;
+    for (int value : iota(10'000)) sum += value;
+
+    ASSERT_EQ(sum, 10'000l * 9'999 / 2);
+    ASSERT_EQ(async::frame_allocation_stats().allocations, 1);
+}
+
+TEST(AsyncGenerator, next)
+{
+    auto consumer = []() -> async::Task<int> {
+        auto generator = async_iota(5);
+        int sum = 0;
+        while (co_await generator.next()) sum += generator.value();
+        co_return sum;
+    };
+
+    ASSERT_EQ(async::sync_wait(consumer()), 10);
+}
+
+TEST(AsyncGenerator, for_each)
+{
+    async::WorkStealingPool pool{2};
+
+    // Switches threads between the elements.
+    auto remote = [&](int count) -> async::AsyncGenerator<std::unique_ptr<int>> {
+        for (int i = 0; i < count; ++i) {
+            co_await async::schedule_on(pool);
+            co_yield std::make_unique<int>(i);
+        }
+    };
+
+    auto consumer = [&]() -> async::Task<int> {
+        std::vector<std::unique_ptr<int>> values;
+        co_await async::for_each(remote(100), [&](auto& value) {
+            values.push_back(std::move(value));
+        });
+        co_await async::for_each(remote(10), [&](auto& value) -> async::Task<> {
+            co_await async::schedule_on(pool);
+            values.push_back(std::move(value));
+        });
+        co_return int(values.size());
+    };
+
+    ASSERT_EQ(async::sync_wait(consumer()), 110);
+}
+
+TEST(AsyncGenerator, exceptions_and_cancellation)
+{
+    auto failing = []() -> async::AsyncGenerator<int> {
+        co_yield 1;
+        throw std::runtime_error{"failure"};
+    };
+    auto consume_all = [](async::AsyncGenerator<int> generator) -> async::Task<int> {
+        int count = 0;
+        while (co_await generator.next()) ++count;
+        co_return count;
+    };
+
+    ASSERT_THROW(async::sync_wait(consume_all(failing())), std::runtime_error);
+
+    auto until_cancelled = []() -> async::AsyncGenerator<int> {
+        auto token = co_await async::current_cancellation_token();
+        for (int i = 0; !token.is_cancellation_requested(); ++i) co_yield i;
+    };
+
+    async::CancellationSource source;
+    source.request_cancellation();
+    ASSERT_EQ(async::sync_wait(consume_all(until_cancelled()).with_cancellation(source.token())),
+              0);
+}
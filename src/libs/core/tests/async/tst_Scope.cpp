@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/Schedule.hpp>
+#include <ez/async/Scope.hpp>
+#include <ez/async/Synchronization.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WorkStealingPool.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace ez;
+
+namespace {
+
+// Runs the posted jobs on demand, on the calling thread.
+struct JobQueue {
+    std::deque<std::function<void()>> jobs;
+
+    void run()
+    {
+        while (!jobs.empty()) {
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            job();
+        }
+    }
+};
+
+}  // namespace
+
+template <>
+struct ez::async::Executor<JobQueue> {
+    static void post(JobQueue& queue, auto&& task) { queue.jobs.emplace_back(EZ_FWD(task)); }
+};
+
+TEST(Scope, queues_over_the_limit)
+{
+    JobQueue queue;
+    async::AsyncEvent release;
+    std::vector<int> started;
+
+    auto work = [&](int id) -> async::Task<> {
+        started.push_back(id);
+        co_await release.wait();
+    };
+
+    async::Scope scope{queue, 2};
+    for (int id = 0; id < 5; ++id) scope << work(id);
+    queue.run();
+
+    ASSERT_EQ(started, (std::vector{0, 1}));
+    auto stats = scope.stats();
+    ASSERT_EQ(stats.spawned, 5);
+    ASSERT_EQ(stats.active, 2);
+    ASSERT_EQ(stats.queued, 3);
+
+    release.set();
+    queue.run();
+
+    ASSERT_EQ(started, (std::vector{0, 1, 2, 3, 4}));
+    stats = scope.stats();
+    ASSERT_EQ(stats.active, 0);
+    ASSERT_EQ(stats.queued, 0);
+    ASSERT_EQ(stats.completed, 5);
+    ASSERT_EQ(stats.peak_active, 2);
+}
+
+TEST(Scope, spawn_suspends_the_producer)
+{
+    JobQueue queue;
+    async::AsyncEvent release{async::ResetMode::Auto};
+    async::Scope scope{queue, 1};
+    int spawned = 0;
+    bool joined = false;
+
+    auto work = [&]() -> async::Task<> { co_await release.wait(); };
+    auto producer = [&]() -> async::Task<> {
+        for (int i = 0; i < 3; ++i) {
+            co_await scope.spawn(work());
+            ++spawned;
+        }
+        co_await scope.join();
+        joined = true;
+    };
+
+    auto running = producer();
+    running.resume();
+    queue.run();
+    ASSERT_EQ(spawned, 1);  // The second task waits for the first one.
+
+    release.set();
+    queue.run();
+    ASSERT_EQ(spawned, 2);
+
+    release.set();
+    queue.run();
+    ASSERT_EQ(spawned, 3);
+    ASSERT_FALSE(joined);
+
+    release.set();
+    queue.run();
+    ASSERT_TRUE(joined);
+    ASSERT_TRUE(running.done());
+}
+
+TEST(Scope, errors)
+{
+    JobQueue queue;
+    async::Scope scope{queue};
+
+    auto work = [](bool fail) -> async::Task<> {
+        if (fail) throw std::runtime_error{"failure"};
+        co_return;
+    };
+
+    scope << work(false) << work(true) << work(true);
+    queue.run();
+
+    auto stats = scope.stats();
+    ASSERT_EQ(stats.completed, 3);
+    ASSERT_EQ(stats.failed, 2);
+
+    auto errors = scope.take_errors();
+    ASSERT_EQ(errors.size(), 2);
+    ASSERT_THROW(std::rethrow_exception(errors.front()), std::runtime_error);
+    ASSERT_TRUE(scope.take_errors().empty());
+
+    // Only the first errors are kept until taken.
+    for (int i = 0; i < 100; ++i) scope << work(true);
+    queue.run();
+    ASSERT_EQ(scope.stats().failed, 102);
+    ASSERT_EQ(scope.take_errors().size(), 64);
+}
+
+TEST(Scope, destroys_pending_tasks)
+{
+    JobQueue queue;
+    async::AsyncEvent never;
+    int destroyed = 0;
+
+    auto work = [&]() -> async::Task<> {
+        struct Counter {
+            int& count;
+            ~Counter() { ++count; }
+        } counter{destroyed};
+        co_await never.wait();
+    };
+
+    {
+        async::Scope scope{queue, 1};
+        scope << work() << work();
+        queue.run();
+        ASSERT_EQ(destroyed, 0);
+    }
+    ASSERT_EQ(destroyed, 1);  // The queued task never started.
+}
+
+TEST(Scope, thread_pool)
+{
+    async::WorkStealingPool pool{4};
+    std::atomic<int> running = 0;
+    std::atomic<int> max_running = 0;
+
+    auto work = [&]() -> async::Task<> {
+        const int now = ++running;
+        int max = max_running.load();
+        while (now > max && !max_running.compare_exchange_weak(max, now)) {}
+        co_await async::schedule_on(pool);
+        --running;
+    };
+
+    async::Scope scope{pool, 3};
+    auto producer = [&]() -> async::Task<int> {
+        for (int i = 0; i < 2000; ++i) co_await scope.spawn(work());
+        co_await scope.join();
+        co_return 0;
+    };
+
+    async::sync_wait(producer());
+
+    auto stats = scope.stats();
+    ASSERT_EQ(stats.spawned, 2000);
+    ASSERT_EQ(stats.completed, 2000);
+    ASSERT_EQ(stats.active, 0);
+    ASSERT_LE(stats.peak_active, 3);
+    ASSERT_LE(max_running.load(), 3);
+}
+
+TEST(Scope, destroyed_by_its_joiner)
+{
+    async::WorkStealingPool pool{4};
+    std::atomic<int> completed = 0;
+
+    auto work = [&]() -> async::Task<> {
+        co_await async::schedule_on(pool);
+        ++completed;
+    };
+
+    // The last completion resumes the joiner on another thread, which frees the scope.
+    for (int round = 0; round < 200; ++round) {
+        auto scope = std::make_unique<async::Scope<async::WorkStealingPool>>(pool, 2);
+        auto joiner = [&]() -> async::Task<int> {
+            for (int i = 0; i < 4; ++i) co_await scope->spawn(work());
+            co_await scope->join();
+            scope.reset();
+            co_return 0;
+        };
+        async::sync_wait(joiner());
+    }
+    ASSERT_EQ(completed.load(), 800);
+}
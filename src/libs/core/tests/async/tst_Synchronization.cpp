@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/Executor.hpp>
+#include <ez/async/Schedule.hpp>
+#include <ez/async/Synchronization.hpp>
+#include <ez/async/Task.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WhenAll.hpp>
+#include <ez/async/WhenAny.hpp>
+#include <ez/async/WorkStealingPool.hpp>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+using namespace ez;
+
+namespace {
+
+struct ManualExecutor {
+    std::vector<std::function<void()>> jobs;
+
+    void run_all()
+    {
+        for (auto& job : std::exchange(jobs, {})) job();
+    }
+};
+
+// Started right away, the caller keeps the task alive until it is done.
+template <typename T>
+async::Task<T> started(async::Task<T> task)
+{
+    task.resume();
+    return task;
+}
+
+}  // namespace
+
+template <>
+struct ez::async::Executor<ManualExecutor> {
+    static void post(ManualExecutor& executor, auto&& job)
+    {
+        executor.jobs.emplace_back(EZ_FWD(job));
+    }
+};
+
+TEST(AsyncMutex, fifo)
+{
+    async::AsyncMutex mutex;
+    std::vector<int> order;
+
+    auto locker = [&](int id) -> async::Task<> {
+        auto lock = co_await mutex.scoped_lock();
+        order.push_back(id);
+    };
+
+    ASSERT_TRUE(mutex.try_lock());
+    auto first = started(locker(1));
+    auto second = started(locker(2));
+    auto third = started(locker(3));
+    ASSERT_TRUE(order.empty());
+    ASSERT_FALSE(mutex.try_lock());
+
+    mutex.unlock();
+    ASSERT_EQ(order, (std::vector<int>{1, 2, 3}));
+    ASSERT_TRUE(third.done());
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST(AsyncMutex, threads)
+{
+    constexpr int count = 10'000;
+    async::WorkStealingPool pool{4};
+    async::AsyncMutex mutex;
+    int counter = 0;
+
+    auto increment = [&]() -> async::Task<int> {
+        co_await async::schedule_on(pool);
+        for (int i = 0; i < count; ++i) {
+            auto lock = co_await mutex.scoped_lock_on(pool);
+            ++counter;
+        }
+        co_return 0;
+    };
+
+    async::sync_wait(async::when_all(increment(), increment(), increment(), increment()));
+    ASSERT_EQ(counter, 4 * count);
+}
+
+TEST(AsyncMutex, when_any_loser_granted_the_lock)
+{
+    async::AsyncMutex mutex;
+    async::AsyncEvent event;
+    ManualExecutor executor;
+    int winner = 0;
+
+    auto locker = [&]() -> async::Task<int> {
+        co_await mutex.lock_on(executor);
+        mutex.unlock();
+        co_return 1;
+    };
+    auto waiter = [&]() -> async::Task<int> {
+        co_await event.wait();
+        co_return 2;
+    };
+    auto race = [&]() -> async::Task<> { winner = co_await async::when_any(locker(), waiter()); };
+
+    ASSERT_TRUE(mutex.try_lock());
+    auto task = started(race());
+    mutex.unlock();  // Handed to the locker, its resumption is posted.
+    event.set();     // The locker loses and is destroyed before being resumed.
+    ASSERT_TRUE(task.done());
+    ASSERT_EQ(winner, 2);
+
+    executor.run_all();
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST(AsyncSemaphore, limits_concurrency)
+{
+    async::WorkStealingPool pool{4};
+    async::AsyncSemaphore semaphore{2};
+    std::atomic<int> running = 0;
+    std::atomic<int> max_running = 0;
+
+    auto work = [&]() -> async::Task<int> {
+        co_await async::schedule_on(pool);
+        for (int i = 0; i < 1000; ++i) {
+            co_await semaphore.acquire_on(pool);
+            const int now = ++running;
+            int max = max_running.load();
+            while (now > max && !max_running.compare_exchange_weak(max, now)) {}
+            --running;
+            semaphore.release();
+        }
+        co_return 0;
+    };
+
+    async::sync_wait(async::when_all(work(), work(), work(), work(), work()));
+    ASSERT_LE(max_running.load(), 2);
+    ASSERT_EQ(semaphore.available(), 2u);
+}
+
+TEST(AsyncSemaphore, release_many)
+{
+    async::AsyncSemaphore semaphore{0};
+    int acquired = 0;
+    auto acquire = [&]() -> async::Task<> {
+        co_await semaphore.acquire();
+        ++acquired;
+    };
+
+    std::vector<async::Task<>> tasks;
+    for (int i = 0; i < 3; ++i) tasks.push_back(started(acquire()));
+    ASSERT_FALSE(semaphore.try_acquire());
+
+    semaphore.release(2);
+    ASSERT_EQ(acquired, 2);
+    semaphore.release(2);
+    ASSERT_EQ(acquired, 3);
+    ASSERT_EQ(semaphore.available(), 1u);
+}
+
+TEST(AsyncSemaphore, when_any_loser_granted_a_permit)
+{
+    async::AsyncSemaphore semaphore{0};
+    int winner = 0;
+
+    auto acquire = [&](int id) -> async::Task<int> {
+        co_await semaphore.acquire();
+        co_return id;
+    };
+    auto race = [&]() -> async::Task<> {
+        winner = co_await async::when_any(acquire(1), acquire(2));
+    };
+
+    auto task = started(race());
+
+    // Both are granted a permit, resuming the first one destroys the second one.
+    semaphore.release(2);
+    ASSERT_TRUE(task.done());
+    ASSERT_EQ(winner, 1);
+    ASSERT_EQ(semaphore.available(), 1u);
+}
+
+TEST(AsyncEvent, manual_reset)
+{
+    async::AsyncEvent event;
+    ManualExecutor executor;
+    int woken = 0;
+
+    auto inline_waiter = [&]() -> async::Task<> {
+        co_await event.wait();
+        ++woken;
+    };
+    auto posted_waiter = [&]() -> async::Task<> {
+        co_await event.wait_on(executor);
+        ++woken;
+    };
+
+    auto a = started(inline_waiter());
+    auto b = started(posted_waiter());
+    event.set();
+    ASSERT_EQ(woken, 1);
+    ASSERT_EQ(executor.jobs.size(), 1u);
+    executor.run_all();
+    ASSERT_EQ(woken, 2);
+
+    // Stays set.
+    auto c = started(inline_waiter());
+    ASSERT_EQ(woken, 3);
+    event.reset();
+    ASSERT_FALSE(event.is_set());
+}
+
+TEST(AsyncEvent, auto_reset)
+{
+    async::AsyncEvent event{async::ResetMode::Auto};
+    int woken = 0;
+    auto waiter = [&]() -> async::Task<> {
+        co_await event.wait();
+        ++woken;
+    };
+
+    auto a = started(waiter());
+    auto b = started(waiter());
+    event.set();
+    ASSERT_EQ(woken, 1);
+    ASSERT_FALSE(event.is_set());
+    event.set();
+    ASSERT_EQ(woken, 2);
+
+    event.set();
+    ASSERT_TRUE(event.is_set());
+    auto c = started(waiter());
+    ASSERT_EQ(woken, 3);
+    ASSERT_FALSE(event.is_set());
+}
+
+TEST(AsyncEvent, destroyed_waiter)
+{
+    async::AsyncEvent event;
+    int woken = 0;
+    auto waiter = [&]() -> async::Task<> {
+        co_await event.wait();
+        ++woken;
+    };
+
+    {
+        auto abandoned = started(waiter());
+    }
+    auto kept = started(waiter());
+    event.set();
+    ASSERT_EQ(woken, 1);
+}
+
+TEST(AsyncLatch, count_down)
+{
+    async::AsyncLatch latch{3};
+    bool released = false;
+    auto waiter = [&]() -> async::Task<> {
+        co_await latch.wait();
+        released = true;
+    };
+
+    auto task = started(waiter());
+    latch.count_down();
+    latch.count_down();
+    ASSERT_FALSE(released);
+    ASSERT_FALSE(latch.try_wait());
+    latch.count_down();
+    ASSERT_TRUE(released);
+    ASSERT_TRUE(latch.try_wait());
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/Schedule.hpp>
+#include <ez/async/Task.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WhenAll.hpp>
+#include <ez/async/WhenAny.hpp>
+#include <ez/async/WhenN.hpp>
+#include <ez/async/WorkStealingPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+using namespace ez;
+
+namespace {
+
+async::Task<int> immediate(int value) { co_return value; }
+
+async::Task<int> failure()
+{
+    throw std::runtime_error{"failure"};
+    co_return 0;
+}
+
+// Completes with OperationCancelled once the awaiting when_* cancels it.
+async::Task<int> never()
+{
+    auto token = co_await async::current_cancellation_token();
+    co_await token;
+    throw async::OperationCancelled{};
+}
+
+}  // namespace
+
+TEST(WhenAllRange, results_in_order)
+{
+    std::vector<async::Task<int>> tasks;
+    for (int i = 0; i < 100; ++i) tasks.push_back(immediate(i));
+
+    auto results = async::sync_wait(async::when_all(std::move(tasks)));
+    ASSERT_EQ(results.size(), 100);
+    for (int i = 0; i < 100; ++i) ASSERT_EQ(results[i], i);
+}
+
+TEST(WhenAllRange, lvalue_and_views)
+{
+    auto task = []() -> async::Task<int> {
+        std::vector<async::Task<int>> tasks;
+        tasks.push_back(immediate(1));
+        tasks.push_back(immediate(2));
+        auto in_place = co_await async::when_all(tasks);
+
+        auto doubled = co_await async::when_all(std::views::iota(0, 10) |
+                                                std::views::transform([](int i) {
+                                                    return immediate(2 * i);
+                                                }));
+
+        auto empty = co_await async::when_all(std::vector<async::Task<int>>{});
+
+        co_return std::accumulate(in_place.begin(), in_place.end(), 0) +
+            std::accumulate(doubled.begin(), doubled.end(), 0) + int(empty.size());
+    };
+
+    ASSERT_EQ(async::sync_wait(task()), 3 + 90);
+}
+
+TEST(WhenAllRange, thread_pool)
+{
+    async::WorkStealingPool pool{4};
+
+    auto square = [&](int i) -> async::Task<int> {
+        co_await async::schedule_on(pool);
+        co_return i * i;
+    };
+
+    std::vector<async::Task<int>> tasks;
+    for (int i = 0; i < 1000; ++i) tasks.push_back(square(i));
+
+    auto results = async::sync_wait(async::when_all(std::move(tasks)));
+    for (int i = 0; i < 1000; ++i) ASSERT_EQ(results[i], i * i);
+}
+
+TEST(WhenAllRange, rethrows)
+{
+    std::vector<async::Task<int>> tasks;
+    tasks.push_back(immediate(1));
+    tasks.push_back(failure());
+
+    ASSERT_THROW(async::sync_wait(async::when_all(std::move(tasks))), std::runtime_error);
+}
+
+TEST(WhenRange, void_awaitables)
+{
+    async::WorkStealingPool pool{4};
+    std::atomic<int> completed = 0;
+
+    auto work = [&](bool fails) -> async::Task<> {
+        co_await async::schedule_on(pool);
+        if (fails) throw std::runtime_error{"failure"};
+        ++completed;
+    };
+    // `count` tasks, the first one fails when `first_fails`.
+    auto works = [&](int count, bool first_fails) {
+        std::vector<async::Task<>> tasks;
+        for (int i = 0; i < count; ++i) tasks.push_back(work(first_fails && i == 0));
+        return tasks;
+    };
+
+    auto task = [&]() -> async::Task<int> {
+        co_await async::when_all(works(4, false));
+        EXPECT_EQ(completed, 4);
+
+        std::vector<size_t> indexes = co_await async::when_n(2, works(3, true));
+        std::ranges::sort(indexes);
+        EXPECT_EQ(indexes, (std::vector<size_t>{1, 2}));
+
+        size_t index = co_await async::when_any(works(1, false));
+        EXPECT_EQ(index, 0u);
+
+        EXPECT_THROW(co_await async::when_all(works(2, true)), std::runtime_error);
+        co_return 0;
+    };
+
+    async::sync_wait(task());
+}
+
+TEST(WhenAnyRange, returns_the_index)
+{
+    std::vector<async::Task<int>> tasks;
+    tasks.push_back(never());
+    tasks.push_back(immediate(7));
+    tasks.push_back(never());
+
+    auto [index, value] = async::sync_wait(async::when_any(std::move(tasks)));
+    ASSERT_EQ(index, 1);
+    ASSERT_EQ(value, 7);
+
+    ASSERT_THROW(async::when_any(std::vector<async::Task<int>>{}), std::invalid_argument);
+}
+
+TEST(WhenN, quorum)
+{
+    std::vector<async::Task<int>> tasks;
+    tasks.push_back(never());
+    tasks.push_back(immediate(1));
+    tasks.push_back(failure());
+    tasks.push_back(immediate(3));
+    tasks.push_back(never());
+
+    auto results = async::sync_wait(async::when_n(2, std::move(tasks)));
+    ASSERT_EQ(results.size(), 2);
+    ASSERT_EQ(results[0], std::pair(size_t{1}, 1));
+    ASSERT_EQ(results[1], std::pair(size_t{3}, 3));
+}
+
+TEST(WhenN, thread_pool)
+{
+    async::WorkStealingPool pool{4};
+
+    auto replica = [&](int i) -> async::Task<int> {
+        co_await async::schedule_on(pool);
+        if (i % 2) throw std::runtime_error{"down"};
+        co_return i;
+    };
+
+    for (int round = 0; round < 100; ++round) {
+        auto results = async::sync_wait(
+            async::when_n(5, std::views::iota(0, 20) | std::views::transform(replica)));
+        ASSERT_EQ(results.size(), 5);
+        for (auto& [index, value] : results) ASSERT_EQ(int(index), value);
+    }
+}
+
+TEST(WhenN, not_reached)
+{
+    auto make_tasks = [] {
+        std::vector<async::Task<int>> tasks;
+        tasks.push_back(immediate(1));
+        tasks.push_back(failure());
+        tasks.push_back(failure());
+        return tasks;
+    };
+
+    // The first failure is rethrown once two successes are out of reach.
+    ASSERT_THROW(async::sync_wait(async::when_n(2, make_tasks())), std::runtime_error);
+    ASSERT_THROW(async::sync_wait(async::when_n(4, make_tasks())), async::QuorumNotReached);
+    ASSERT_TRUE(async::sync_wait(async::when_n(0, make_tasks())).empty());
+}
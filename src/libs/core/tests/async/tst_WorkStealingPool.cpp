@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <ez/async/Schedule.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WhenAll.hpp>
+#include <ez/async/WorkStealingPool.hpp>
+
+#include <atomic>
+#include <latch>
+#include <set>
+#include <thread>
+
+using namespace ez;
+
+TEST(WorkStealingPool, post)
+{
+    constexpr size_t count = 100'000;
+    std::atomic<size_t> executed = 0;
+    std::latch finished{count};
+
+    async::WorkStealingPool pool{4};
+    ASSERT_EQ(pool.thread_count(), 4u);
+    ASSERT_FALSE(pool.is_worker_thread());
+
+    for (size_t i = 0; i < count; ++i) {
+        pool.post([&] {
+            executed.fetch_add(1);
+            finished.count_down();
+        });
+    }
+    finished.wait();
+    ASSERT_EQ(executed.load(), count);
+}
+
+TEST(WorkStealingPool, nested_posts_are_stolen)
+{
+    constexpr size_t count = 10'000;
+    std::latch finished{count};
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    async::WorkStealingPool pool{4};
+    pool.post([&] {
+        // Every job is posted from the same worker, the other workers must steal them.
+        for (size_t i = 0; i < count; ++i) {
+            pool.post([&] {
+                {
+                    std::lock_guard lock{mutex};
+                    threads.insert(std::this_thread::get_id());
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds{10});
+                finished.count_down();
+            });
+        }
+    });
+    finished.wait();
+    ASSERT_GT(threads.size(), 1u);
+}
+
+TEST(WorkStealingPool, tasks)
+{
+    async::WorkStealingPool pool{3};
+
+    std::atomic<bool> on_workers = true;
+    auto square = [&](int value) -> async::Task<int> {
+        co_await async::schedule_on(pool);
+        if (!pool.is_worker_thread()) on_workers = false;
+        co_return value * value;
+    };
+    auto sum = [&]() -> async::Task<int> {
+        auto [a, b, c] = co_await async::when_all(square(1), square(2), square(3));
+        co_return a + b + c;
+    };
+    ASSERT_EQ(async::sync_wait(sum()), 14);
+    ASSERT_TRUE(on_workers.load());
+}
+
+TEST(WorkStealingPool, destructor_runs_pending_jobs)
+{
+    std::atomic<size_t> executed = 0;
+    {
+        async::WorkStealingPool pool{2};
+        for (size_t i = 0; i < 1000; ++i) pool.post([&] { executed.fetch_add(1); });
+    }
+    ASSERT_EQ(executed.load(), 1000u);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <ez/ChaseLevDeque.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ez;
+
+TEST(ChaseLevDeque, owner)
+{
+    ChaseLevDeque<size_t> deque{2};
+    ASSERT_TRUE(deque.empty());
+    ASSERT_EQ(deque.pop(), 0u);
+
+    for (size_t i = 1; i <= 10; ++i) deque.push(i);
+    ASSERT_EQ(deque.size(), 10u);
+
+    ASSERT_EQ(deque.pop(), 10u);
+    ASSERT_EQ(deque.steal(), 1u);
+    ASSERT_EQ(deque.pop(), 9u);
+    ASSERT_EQ(deque.steal(), 2u);
+    ASSERT_EQ(deque.size(), 6u);
+}
+
+TEST(ChaseLevDeque, concurrent_steal)
+{
+    constexpr size_t count = 200'000;
+    constexpr size_t thief_count = 3;
+
+    ChaseLevDeque<size_t> deque{16};
+    std::vector<std::atomic<u8>> taken(count + 1);
+    std::atomic<size_t> taken_count = 0;
+    std::atomic<bool> done = false;
+
+    auto take = [&](size_t value) {
+        if (value == 0) return;
+        taken[value].fetch_add(1);
+        taken_count.fetch_add(1);
+    };
+
+    std::vector<std::thread> thieves;
+    for (size_t i = 0; i < thief_count; ++i) {
+        thieves.emplace_back([&] {
+            while (!done.load()) take(deque.steal());
+        });
+    }
+
+    for (size_t i = 1; i <= count; ++i) {
+        deque.push(i);
+        if (i % 3 == 0) take(deque.pop());
+    }
+    while (taken_count.load() != count) take(deque.pop());
+
+    done.store(true);
+    for (auto& thief : thieves) thief.join();
+
+    for (size_t i = 1; i <= count; ++i) ASSERT_EQ(taken[i].load(), 1u) << i;
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <ez/FlatHashMap.hpp>
+
+#include <map>
+#include <random>
+#include <string>
+
+using namespace ez;
+
+TEST(FlatHashMap, insert_find)
+{
+    FlatHashMap<std::string, int> map;
+
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.find("a"), map.end());
+
+    map["a"] = 1;
+    ASSERT_TRUE(map.try_emplace("b", 2).second);
+    ASSERT_FALSE(map.try_emplace("b", 3).second);
+    ASSERT_TRUE(map.insert({"c", 3}).second);
+
+    ASSERT_EQ(map.size(), 3);
+    ASSERT_EQ(map.at("a"), 1);
+    ASSERT_EQ(map.at("b"), 2);
+    ASSERT_EQ(map.find("c")->second, 3);
+    ASSERT_TRUE(map.contains("c"));
+    ASSERT_FALSE(map.contains("d"));
+    ASSERT_THROW(map.at("d"), std::out_of_range);
+
+    map["a"] += 10;
+    ASSERT_EQ(map.at("a"), 11);
+
+    std::map<std::string, int> content{map.begin(), map.end()};
+    ASSERT_EQ(content, (std::map<std::string, int>{{"a", 11}, {"b", 2}, {"c", 3}}));
+}
+
+TEST(FlatHashMap, reserve)
+{
+    FlatHashMap<int, int> map{100};
+    const size_t slot_count = map.slot_count();
+
+    ASSERT_GE(slot_count, 100);
+    for (int i = 0; i < 100; ++i) map[i] = i;
+    ASSERT_EQ(map.slot_count(), slot_count);
+
+    map[100] = 100;
+    ASSERT_EQ(map.size(), 101);
+}
+
+TEST(FlatHashMap, erase)
+{
+    FlatHashMap<int, std::string> map;
+    std::map<int, std::string> reference;
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{0, 500};
+
+    for (int i = 0; i < 10'000; ++i) {
+        const int key = distribution(generator);
+        if (i % 3 == 0) {
+            ASSERT_EQ(map.erase(key), reference.erase(key));
+        }
+        else {
+            map[key] = std::to_string(i);
+            reference[key] = std::to_string(i);
+        }
+    }
+
+    ASSERT_EQ(map.size(), reference.size());
+    for (const auto& [key, value] : reference) { ASSERT_EQ(map.at(key), value); }
+    ASSERT_EQ((std::map<int, std::string>{map.begin(), map.end()}), reference);
+}
+
+TEST(FlatHashMap, copy_move)
+{
+    FlatHashMap<int, std::string> map;
+    for (int i = 0; i < 50; ++i) map[i] = std::to_string(i);
+
+    FlatHashMap<int, std::string> copy = map;
+    ASSERT_EQ(copy.size(), 50);
+    ASSERT_EQ(copy.at(42), "42");
+
+    FlatHashMap<int, std::string> moved = std::move(map);
+    ASSERT_EQ(moved.size(), 50);
+    ASSERT_TRUE(map.empty());
+
+    copy = FlatHashMap<int, std::string>{};
+    ASSERT_TRUE(copy.empty());
+    copy.clear();
+    ASSERT_EQ(copy.begin(), copy.end());
+}
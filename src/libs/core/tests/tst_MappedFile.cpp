@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <ez/MappedFile.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+using namespace ez;
+
+namespace {
+std::filesystem::path write_file(const std::string& name, std::string_view content)
+{
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::ofstream{path, std::ios::binary} << content;
+    return path;
+}
+}  // namespace
+
+TEST(MappedFile, map)
+{
+    auto path = write_file("ez_mapped_file.txt", "hello\nworld");
+
+    MappedFile file{path};
+    ASSERT_EQ(file.size(), 11);
+    ASSERT_EQ(file.view(), "hello\nworld");
+
+    MappedFile moved = std::move(file);
+    ASSERT_TRUE(file.empty());
+    ASSERT_EQ(moved.view().substr(6), "world");
+
+    std::filesystem::remove(path);
+}
+
+TEST(MappedFile, empty_and_missing)
+{
+    auto path = write_file("ez_mapped_file_empty.txt", "");
+
+    MappedFile file{path, MappedFile::Access::Random};
+    ASSERT_TRUE(file.empty());
+    ASSERT_EQ(file.view(), "");
+
+    std::filesystem::remove(path);
+    ASSERT_THROW(MappedFile{path}, std::system_error);
+}
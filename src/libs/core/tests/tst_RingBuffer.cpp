@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <ez/RingBuffer.hpp>
+
+#include <string>
+
+using namespace ez;
+
+TEST(RingBuffer, push_pop)
+{
+    RingBuffer<std::string> buffer{3};
+
+    ASSERT_EQ(buffer.capacity(), 3);
+    ASSERT_TRUE(buffer.empty());
+
+    buffer.push_back("a");
+    buffer.push_back("b");
+    buffer.push_back("c");
+    ASSERT_TRUE(buffer.full());
+    ASSERT_EQ(buffer.front(), "a");
+    ASSERT_EQ(buffer.back(), "c");
+
+    buffer.pop_front();
+    buffer.push_back("d");
+    ASSERT_EQ(buffer.size(), 3);
+    ASSERT_EQ(buffer[0], "b");
+    ASSERT_EQ(buffer[1], "c");
+    ASSERT_EQ(buffer[2], "d");
+
+    buffer.pop_back();
+    ASSERT_EQ(buffer.back(), "c");
+    buffer.pop_front();
+    buffer.pop_front();
+    ASSERT_TRUE(buffer.empty());
+
+    buffer.push_back("e");
+    ASSERT_EQ(buffer.front(), "e");
+    ASSERT_EQ(buffer.back(), "e");
+
+    buffer.clear();
+    ASSERT_TRUE(buffer.empty());
+}
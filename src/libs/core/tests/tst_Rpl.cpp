@@ -2,15 +2,53 @@
 
 #include <ez/rpl/All.hpp>
 
+#include <ez/async/Schedule.hpp>
+#include <ez/async/Wait.hpp>
+#include <ez/async/WhenAll.hpp>
+#include <ez/async/WhenAny.hpp>
+
 #include <ez/Lambda.hpp>
 #include <ez/Option.hpp>
 #include <ez/Tuple.hpp>
 
+#include <filesystem>
 #include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
 #include <ranges>
+#include <thread>
 
 using namespace ez;
 
+namespace {
+struct ThreadExecutor {
+};
+
+// Runs the posted tasks only when asked, like an event loop driven by the calling thread.
+struct QueuedExecutor {
+    std::vector<std::function<void()>> tasks;
+};
+}  // namespace
+
+template <>
+struct ez::async::Executor<ThreadExecutor> {
+    static void post(ThreadExecutor&, auto&& task) { std::thread{EZ_FWD(task)}.detach(); }
+};
+
+template <>
+struct ez::async::Executor<QueuedExecutor> {
+    static void post(QueuedExecutor& executor, auto&& task)
+    {
+        executor.tasks.emplace_back(EZ_FWD(task));
+    }
+};
+
 TEST(Rpl, functional)
 {
     using namespace ez::lambda::args;
@@ -270,6 +308,16 @@ TEST(Rpl, compose)
     ASSERT_EQ(result, (std::vector{4, 3}));
 }
 
+TEST(Rpl, compose_batch)
+{
+    using namespace ez::lambda::args;
+
+    auto pipeline = rpl::compose(rpl::sort(), rpl::transform(arg1 * 2), rpl::to_vector());
+    auto result = rpl::run(std::vector{3, 1, 2}, pipeline);
+
+    ASSERT_EQ(result, (std::vector{2, 4, 6}));
+}
+
 TEST(Rpl, parallel)
 {
     std::vector input{1, 2};
@@ -279,6 +327,75 @@ TEST(Rpl, parallel)
     ASSERT_EQ(result, Tuple(std::vector{1, 2}, std::vector{1, 2}));
 }
 
+TEST(Rpl, parallel_batch)
+{
+    // clang-format off
+    auto result = rpl::run(
+        std::vector{3, 1, 2},
+        rpl::parallel(rpl::sort(), rpl::sort(std::greater<>{}))
+    );
+    // clang-format on
+
+    ASSERT_EQ(result, Tuple(std::vector{1, 2, 3}, std::vector{3, 2, 1}));
+}
+
+TEST(Rpl, parallel_on_executor)
+{
+    ThreadExecutor executor;
+
+    std::vector<int> input(10'000);
+    std::iota(input.begin(), input.end(), 1);
+
+    auto is_even = [](int val) { return val % 2 == 0; };
+
+    // clang-format off
+    auto [count, evens, sum] = rpl::run(
+        input,
+        rpl::parallel(
+            rpl::on(executor, 16),
+            rpl::count(),
+            rpl::compose(rpl::filter(is_even), rpl::to_vector()),
+            rpl::accumulate<i64>())
+    );
+    // clang-format on
+
+    ASSERT_EQ(count, 10'000);
+    ASSERT_EQ(evens.size(), 5'000);
+    ASSERT_EQ(evens.back(), 10'000);
+    ASSERT_EQ(sum, i64{10'000} * 10'001 / 2);
+}
+
+TEST(Rpl, parallel_on_executor_driven_by_the_caller)
+{
+    // The producer consumes the full buffers itself, the late tasks find them empty.
+    QueuedExecutor executor;
+
+    auto [count, sum] = rpl::run(rpl::iota(1, 1'001),
+                                 rpl::parallel(rpl::on(executor, 16), rpl::count(),
+                                               rpl::accumulate<i64>()));
+
+    ASSERT_EQ(count, 1'000);
+    ASSERT_EQ(sum, i64{1'000} * 1'001 / 2);
+    ASSERT_FALSE(executor.tasks.empty());
+    for (auto& task : executor.tasks) task();
+}
+
+TEST(Rpl, parallel_on_executor_error)
+{
+    ThreadExecutor executor;
+
+    auto check = [](int val) {
+        if (val == 50) throw std::runtime_error{"invalid value"};
+        return val;
+    };
+
+    ASSERT_THROW(rpl::run(rpl::iota(1, 100),
+                          rpl::parallel(rpl::on(executor),
+                                        rpl::compose(rpl::transform(check), rpl::count()),
+                                        rpl::count())),
+                 std::runtime_error);
+}
+
 TEST(Rpl, iota_pipeline)
 {
     using namespace ez::lambda::args;
@@ -418,6 +535,71 @@ TEST(Rpl, unique)
     ASSERT_EQ(result, (std::vector{1, 2, 3, 4}));
 }
 
+TEST(Rpl, top_k)
+{
+    std::vector<int> input(1'000);
+    std::iota(input.begin(), input.end(), 0);
+    std::ranges::shuffle(input, std::mt19937{42});
+
+    ASSERT_EQ(rpl::run(input, rpl::top_k(3)), (std::vector{0, 1, 2}));
+    ASSERT_EQ(rpl::run(input, rpl::top_k(3, std::greater<>())), (std::vector{999, 998, 997}));
+    ASSERT_EQ(rpl::run(std::vector{2, 1}, rpl::top_k(5)), (std::vector{1, 2}));
+    ASSERT_TRUE(rpl::run(input, rpl::top_k(0)).empty());
+    ASSERT_EQ(rpl::run(std::vector{2, 1}, rpl::top_k(std::numeric_limits<size_t>::max())),
+              (std::vector{1, 2}));
+
+    ThreadExecutor executor;
+    auto result = rpl::run(rpl::par(executor, 4, 100), input, rpl::top_k(5, std::greater<>()));
+    ASSERT_EQ(result, (std::vector{999, 998, 997, 996, 995}));
+}
+
+TEST(Rpl, external_sort)
+{
+    std::vector<int> input(10'000);
+    std::iota(input.begin(), input.end(), 0);
+    std::ranges::shuffle(input, std::mt19937{42});
+
+    auto sorted = input;
+    std::ranges::sort(sorted);
+
+    // Runs of 1000 elements.
+    const size_t budget = 1000 * sizeof(int);
+
+    ASSERT_EQ(rpl::run(input, rpl::external_sort(std::less<>(), budget), rpl::to_vector()),
+              sorted);
+    ASSERT_EQ(rpl::run(input, rpl::external_sort(), rpl::to_vector()), sorted);
+
+    auto largest = rpl::run(input, rpl::external_sort(std::greater<>(), budget), rpl::take(3),
+                            rpl::to_vector());
+    ASSERT_EQ(largest, (std::vector{9'999, 9'998, 9'997}));
+
+    auto even = rpl::run(input, rpl::filter([](int val) { return val % 2 == 0; }),
+                         rpl::external_sort(std::less<>(), 64), rpl::count());
+    ASSERT_EQ(even, 5'000u);
+
+    // Runs of a single element: more runs than open files allowed, merged in passes.
+    std::vector<int> many(30'000);
+    std::iota(many.rbegin(), many.rend(), 0);
+    auto all = rpl::run(many, rpl::external_sort(std::less<>(), sizeof(int)), rpl::to_vector());
+    ASSERT_TRUE(std::ranges::equal(all, std::views::reverse(many)));
+}
+
+TEST(Rpl, partial_sort)
+{
+    // clang-format off
+    auto result = rpl::run(
+        std::vector{5, 3, 9, 1, 7},
+        rpl::partial_sort(2)
+        );
+    // clang-format on
+
+    ASSERT_EQ(result, (std::vector{1, 3}));
+
+    auto nth = rpl::run(std::vector{5, 3, 9, 1, 7}, rpl::nth_element(2));
+    ASSERT_EQ(nth[2], 5);
+    ASSERT_TRUE(std::ranges::all_of(nth.begin(), nth.begin() + 2, [](int v) { return v < 5; }));
+}
+
 TEST(Rpl, for_each)
 {
     using namespace ez::lambda::args;
@@ -447,6 +629,360 @@ TEST(Rpl, accumulate)
     ASSERT_EQ(result, 1 + 2 + 3);
 }
 
+TEST(Rpl, contiguous_blocks)
+{
+    std::vector<int> input(1'000);
+    std::iota(input.begin(), input.end(), -500);
+    std::ranges::reverse(input);
+
+    // Node based containers go through the element by element path.
+    const std::list<int> reference(input.begin(), input.end());
+
+    auto is_odd = [](int val) { return val % 2 != 0; };
+    auto square = [](int val) { return i64{val} * val; };
+
+    auto run_both = [&](auto... factories) {
+        auto result = rpl::run(input, factories...);
+        auto expected = rpl::run(reference, factories...);
+        if constexpr (requires { *result; }) { EXPECT_EQ(*result, *expected); }
+        else {
+            EXPECT_EQ(result, expected);
+        }
+        return result;
+    };
+
+    ASSERT_EQ(run_both(rpl::count()), 1'000u);
+    ASSERT_EQ(run_both(rpl::filter(is_odd), rpl::count()), 500u);
+    ASSERT_EQ(run_both(rpl::accumulate<i64>()), -500);
+    ASSERT_EQ(run_both(rpl::transform(square), rpl::accumulate<i64>()), 83'333'500);
+    ASSERT_EQ(run_both(rpl::min()), -500);
+    ASSERT_EQ(run_both(rpl::max()), 499);
+    ASSERT_EQ(run_both(rpl::filter(is_odd), rpl::max()), 499);
+    ASSERT_EQ(run_both(rpl::to_vector()), input);
+    ASSERT_EQ(run_both(rpl::filter(is_odd), rpl::transform(square), rpl::to_vector()).size(),
+              500u);
+    ASSERT_EQ(run_both(rpl::filter(is_odd), rpl::take(3), rpl::to_vector()),
+              (std::vector{499, 497, 495}));
+
+    std::vector<double> doubles(1'000, 0.5);
+    ASSERT_DOUBLE_EQ(rpl::run(doubles, rpl::accumulate<double>()), 500.0);
+}
+
+TEST(Rpl, contiguous_blocks_short_circuit)
+{
+    // Contiguous input is not transformed or filtered by chunks ahead of a take.
+    std::vector<int> input(1'000, 1);
+    size_t calls = 0;
+    auto counted = [&](int val) {
+        ++calls;
+        return val;
+    };
+
+    ASSERT_EQ(rpl::run(input, rpl::transform(counted), rpl::take(3), rpl::to_vector()).size(), 3u);
+    ASSERT_EQ(calls, 3u);
+
+    calls = 0;
+    ASSERT_EQ(rpl::run(input, rpl::filter(counted), rpl::compose(rpl::take(3), rpl::to_vector()))
+                  .size(),
+              3u);
+    ASSERT_EQ(calls, 3u);
+
+    calls = 0;
+    ASSERT_EQ(rpl::run(input, rpl::transform(counted), rpl::count()), 1'000u);
+    ASSERT_EQ(calls, 1'000u);
+}
+
+TEST(Rpl, contiguous_blocks_element_order)
+{
+    // Ahead of a stage processing the elements one at a time, each element goes through the
+    // whole pipeline before the next one is transformed or filtered.
+    std::vector<int> input(600, 1);
+    std::vector<char> events;
+    auto record = [&](char event) {
+        return [&events, event](int val) {
+            events.push_back(event);
+            return val;
+        };
+    };
+    auto expected = [](size_t count) {
+        std::vector<char> result;
+        for (size_t i = 0; i < count; ++i) result.insert(result.end(), {'t', 'e'});
+        return result;
+    };
+
+    rpl::run(input, rpl::transform(record('t')), rpl::for_each(record('e')));
+    ASSERT_EQ(events, expected(600));
+
+    events.clear();
+    rpl::run(input, rpl::filter(record('t')), rpl::for_each(record('e')));
+    ASSERT_EQ(events, expected(600));
+
+    events.clear();
+    rpl::run(input, rpl::transform(record('t')), rpl::compose(rpl::for_each(record('e'))));
+    ASSERT_EQ(events, expected(600));
+
+    events.clear();
+    std::vector<std::string> strings(300, "ab");
+    auto size = [&](const std::string& str) {
+        events.push_back('t');
+        return str.size();
+    };
+    rpl::run(strings, rpl::transform(size), rpl::for_each([&](size_t) { events.push_back('e'); }));
+    ASSERT_EQ(events, expected(300));
+}
+
+TEST(Rpl, contiguous_blocks_sum_order)
+{
+    // Floating point sums are computed in sequence unless reassociation is allowed.
+    std::vector<double> values;
+    for (int i = 0; i < 1'000; ++i) values.push_back(i % 2 == 0 ? 1e16 : 1.0);
+    for (int i = 0; i < 500; ++i) values.push_back(-1e16);
+
+    const double expected = std::accumulate(values.begin(), values.end(), 0.0);
+    ASSERT_EQ(rpl::run(values, rpl::accumulate(0.0)), expected);
+    ASSERT_EQ(rpl::run(values, rpl::sum<double>()), expected);
+    ASSERT_NEAR(rpl::run(values, rpl::accumulate(0.0, rpl::UnorderedPlus{})), expected, 1e3);
+
+    std::vector<u32> unsigned_values(1'000, 0xFFFF'FFFFu);
+    ASSERT_EQ(rpl::run(unsigned_values, rpl::accumulate(u32{0})), u32(-1'000));
+}
+
+TEST(Rpl, contiguous_blocks_mutable_references)
+{
+    // The filtered elements are modified in place, not copies of them.
+    std::vector<int> values(1'000);
+    std::iota(values.begin(), values.end(), 0);
+
+    auto is_even = [](int val) { return val % 2 == 0; };
+    rpl::run(values, rpl::filter(is_even), rpl::for_each([](int& val) { val = -val; }));
+
+    ASSERT_EQ(values[998], -998);
+    ASSERT_EQ(values[999], 999);
+    ASSERT_EQ(rpl::run(values, rpl::filter([](int val) { return val > 0; }), rpl::count()), 500u);
+}
+
+TEST(Rpl, chunked_stage)
+{
+    std::vector<int> input(1'000);
+    std::iota(input.begin(), input.end(), 0);
+
+    std::vector<size_t> chunk_sizes;
+    auto record_size = [&](auto chunk) { chunk_sizes.push_back(chunk.size()); };
+
+    {
+        // Contiguous input is sliced without copy.
+        auto result = rpl::run(input, rpl::inspect_chunks([&](std::span<const int> chunk) {
+                                   ASSERT_EQ(chunk.data(), &input[chunk.front()]);
+                                   record_size(chunk);
+                               }),
+                               rpl::to_vector());
+        ASSERT_EQ(result, input);
+        ASSERT_EQ(chunk_sizes, (std::vector<size_t>{256, 256, 256, 232}));
+    }
+
+    {
+        // Elements received one by one are gathered in chunks.
+        chunk_sizes.clear();
+        auto result = rpl::run(rpl::iota(0, 600), rpl::inspect_chunks(record_size),
+                               rpl::transform([](int val) { return val * 2; }), rpl::count());
+        ASSERT_EQ(result, 600u);
+        ASSERT_EQ(chunk_sizes, (std::vector<size_t>{256, 256, 88}));
+    }
+
+    {
+        // Downstream short-circuit stops the chunks. Ahead of a take the filter goes element by
+        // element, the chunked stage gathers copies of the read-only elements.
+        chunk_sizes.clear();
+        auto is_even = [](int val) { return val % 2 == 0; };
+        auto result = rpl::run(std::as_const(input), rpl::filter(is_even),
+                               rpl::inspect_chunks(record_size), rpl::take(3), rpl::to_vector());
+        ASSERT_EQ(result, (std::vector{0, 2, 4}));
+        ASSERT_EQ(chunk_sizes, (std::vector<size_t>{256}));
+    }
+
+    {
+        chunk_sizes.clear();
+        auto result =
+            rpl::run(input, rpl::compose(rpl::inspect_chunks(record_size), rpl::to_vector()));
+        ASSERT_EQ(result, input);
+        ASSERT_EQ(chunk_sizes.size(), 4u);
+    }
+
+    {
+        // Mutable lvalues are not copied: downstream stages see the elements themselves.
+        chunk_sizes.clear();
+        std::list<int> values(300, 1);
+        rpl::run(values, rpl::inspect_chunks(record_size), rpl::for_each([](int& val) { ++val; }));
+        ASSERT_EQ(std::ranges::count(values, 2), 300);
+        ASSERT_EQ(chunk_sizes, std::vector<size_t>(300, 1));
+    }
+
+    {
+        std::list<std::unique_ptr<int>> values;
+        for (int i = 0; i < 3; ++i) values.push_back(std::make_unique<int>(i));
+        auto result = rpl::run(values, rpl::inspect_chunks([](auto) {}),
+                               rpl::transform([](auto& ptr) { return *ptr; }), rpl::to_vector());
+        ASSERT_EQ(result, (std::vector{0, 1, 2}));
+    }
+}
+
+TEST(Rpl, group_by)
+{
+    struct Event {
+        std::string user;
+        int duration = 0;
+    };
+
+    const std::vector<Event> events{
+        {"bob", 3}, {"alice", 1}, {"bob", 5}, {"carol", 2}, {"alice", 7}, {"bob", 1}};
+
+    auto as_map = [](const auto& groups) { return std::map{groups.begin(), groups.end()}; };
+
+    {
+        auto result = rpl::run(events, rpl::group_by(&Event::user, rpl::count()));
+        ASSERT_EQ(as_map(result),
+                  (std::map<std::string, size_t>{{"alice", 2}, {"bob", 3}, {"carol", 1}}));
+    }
+
+    {
+        auto result = rpl::run(
+            events,
+            rpl::group_by(&Event::user,
+                          rpl::compose(rpl::transform(&Event::duration), rpl::sum<int>())));
+        ASSERT_EQ(as_map(result),
+                  (std::map<std::string, int>{{"alice", 8}, {"bob", 9}, {"carol", 2}}));
+    }
+
+    {
+        auto durations = [](auto aggregator) {
+            return rpl::compose(rpl::transform(&Event::duration), std::move(aggregator));
+        };
+
+        auto min = rpl::run(events, rpl::group_by(&Event::user, durations(rpl::min())));
+        auto max = rpl::run(events, rpl::group_by(&Event::user, durations(rpl::max())));
+        auto all = rpl::run(events, rpl::group_by(&Event::user, durations(rpl::to_vector()), 16));
+
+        ASSERT_EQ(min.at("bob"), 1);
+        ASSERT_EQ(max.at("bob"), 5);
+        ASSERT_EQ(all.at("bob"), (std::vector{3, 5, 1}));
+        ASSERT_EQ(all.at("carol"), (std::vector{2}));
+    }
+
+    {
+        auto result = rpl::run(rpl::iota(0, 10), rpl::group_by([](int val) { return val % 3; }));
+        ASSERT_EQ(as_map(result), (std::map<int, std::vector<int>>{
+                                      {0, {0, 3, 6, 9}}, {1, {1, 4, 7}}, {2, {2, 5, 8}}}));
+    }
+}
+
+TEST(Rpl, group_by_parallel)
+{
+    ThreadExecutor executor;
+
+    std::vector<int> input(10'000);
+    std::iota(input.begin(), input.end(), 0);
+
+    auto modulo = [](int val) { return val % 7; };
+
+    auto counts = rpl::run(rpl::par(executor, 4, 100), input, rpl::group_by(modulo, rpl::count()));
+    auto expected = rpl::run(input, rpl::group_by(modulo, rpl::count()));
+    ASSERT_EQ(counts.size(), 7);
+    for (auto& [key, count] : expected) ASSERT_EQ(counts.at(key), count);
+
+    auto values = rpl::run(rpl::par(executor, 4, 100), input, rpl::group_by(modulo));
+    ASSERT_EQ(values.at(3), rpl::run(input, rpl::group_by(modulo)).at(3));
+
+    // A composition is merged by its last stage.
+    auto sum_of_squares = [] {
+        return rpl::compose(rpl::transform([](int val) { return i64{val} * val; }),
+                            rpl::sum<i64>());
+    };
+    auto sums =
+        rpl::run(rpl::par(executor, 4, 100), input, rpl::group_by(modulo, sum_of_squares()));
+    auto expected_sums = rpl::run(input, rpl::group_by(modulo, sum_of_squares()));
+    ASSERT_EQ(sums.size(), 7);
+    for (auto& [key, sum] : expected_sums) ASSERT_EQ(sums.at(key), sum);
+
+    // The initial value of an aggregate is counted once per group, including the groups only
+    // met after the first chunk.
+    auto late = [](int val) { return val < 9'000 ? val % 2 : 2; };
+    auto offsets =
+        rpl::run(rpl::par(executor, 4, 100), input, rpl::group_by(late, rpl::accumulate(i64{100})));
+    auto expected_offsets = rpl::run(input, rpl::group_by(late, rpl::accumulate(i64{100})));
+    ASSERT_EQ(offsets.size(), 3);
+    for (auto& [key, sum] : expected_offsets) ASSERT_EQ(offsets.at(key), sum);
+
+    // Seeded products start the groups of the later chunks from the identity of the combiner.
+    auto seeded_product = [] {
+        return rpl::compose(rpl::transform([](int val) { return val < 2 || val > 9'997 ? 2 : 1; }),
+                            rpl::accumulate(i64{3}, std::multiplies<>{}, std::multiplies<>{},
+                                            i64{1}));
+    };
+    auto products =
+        rpl::run(rpl::par(executor, 4, 100), input, rpl::group_by(late, seeded_product()));
+    auto expected_products = rpl::run(input, rpl::group_by(late, seeded_product()));
+    ASSERT_EQ(products.size(), 3);
+    for (auto& [key, product] : expected_products) ASSERT_EQ(products.at(key), product);
+    ASSERT_EQ(products.at(2), 12);
+}
+
+TEST(Rpl, file_sources)
+{
+    const auto directory = std::filesystem::temp_directory_path();
+
+    {
+        const auto path = directory / "ez_rpl_lines.txt";
+        std::ofstream{path, std::ios::binary} << "first\r\nsecond\n\nfourth";
+
+        // The views point into the mapping owned by the source.
+        auto lines = rpl::lines(path);
+
+        auto result = rpl::run(lines, rpl::to_vector());
+        ASSERT_EQ(result, (std::vector<std::string_view>{"first", "second", "", "fourth"}));
+
+        auto first = rpl::run(lines, rpl::take(1), rpl::to_vector());
+        ASSERT_EQ(first, (std::vector<std::string_view>{"first"}));
+
+        auto size = [](std::string_view line) { return line.size(); };
+        auto sizes = rpl::run(rpl::lines(path), rpl::transform(size), rpl::to_vector());
+        ASSERT_EQ(sizes, (std::vector<size_t>{5, 6, 0, 6}));
+
+        std::filesystem::remove(path);
+    }
+
+    {
+        const auto path = directory / "ez_rpl_records.bin";
+        const std::vector<i64> values{1, 2, 3, 4};
+        std::ofstream{path, std::ios::binary}.write(reinterpret_cast<const char*>(values.data()),
+                                                     values.size() * sizeof(i64));
+
+        auto records = rpl::mmap_records<i64>(path);
+        ASSERT_EQ(records.size(), 4);
+        ASSERT_EQ(rpl::run(records, rpl::sum<i64>()), 10);
+        ASSERT_EQ(rpl::run(records, rpl::filter([](i64 val) { return val > 2; }), rpl::count()),
+                  2u);
+
+        std::filesystem::remove(path);
+    }
+
+    {
+        const auto path = directory / "ez_rpl.csv";
+        std::ofstream{path, std::ios::binary} << "name,city\r\n\"Doe, John\",Paris\nJane,\n";
+
+        auto rows = rpl::run(rpl::csv(path), rpl::transform([](auto row) {
+                                 return std::vector<std::string>(row.begin(), row.end());
+                             }),
+                             rpl::to_vector());
+        ASSERT_EQ(rows, (std::vector<std::vector<std::string>>{
+                            {"name", "city"}, {"Doe, John", "Paris"}, {"Jane", ""}}));
+
+        auto cities = rpl::run(rpl::csv(path, ';'), rpl::count());
+        ASSERT_EQ(cities, 3u);
+
+        std::filesystem::remove(path);
+    }
+}
+
 TEST(Rpl, filter_args_ez_tuple)
 {
     using namespace ez::lambda::args;
@@ -510,3 +1046,703 @@ TEST(Rpl, subrange)
     ASSERT_EQ(result, (std::vector{2, 3, 4}));
 }
 
+TEST(Rpl, parallel_run)
+{
+    ThreadExecutor executor;
+    auto policy = rpl::par(executor, 4, 100);
+
+    std::vector<int> input(10'000);
+    std::iota(input.begin(), input.end(), 1);
+
+    auto is_even = [](int val) { return val % 2 == 0; };
+    auto square = [](int val) { return i64{val} * val; };
+
+    {
+        auto result = rpl::run(policy, input, rpl::filter(is_even), rpl::transform(square),
+                               rpl::accumulate<i64>());
+
+        auto expected = rpl::run(input, rpl::filter(is_even), rpl::transform(square),
+                                 rpl::accumulate<i64>());
+        ASSERT_EQ(result, expected);
+    }
+
+    {
+        auto result = rpl::run(policy, input, rpl::filter(is_even), rpl::count());
+        ASSERT_EQ(result, 5'000);
+    }
+
+    {
+        // Folds that do not merge partial results need an explicit combiner and its identity.
+        auto count = rpl::run(policy, input,
+                              rpl::accumulate(i64{0}, [](i64 acc, int) { return acc + 1; },
+                                              std::plus<>{}, i64{0}));
+        ASSERT_EQ(count, 10'000);
+
+        auto digits = rpl::run(policy, input, rpl::filter([](int val) { return val <= 3; }),
+                               rpl::accumulate(
+                                   std::string{},
+                                   [](std::string acc, int val) { return acc + char('0' + val); },
+                                   std::plus<>{}, std::string{}));
+        ASSERT_EQ(digits, "123");
+    }
+
+    {
+        // The initial value is counted once, not once per chunk.
+        auto sum = rpl::run(policy, input, rpl::accumulate(i64{100}));
+        ASSERT_EQ(sum, rpl::run(input, rpl::accumulate(i64{100})));
+
+        auto count = rpl::run(policy, input, rpl::filter(is_even),
+                              rpl::compose(rpl::transform([](int) { return 1; }),
+                                           rpl::accumulate(i64{7})));
+        ASSERT_EQ(count, 5'007);
+
+        auto digits = rpl::run(policy, input,
+                               rpl::accumulate(
+                                   std::string{"x"},
+                                   [](std::string acc, int val) {
+                                       return val <= 3 || val > 9'998 ? acc + char('0' + val % 10)
+                                                                      : acc;
+                                   },
+                                   std::plus<>{}, std::string{}));
+        ASSERT_EQ(digits, "x12390");
+
+        // The chunks after the first start from the identity of the combiner, not from `Init{}`.
+        std::vector<i64> factors(1'000, 1);
+        factors[0] = 2;
+        factors[999] = 3;
+        auto product = rpl::run(policy, factors,
+                                rpl::accumulate(i64{5}, std::multiplies<>{}, std::multiplies<>{},
+                                                i64{1}));
+        ASSERT_EQ(product, 30);
+    }
+
+    {
+        auto negate = [](int val) { return -val; };
+        auto min = rpl::run(policy, input, rpl::transform(negate), rpl::min());
+        auto max = rpl::run(policy, input, rpl::max());
+        ASSERT_EQ(min, -10'000);
+        ASSERT_EQ(max, 10'000);
+    }
+
+    {
+        auto result = rpl::run(policy, input, rpl::to_vector());
+        ASSERT_EQ(result, input);
+    }
+
+    {
+        auto result = rpl::run(policy, std::vector{3, 1, 2}, rpl::to_vector(), rpl::sort());
+        ASSERT_EQ(result, (std::vector{1, 2, 3}));
+    }
+}
+
+TEST(Rpl, parallel_run_error)
+{
+    ThreadExecutor executor;
+
+    std::vector<int> input(1'000, 1);
+    input.back() = 0;
+
+    auto invert = [](int val) {
+        if (val == 0) throw std::domain_error{"division by zero"};
+        return 1 / val;
+    };
+
+    ASSERT_THROW(rpl::run(rpl::par(executor, 4, 10), input, rpl::transform(invert), rpl::count()),
+                 std::domain_error);
+}
+
+TEST(Rpl, parallel_run_executor_driven_by_the_caller)
+{
+    // The caller processes the chunks the executor did not start, the late tasks do nothing.
+    QueuedExecutor executor;
+    std::vector<int> input(10'000, 1);
+
+    ASSERT_EQ(rpl::run(rpl::par(executor, 4, 100), input, rpl::accumulate<i64>()), 10'000);
+    ASSERT_EQ(executor.tasks.size(), 3u);
+    for (auto& task : executor.tasks) task();
+}
+
+TEST(Rpl, window)
+{
+    auto to_vectors = rpl::transform(
+        [](auto view) { return std::vector<int>(view.begin(), view.end()); });
+
+    auto windows = rpl::run(std::vector{1, 2, 3, 4, 5}, rpl::window(2), to_vectors,
+                            rpl::to_vector());
+    ASSERT_EQ(windows, (std::vector<std::vector<int>>{{1, 2}, {3, 4}, {5}}));
+
+    auto first = rpl::run(std::vector{1, 2, 3, 4, 5}, rpl::window(2), rpl::take(1), to_vectors,
+                          rpl::to_vector());
+    ASSERT_EQ(first, (std::vector<std::vector<int>>{{1, 2}}));
+
+    auto sliding = rpl::run(std::vector{1, 2, 3, 4, 5, 6}, rpl::sliding(3), to_vectors,
+                            rpl::to_vector());
+    ASSERT_EQ(sliding,
+              (std::vector<std::vector<int>>{{1, 2, 3}, {2, 3, 4}, {3, 4, 5}, {4, 5, 6}}));
+
+    auto stepped = rpl::run(std::vector{1, 2, 3, 4, 5, 6, 7}, rpl::sliding(3, 2), to_vectors,
+                            rpl::to_vector());
+    ASSERT_EQ(stepped, (std::vector<std::vector<int>>{{1, 2, 3}, {3, 4, 5}, {5, 6, 7}}));
+}
+
+TEST(Rpl, tumbling)
+{
+    using namespace std::chrono_literals;
+    using Time = std::chrono::sys_time<std::chrono::seconds>;
+
+    struct Sample {
+        Time time;
+        int value = 0;
+    };
+
+    struct Bucket {
+        Time start;
+        int sum = 0;
+        bool operator==(const Bucket&) const = default;
+    };
+
+    std::vector<Sample> samples{
+        {Time{10s}, 1}, {Time{59s}, 2}, {Time{60s}, 3}, {Time{150s}, 4}, {Time{179s}, 5}};
+
+    // clang-format off
+    auto sums = rpl::run(
+        samples,
+        rpl::tumbling(1min, &Sample::time),
+        rpl::apply([](Time start, std::span<const Sample> window) {
+            int sum = 0;
+            for (const Sample& sample : window) sum += sample.value;
+            return Bucket{start, sum};
+        }),
+        rpl::to_vector()
+        );
+    // clang-format on
+
+    ASSERT_EQ(sums,
+              (std::vector<Bucket>{{Time{0s}, 3}, {Time{60s}, 3}, {Time{120s}, 9}}));
+}
+
+TEST(Rpl, rolling)
+{
+    std::vector values{4, 1, 3, 5, 2, 2};
+
+    ASSERT_EQ(rpl::run(values, rpl::rolling_sum(3), rpl::to_vector()),
+              (std::vector{8, 9, 10, 9}));
+    ASSERT_EQ(rpl::run(values, rpl::rolling_mean(2), rpl::to_vector()),
+              (std::vector{2.5, 2.0, 4.0, 3.5, 2.0}));
+    ASSERT_EQ(rpl::run(values, rpl::rolling_min(3), rpl::to_vector()),
+              (std::vector{1, 1, 2, 2}));
+    ASSERT_EQ(rpl::run(values, rpl::rolling_max(3), rpl::to_vector()),
+              (std::vector{4, 5, 5, 5}));
+    ASSERT_EQ(rpl::run(values, rpl::rolling_max(1), rpl::to_vector()), values);
+
+    std::vector<int> input(1'000);
+    std::ranges::generate(input, std::mt19937{7});
+    std::ranges::transform(input, input.begin(), [](int v) { return v % 1'000; });
+
+    std::vector<int> expected;
+    for (size_t i = 0; i + 16 <= input.size(); ++i) {
+        expected.push_back(*std::ranges::min_element(input.begin() + i, input.begin() + i + 16));
+    }
+    ASSERT_EQ(rpl::run(input, rpl::rolling_min(16), rpl::to_vector()), expected);
+}
+
+TEST(Rpl, zip_concat)
+{
+    std::vector<std::string> names{"a", "b", "c"};
+    std::vector ages{10, 20, 30, 40};
+
+    // clang-format off
+    auto adults = rpl::run(
+        rpl::zip(names, ages),
+        rpl::filter([](const std::string&, int age) { return age > 15; }),
+        rpl::apply([](std::string& name, int& age) { return name + std::to_string(age); }),
+        rpl::to_vector()
+        );
+    // clang-format on
+    ASSERT_EQ(adults, (std::vector<std::string>{"b20", "c30"}));
+
+    // The tuples reference the ranges.
+    rpl::run(rpl::zip(names, ages), rpl::for_each([](auto&& pair) { std::get<1>(pair) += 1; }));
+    ASSERT_EQ(ages, (std::vector{11, 21, 31, 40}));
+
+    ASSERT_EQ(rpl::run(rpl::zip(std::vector{1, 2}, rpl::iota(0)), rpl::count()), 2u);
+
+    auto all = rpl::run(rpl::concat(ages, std::vector{1, 2}), rpl::to_vector());
+    ASSERT_EQ(all, (std::vector{11, 21, 31, 40, 1, 2}));
+
+    auto first = rpl::run(rpl::concat(std::vector<int>{}, ages), rpl::take(2), rpl::to_vector());
+    ASSERT_EQ(first, (std::vector{11, 21}));
+}
+
+TEST(Rpl, merge_join)
+{
+    struct Event {
+        int id = 0;
+        std::string name;
+    };
+
+    std::vector<Event> orders{{1, "o1"}, {2, "o2"}, {2, "o2'"}, {4, "o4"}, {6, "o6"}};
+    std::vector<Event> payments{{0, "p0"}, {2, "p2"}, {2, "p2'"}, {3, "p3"}, {6, "p6"}};
+
+    // clang-format off
+    auto joined = rpl::run(
+        rpl::merge_join(orders, payments, &Event::id),
+        rpl::apply([](const Event& order, const Event& payment) {
+            return order.name + "-" + payment.name;
+        }),
+        rpl::to_vector()
+        );
+    // clang-format on
+
+    ASSERT_EQ(joined,
+              (std::vector<std::string>{"o2-p2", "o2-p2'", "o2'-p2", "o2'-p2'", "o6-p6"}));
+
+    auto ids = rpl::run(rpl::merge_join(std::vector{1, 3, 5, 7}, rpl::iota(0, 6), std::identity{}),
+                        rpl::apply([](int lhs, int) { return lhs; }), rpl::to_vector());
+    ASSERT_EQ(ids, (std::vector{1, 3, 5}));
+}
+
+TEST(Rpl, hash_join)
+{
+    struct Customer {
+        int id = 0;
+        std::string name;
+    };
+
+    struct Order {
+        int customer_id = 0;
+        int amount = 0;
+    };
+
+    std::vector<Customer> customers{{1, "alice"}, {2, "bob"}, {1, "alice'"}};
+    std::vector<Order> orders{{2, 10}, {3, 20}, {1, 30}};
+
+    // clang-format off
+    auto joined = rpl::run(
+        orders,
+        rpl::hash_join(customers, &Customer::id, &Order::customer_id),
+        rpl::apply([](const Order& order, const Customer& customer) {
+            return customer.name + std::to_string(order.amount);
+        }),
+        rpl::to_vector()
+        );
+    // clang-format on
+
+    ASSERT_EQ(joined, (std::vector<std::string>{"bob10", "alice30", "alice'30"}));
+
+    auto first = rpl::run(std::vector{1, 1}, rpl::hash_join(std::vector{1, 1, 1}, std::identity{}),
+                          rpl::take(4), rpl::count());
+    ASSERT_EQ(first, 4u);
+
+    ThreadExecutor executor;
+    std::vector<int> input(10'000);
+    std::iota(input.begin(), input.end(), 0);
+    auto matches = rpl::run(rpl::par(executor, 4, 100), input,
+                            rpl::hash_join(std::vector{5, 500, 5'000, 50'000}, std::identity{}),
+                            rpl::count());
+    ASSERT_EQ(matches, 3u);
+}
+
+TEST(Rpl, run_async)
+{
+    using namespace std::chrono_literals;
+
+    ThreadExecutor executor;
+    std::atomic_int active = 0;
+    std::atomic_int max_active = 0;
+
+    auto lookup = [&](int value) -> async::Task<int> {
+        co_await async::schedule_on(executor);
+        const int current = ++active;
+        max_active = std::max(max_active.load(), current);
+        std::this_thread::sleep_for(1ms * (value % 3));
+        --active;
+        co_return value * 10;
+    };
+
+    std::vector<int> input(50);
+    std::iota(input.begin(), input.end(), 0);
+
+    // clang-format off
+    auto ordered = async::sync_wait(rpl::run_async(
+        executor,
+        input,
+        rpl::filter([](int value) { return value % 2 == 0; }),
+        rpl::async_transform(lookup, 4),
+        rpl::to_vector()
+        ));
+    // clang-format on
+
+    auto expected = rpl::run(input, rpl::filter([](int value) { return value % 2 == 0; }),
+                             rpl::transform([](int value) { return value * 10; }),
+                             rpl::to_vector());
+    ASSERT_EQ(ordered, expected);
+    ASSERT_LE(max_active, 4);
+
+    auto unordered = async::sync_wait(rpl::run_async(
+        executor, std::vector{1, 2, 3, 4, 5, 6},
+        rpl::async_transform(lookup, 3, rpl::AsyncOrder::Unordered), rpl::to_vector()));
+    std::ranges::sort(unordered);
+    ASSERT_EQ(unordered, (std::vector{10, 20, 30, 40, 50, 60}));
+
+    auto first = async::sync_wait(rpl::run_async(executor, input, rpl::async_transform(lookup, 8),
+                                                 rpl::take(3), rpl::to_vector()));
+    ASSERT_EQ(first, (std::vector{0, 10, 20}));
+}
+
+TEST(Rpl, run_async_error)
+{
+    ThreadExecutor executor;
+
+    auto lookup = [&](int value) -> async::Task<int> {
+        co_await async::schedule_on(executor);
+        if (value == 7) throw std::domain_error{"lookup"};
+        co_return value;
+    };
+
+    ASSERT_THROW(async::sync_wait(rpl::run_async(executor, rpl::iota(0, 20),
+                                                 rpl::async_transform(lookup, 4), rpl::count())),
+                 std::domain_error);
+}
+
+TEST(Rpl, run_async_destroyed_while_pending)
+{
+    using namespace std::chrono_literals;
+
+    ThreadExecutor executor;
+    std::atomic_int finished = 0;
+
+    auto lookup = [&](int value) -> async::Task<int> {
+        co_await async::schedule_on(executor);
+        std::this_thread::sleep_for(10ms);
+        ++finished;
+        co_return value;
+    };
+    auto nothing = []() -> async::Task<std::vector<int>> { co_return std::vector<int>{}; };
+
+    // The pipeline loses and its frame is destroyed with the transformations in flight.
+    auto winner = async::sync_wait(async::when_any(
+        rpl::run_async(executor, std::vector{1, 2, 3, 4}, rpl::async_transform(lookup, 4),
+                       rpl::to_vector()),
+        nothing()));
+    ASSERT_TRUE(winner.empty());
+
+    while (finished != 4) std::this_thread::sleep_for(1ms);
+    std::this_thread::sleep_for(20ms);
+}
+
+TEST(Rpl, stream)
+{
+    auto stream = rpl::make_stream<int>(rpl::filter([](int value) { return value % 2 == 0; }),
+                                        rpl::to_vector());
+
+    stream.push(1);
+    stream.push(2);
+    ASSERT_EQ(stream.checkpoint(), (std::vector{2}));
+
+    std::vector values{3, 4, 6};
+    stream.push(values);
+    ASSERT_EQ(std::move(stream).finish(), (std::vector{2, 4, 6}));
+
+    // Checkpoints read the aggregates in place, the groups keep aggregating.
+    auto groups = rpl::make_stream<int>(
+        rpl::filter([](int value) { return value > 0; }),
+        rpl::group_by([](int value) { return value % 2; }, rpl::accumulate(0)));
+    for (int i = 0; i < 4; ++i) groups.push(i);
+    auto partial = groups.checkpoint();
+    ASSERT_EQ(partial.size(), 2);
+    ASSERT_EQ(partial.at(0), 2);
+    ASSERT_EQ(partial.at(1), 4);
+    for (int i = 4; i < 6; ++i) groups.push(i);
+    ASSERT_EQ(groups.checkpoint().at(1), 9);
+    auto total = std::move(groups).finish();
+    ASSERT_EQ(total.at(0), 6);
+    ASSERT_EQ(total.at(1), 9);
+
+    auto first = rpl::make_stream<int>(rpl::take(2), rpl::count());
+    for (int i = 0; i < 5; ++i) first.push(i);
+    ASSERT_TRUE(first.done());
+    ASSERT_EQ(std::move(first).finish(), 2u);
+}
+
+TEST(Rpl, live_source)
+{
+    ThreadExecutor executor;
+    rpl::LiveSource<std::string> source{2};
+
+    // Returns the number of values pushed, when_all does not take void tasks.
+    auto produce = [&]() -> async::Task<int> {
+        co_await async::schedule_on(executor);
+        int pushed = 0;
+        for (; pushed < 100; ++pushed) {
+            if (!co_await source.push(std::to_string(pushed))) co_return pushed;
+        }
+        source.close();
+        co_return pushed;
+    };
+
+    auto stream = rpl::make_stream<std::string>(
+        rpl::transform([](const std::string& value) { return std::stoi(value); }),
+        rpl::accumulate(0));
+
+    // The producer is awaited too, its frame must outlive the thread running it.
+    std::vector<int> checkpoints;
+    auto [pushed, total] = async::sync_wait(
+        async::when_all(produce(), rpl::consume(source, stream, 25, [&](int partial) {
+                            checkpoints.push_back(partial);
+                        })));
+
+    ASSERT_EQ(pushed, 100);
+
+    ASSERT_EQ(total, 4950);
+    ASSERT_EQ(checkpoints, (std::vector{300, 1225, 2775, 4950}));
+}
+
+TEST(Rpl, live_source_stops_producers)
+{
+    rpl::LiveSource<int> source{1};
+    bool rejected = false;
+
+    auto produce = [&]() -> async::Task<> {
+        for (int i = 0;; ++i) {
+            if (!co_await source.push(i)) break;
+        }
+        rejected = true;
+    };
+    auto producer = produce();
+    producer.resume();
+    ASSERT_FALSE(rejected);
+
+    auto stream = rpl::make_stream<int>(rpl::take(3), rpl::to_vector());
+    auto first = async::sync_wait(rpl::consume(source, stream));
+
+    ASSERT_EQ(first, (std::vector{0, 1, 2}));
+    ASSERT_TRUE(rejected);
+    ASSERT_TRUE(producer.done());
+}
+
+TEST(Rpl, live_source_destroyed_awaiters)
+{
+    rpl::LiveSource<int> source{1};
+    int popped = -1;
+
+    auto push = [&](int value) -> async::Task<> { co_await source.push(value); };
+    auto pop = [&]() -> async::Task<> { popped = co_await source.pop() || -1; };
+
+    // Destroyed while suspended, neither is resumed nor takes a value afterwards.
+    {
+        auto abandoned = pop();
+        abandoned.resume();
+        ASSERT_FALSE(abandoned.done());
+    }
+    auto first = push(1);
+    first.resume();
+    ASSERT_TRUE(first.done());
+    {
+        auto abandoned = push(2);
+        abandoned.resume();
+        ASSERT_FALSE(abandoned.done());
+    }
+
+    auto second = pop();
+    second.resume();
+    ASSERT_TRUE(second.done());
+    ASSERT_EQ(popped, 1);
+
+    popped = -1;
+    auto third = pop();
+    third.resume();
+    ASSERT_FALSE(third.done());
+    source.close();
+    ASSERT_TRUE(third.done());
+    ASSERT_EQ(popped, -1);
+}
+
+namespace {
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    size_t* allocations = nullptr;
+
+    CountingAllocator(size_t* a) : allocations{a} {}
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : allocations{other.allocations}
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        ++*allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+
+    bool operator==(const CountingAllocator&) const = default;
+};
+
+}  // namespace
+
+TEST(Rpl, to_vector_reserves)
+{
+    size_t allocations = 0;
+    std::vector<int> values(1000, 1);
+
+    auto result = rpl::run(values, rpl::transform([](int value) { return value * 2; }),
+                           rpl::to_vector(CountingAllocator<int>{&allocations}));
+    ASSERT_EQ(result.size(), 1000u);
+    ASSERT_EQ(allocations, 1u);
+
+    allocations = 0;
+    auto first = rpl::run(values, rpl::enumerate(), rpl::get<0>(), rpl::take(10),
+                          rpl::to_vector(CountingAllocator<size_t>{&allocations}));
+    ASSERT_EQ(first.size(), 10u);
+    ASSERT_EQ(first.capacity(), 10u);
+    ASSERT_EQ(allocations, 1u);
+
+    auto stream = rpl::make_stream<int>(rpl::to_vector());
+    stream.reserve(100);
+    stream.push(1);
+    ASSERT_GE(std::move(stream).finish().capacity(), 100u);
+}
+
+TEST(Rpl, to_pmr_containers)
+{
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(),
+                                              std::pmr::null_memory_resource()};
+
+    std::pmr::vector<int> result =
+        rpl::run(rpl::iota(0, 100), rpl::filter([](int value) { return value % 10 == 0; }),
+                 rpl::to_vector(&arena));
+    ASSERT_EQ(result.size(), 10u);
+    ASSERT_EQ(result.get_allocator().resource(), &arena);
+
+    auto map = rpl::run(rpl::iota(1, 4), rpl::enumerate(), rpl::to_map(&arena));
+    ASSERT_EQ(map.at(2), 3);
+    ASSERT_EQ(map.get_allocator().resource(), &arena);
+}
+
+TEST(Rpl, to_flat_map)
+{
+    auto result = rpl::run(std::vector{3, 4, 3}, rpl::enumerate(), rpl::reorder<1, 0>(),
+                           rpl::to_flat_map());
+    ASSERT_EQ(result.size(), 2u);
+    ASSERT_EQ(result.at(3), 0u);
+    ASSERT_EQ(result.at(4), 1u);
+
+    std::vector<int> values(10000);
+    std::iota(values.begin(), values.end(), 0);
+    ThreadExecutor executor;
+    auto parallel = rpl::run(rpl::par(executor, 4, 1000), values,
+                             rpl::transform([](int value) { return std::pair{value, -value}; }),
+                             rpl::to_flat_map());
+    ASSERT_EQ(parallel.size(), values.size());
+}
+
+TEST(Rpl, distinct)
+{
+    std::vector<std::string> words{"b", "a", "b", "c", "a", "d"};
+
+    auto result = rpl::run(words, rpl::distinct(), rpl::to_vector());
+    ASSERT_EQ(result, (std::vector<std::string>{"b", "a", "c", "d"}));
+
+    auto modulo = rpl::run(rpl::iota(0, 100), rpl::distinct([](int value) { return value % 7; },
+                                                            [](int lhs, int rhs) {
+                                                                return lhs % 7 == rhs % 7;
+                                                            }),
+                           rpl::to_vector());
+    ASSERT_EQ(modulo, (std::vector{0, 1, 2, 3, 4, 5, 6}));
+
+    ASSERT_EQ(rpl::run(words, rpl::count_distinct()), 4u);
+    ASSERT_EQ(rpl::run(words, rpl::distinct(), rpl::take(2), rpl::count()), 2u);
+}
+
+TEST(Rpl, distinct_approx)
+{
+    std::vector<int> values(100'000);
+    for (size_t i = 0; i < values.size(); ++i) values[i] = int(i % 20'000);
+
+    auto unique = rpl::run(values, rpl::distinct_approx(20'000, 0.01), rpl::to_vector());
+    ASSERT_GT(unique.size(), 19'500u);
+    ASSERT_LE(unique.size(), 20'000u);
+    std::ranges::sort(unique);
+    ASSERT_EQ(std::ranges::adjacent_find(unique), unique.end());
+
+    const size_t estimate = rpl::run(values, rpl::count_distinct_approx());
+    ASSERT_NEAR(double(estimate), 20'000.0, 20'000.0 * 0.05);
+}
+
+TEST(Rpl, profiled)
+{
+    rpl::PipelineProfile profile{4};
+    auto is_even = [](int value) { return value % 2 == 0; };
+
+    auto result = rpl::run(rpl::iota(0, 100),
+                           rpl::profiled(profile, rpl::filter(is_even),
+                                         rpl::transform([](int value) { return value * 3; }),
+                                         rpl::take(10), rpl::to_vector()));
+    ASSERT_EQ(result.size(), 10u);
+    ASSERT_EQ(profile.stages.size(), 4u);
+
+    const auto& filter = profile.stages[0];
+    ASSERT_EQ(filter.name, "stage 0");
+    ASSERT_EQ(filter.elements_in, 19u);
+    ASSERT_EQ(filter.elements_out, 10u);
+    ASSERT_EQ(filter.sampled_calls, 5u);
+    ASSERT_FALSE(filter.short_circuited);
+
+    ASSERT_EQ(profile.stages[1].elements_in, 10u);
+    ASSERT_EQ(profile.stages[1].elements_out, 10u);
+    ASSERT_EQ(profile.stages[2].elements_out, 10u);
+    ASSERT_TRUE(profile.stages[2].short_circuited);
+    ASSERT_EQ(profile.stages[3].elements_in, 10u);
+    ASSERT_EQ(profile.stages[3].elements_out, 1u);
+
+    ASSERT_GE(filter.total_time(), profile.stages[1].total_time());
+
+    profile.stages[0].name = "filter";
+    const std::string json = profile.to_json();
+    ASSERT_TRUE(json.starts_with(R"({"sample_period":4,"stages":[{"name":"filter",)"));
+    ASSERT_NE(json.find(R"("elements_in":19,"elements_out":10,"short_circuited":false)"),
+              std::string::npos);
+    ASSERT_TRUE(json.ends_with("}]}"));
+
+    profile.stages[1].name = "say \"hi\"\\\n";
+    ASSERT_NE(profile.to_json().find(R"("name":"say \"hi\"\\\u000a")"), std::string::npos);
+
+    ExecutionReport report;
+    profile.export_to(report);
+    ASSERT_EQ(report.sub_report_count(), 4u);
+    ASSERT_EQ(report.sub_report_at(0).name(), "filter");
+    ASSERT_EQ(report.sub_report_at(0).log_message_count(), 1u);
+}
+
+TEST(Rpl, profiled_chunks)
+{
+    rpl::PipelineProfile profile;
+    std::vector<int> values(1000, 1);
+
+    auto sum = rpl::run(std::as_const(values),
+                        rpl::profiled(profile, rpl::filter([](int v) { return v > 0; }),
+                                      rpl::accumulate(0)));
+    ASSERT_EQ(sum, 1000);
+    ASSERT_EQ(profile.stages[0].elements_in, 1000u);
+    ASSERT_EQ(profile.stages[0].elements_out, 1000u);
+    ASSERT_EQ(profile.stages[1].elements_out, 1u);
+    ASSERT_EQ(profile.stages[0].incremental_calls, 0u);
+
+    // rpl::par rejects the pipelines cloning a profiled stage, even nested in another stage.
+    auto profiled_sum = rpl::profiled(profile, rpl::accumulate(0));
+    using Profiled = rpl::Pipeline<rpl::ProcessingMode::Batch, std::vector<int>&,
+                                   decltype(rpl::filter([](int v) { return v > 0; })),
+                                   decltype(profiled_sum)>;
+    using Grouped = rpl::Pipeline<rpl::ProcessingMode::Batch, std::vector<int>&,
+                                  decltype(rpl::group_by([](int v) { return v; }, profiled_sum))>;
+    using Plain = rpl::Pipeline<rpl::ProcessingMode::Batch, std::vector<int>&,
+                                decltype(rpl::accumulate(0))>;
+    static_assert(Profiled::any_shares_state());
+    static_assert(Grouped::any_shares_state());
+    static_assert(!Plain::any_shares_state());
+}
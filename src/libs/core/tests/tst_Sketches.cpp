@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <ez/Sketches.hpp>
+
+#include <cmath>
+
+using namespace ez;
+
+TEST(Sketches, bloom_filter)
+{
+    BloomFilter filter{1000, 0.01};
+    ASSERT_GE(filter.bit_count(), 9585u);
+    ASSERT_EQ(filter.probe_count(), 7u);
+
+    for (u64 i = 0; i < 1000; ++i) ASSERT_TRUE(filter.insert(i));
+    for (u64 i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(filter.may_contain(i));
+        ASSERT_FALSE(filter.insert(i));
+    }
+
+    size_t false_positives = 0;
+    for (u64 i = 1000; i < 101'000; ++i) false_positives += filter.may_contain(i);
+    ASSERT_LT(false_positives, 2000u);
+
+    filter.clear();
+    ASSERT_FALSE(filter.may_contain(0));
+}
+
+TEST(Sketches, hyperloglog)
+{
+    HyperLogLog empty;
+    ASSERT_EQ(empty.estimate(), 0u);
+
+    for (size_t count : {10u, 1000u, 100'000u, 1'000'000u}) {
+        HyperLogLog sketch{12};
+        for (u64 i = 0; i < count; ++i) {
+            sketch.add(i);
+            sketch.add(i);
+        }
+        const double error = std::abs(double(sketch.estimate()) - double(count)) / double(count);
+        ASSERT_LT(error, 0.05) << count;
+    }
+}
+
+TEST(Sketches, hyperloglog_merge)
+{
+    HyperLogLog lhs{10};
+    HyperLogLog rhs{10};
+    for (u64 i = 0; i < 50'000; ++i) lhs.add(i);
+    for (u64 i = 25'000; i < 75'000; ++i) rhs.add(i);
+
+    lhs.merge(rhs);
+    const double error = std::abs(double(lhs.estimate()) - 75'000.0) / 75'000.0;
+    ASSERT_LT(error, 0.1);
+}
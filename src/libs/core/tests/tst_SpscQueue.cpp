@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <ez/SpscQueue.hpp>
+
+#include <memory>
+#include <thread>
+
+using namespace ez;
+
+TEST(SpscQueue, push_pop)
+{
+    SpscQueue<std::string> queue{3};
+
+    ASSERT_EQ(queue.capacity(), 4);
+    ASSERT_TRUE(queue.empty());
+    ASSERT_FALSE(queue.try_pop());
+
+    ASSERT_TRUE(queue.try_push("a"));
+    ASSERT_TRUE(queue.try_push(std::string{"b"}));
+    ASSERT_TRUE(queue.try_push(2, 'c'));
+    ASSERT_TRUE(queue.try_push("d"));
+    ASSERT_FALSE(queue.try_push("e"));
+    ASSERT_EQ(queue.size(), 4);
+
+    ASSERT_EQ(queue.try_pop(), "a");
+    ASSERT_EQ(queue.try_pop(), "b");
+    ASSERT_TRUE(queue.try_push("e"));
+    ASSERT_EQ(queue.try_pop(), "cc");
+    ASSERT_EQ(queue.try_pop(), "d");
+    ASSERT_EQ(queue.try_pop(), "e");
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, destroy_remaining)
+{
+    auto value = std::make_shared<int>(10);
+
+    {
+        SpscQueue<std::shared_ptr<int>> queue{8};
+        queue.try_push(value);
+        queue.try_push(value);
+        ASSERT_EQ(value.use_count(), 3);
+    }
+
+    ASSERT_EQ(value.use_count(), 1);
+}
+
+TEST(SpscQueue, producer_consumer)
+{
+    constexpr size_t count = 100'000;
+
+    SpscQueue<size_t> queue{64};
+
+    std::thread producer{[&] {
+        for (size_t i = 0; i < count; ++i) {
+            while (!queue.try_push(i)) { std::this_thread::yield(); }
+        }
+    }};
+
+    size_t expected = 0;
+    while (expected < count) {
+        if (auto value = queue.try_pop()) {
+            ASSERT_EQ(*value, expected);
+            ++expected;
+        }
+    }
+
+    producer.join();
+    ASSERT_TRUE(queue.empty());
+}
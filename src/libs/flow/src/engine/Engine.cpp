@@ -6,6 +6,7 @@
 #include <ez/flow/Parser.hpp>
 
 #include <ez/async/Scope.hpp>
+#include <ez/io/TimerWheel.hpp>
 
 #include <boost/spirit/home/x3/support/utility/error_reporting.hpp>
 
@@ -14,6 +15,8 @@
 namespace ez::flow {
 struct Engine::Impl {
     Ref<io::Context> io_context;
+    // Declared before the scope, the pending delays are cancelled when the scope is destroyed.
+    io::TimerWheel timers;
     async::Scope<io::Context> scope;
 
     Logger logger;
@@ -29,7 +32,10 @@ struct Engine::Impl {
     }
 };
 
-Engine::Engine(io::Context& io_context) : m_impl{std::in_place, io_context, io_context} {}
+Engine::Engine(io::Context& io_context)
+    : m_impl{std::in_place, io_context, io_context, io_context}
+{
+}
 
 void Engine::set_logger(Logger logger) { m_impl->logger = std::move(logger); }
 
@@ -47,7 +53,7 @@ void Engine::eval(std::string code, std::string file_name, unsigned int id)
                 co_return;
             }
 
-            engine::Interpreter interpreter{io_context};
+            engine::Interpreter interpreter{io_context, m_impl->timers};
             m_impl->configure_interpreter(interpreter);
             interpreter.set_instance_id(id);
 
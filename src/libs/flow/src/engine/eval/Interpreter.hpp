@@ -8,12 +8,14 @@
 
 #include <ez/async/Executor.hpp>
 #include <ez/async/Task.hpp>
+#include <ez/io/TimerWheel.hpp>
 
 namespace ez::flow::engine {
 using async::Task;
 
 struct Interpreter {
     Ref<io::Context> io_context;
+    Ref<io::TimerWheel> timers;
     struct {
         Logger logger;
         ext::ActionRequest run_action_delegate;
@@ -27,7 +29,7 @@ struct Interpreter {
         std::uint32_t max_loop_count = 1000;
     } options;
 
-    Interpreter(io::Context& ctx) : io_context{ctx} {}
+    Interpreter(io::Context& ctx, io::TimerWheel& timers) : io_context{ctx}, timers{timers} {}
 
     void set_instance_id(unsigned int);
 
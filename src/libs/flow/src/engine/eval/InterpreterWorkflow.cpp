@@ -4,7 +4,6 @@
 #include "../types/EntityUtils.hpp"
 
 #include <ez/async/WhenAny.hpp>
-#include <ez/io/Delay.hpp>
 
 #include <ez/ScopeGuard.hpp>
 #include <ez/Traits.hpp>
@@ -78,7 +77,7 @@ Task<> Interpreter::eval(Statement<ast::DelayStatement> statement)
                                      Duration::static_type().name, timeout.type().name);
     }
 
-    co_await io::delay(io_context.get(), timeout.as<Duration>().value().to_std_duration());
+    co_await timers.get().delay(timeout.as<Duration>().value().to_std_duration());
 }
 
 Task<> Interpreter::eval(Statement<ast::ReturnStatement> statement)
@@ -205,7 +204,7 @@ Task<Entity> Interpreter::eval_await(Statement<ast::AwaitExpression> statement,
         timeout.as<Duration>().value().to_std_duration();
 
     auto result = co_await async::when_any(
-        eval(workflow_invocation), io::delay(io_context.get(), timeout_duration, timeout_tag));
+        eval(workflow_invocation), timers.get().delay(timeout_duration, timeout_tag));
 
     if (result.is<Entity>()) co_return std::move(result.as<Entity>());
 
@@ -225,7 +224,7 @@ Task<Entity> Interpreter::eval_await(Statement<ast::AwaitExpression> statement,
 
     auto result = co_await async::when_any(
         task,
-        io::delay(io_context.get(), timeout.as<Duration>().value().to_std_duration(), timeout_tag));
+        timers.get().delay(timeout.as<Duration>().value().to_std_duration(), timeout_tag));
 
     if (result.is<TimeoutTag>()) {
         Error error;
@@ -249,7 +248,7 @@ Task<Entity> Interpreter::eval_await(Statement<ast::AwaitExpression> statement,
 
     auto result = co_await async::when_any(
         task,
-        io::delay(io_context.get(), timeout.as<Duration>().value().to_std_duration(), timeout_tag));
+        timers.get().delay(timeout.as<Duration>().value().to_std_duration(), timeout_tag));
 
     if (result.is<TimeoutTag>()) {
         Error error;
@@ -273,7 +272,7 @@ Task<Entity> Interpreter::eval_await(Statement<ast::AwaitExpression> statement,
 
     auto result = co_await async::when_any(
         task,
-        io::delay(io_context.get(), timeout.as<Duration>().value().to_std_duration(), timeout_tag));
+        timers.get().delay(timeout.as<Duration>().value().to_std_duration(), timeout_tag));
 
     if (result.is<TimeoutTag>()) {
         Error error;
@@ -297,7 +296,7 @@ Task<Entity> Interpreter::eval_await(Statement<ast::AwaitExpression> statement,
 
     auto result = co_await async::when_any(
         task,
-        io::delay(io_context.get(), timeout.as<Duration>().value().to_std_duration(), timeout_tag));
+        timers.get().delay(timeout.as<Duration>().value().to_std_duration(), timeout_tag));
 
     if (result.is<TimeoutTag>()) {
         Error error;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ez/io/Context.hpp>
+#include <ez/io/PostedCancel.hpp>
 
 #include <ez/async/Operation.hpp>
 
@@ -11,11 +12,15 @@ namespace ez::io {
 using SteadyTimer = boost::asio::steady_timer;
 using Duration = std::chrono::steady_clock::duration;
 
+/// The result throws async::OperationCancelled when the timer was cancelled. The cancellation
+/// runs on the context of the timer.
 template <typename R = Unit>
 struct Delay {
     SteadyTimer timer;
     Duration duration;
     R return_value;
+    bool cancelled = false;
+    PostedCancel cancellation;
     Delay(Context& context, Duration d, R ret_value = Unit{})
         : timer{context}, duration{d}, return_value{EZ_FWD(ret_value)}
     {
@@ -26,15 +31,18 @@ struct Delay {
     void start(auto continuation)
     {
         timer.expires_after(duration);
-        timer.async_wait(
-            [continuation = std::move(continuation)](boost::system::error_code error) mutable {
-                if (!error) { continuation(); }
-            });
+        timer.async_wait([this, continuation = std::move(continuation)](
+                             boost::system::error_code error) mutable {
+            cancellation.complete();
+            cancelled = error == boost::asio::error::operation_aborted;
+            continuation();
+        });
     }
 
-    void cancel() { timer.cancel(); }
+    void cancel() { cancellation.post(timer); }
     auto result()
     {
+        if (cancelled) throw async::OperationCancelled{};
         if constexpr (!std::is_same_v<R, Unit>) { return std::move(return_value); }
     }
 };
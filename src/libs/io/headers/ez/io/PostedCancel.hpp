@@ -0,0 +1,52 @@
+#pragma once
+
+#include <boost/asio/post.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace ez::io {
+
+///
+/// Cancellation of the pending operation of an asio I/O object (socket, timer...), requested
+/// from any thread. The I/O objects are not thread safe: the cancellation is posted to the
+/// executor of the object, like every other access to it. It is skipped once the operation
+/// completed, the continuation may have destroyed the object by then.
+/// Usage:
+///   @code
+///   void start(auto continuation)
+///   {
+///       timer.async_wait([this, continuation](auto error) mutable {
+///           cancellation.complete();
+///           continuation();
+///       });
+///   }
+///   void cancel() { cancellation.post(timer); }
+///   @endcode
+class PostedCancel {
+public:
+    void post(auto& io_object)
+    {
+        boost::asio::post(io_object.get_executor(), [state = m_state, &io_object] {
+            std::lock_guard lock{state->mutex};
+            if (!state->completed) io_object.cancel();
+        });
+    }
+
+    /// To be called by the completion handler, before the continuation.
+    void complete()
+    {
+        std::lock_guard lock{m_state->mutex};
+        m_state->completed = true;
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        bool completed = false;
+    };
+
+    std::shared_ptr<State> m_state = std::make_shared<State>();
+};
+
+}  // namespace ez::io
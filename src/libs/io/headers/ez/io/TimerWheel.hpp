@@ -0,0 +1,335 @@
+#pragma once
+
+#include <ez/io/Context.hpp>
+
+#include <ez/async/Operation.hpp>
+#include <ez/async/internal/WaiterList.hpp>
+
+#include <ez/Utils.hpp>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace ez::io {
+
+using Duration = std::chrono::steady_clock::duration;
+
+template <typename R>
+struct TimerWheelDelay;
+
+///
+/// Hierarchical hashed timer wheel, a single asio timer drives any number of delays.
+/// Four levels of 256 buckets cover 2^32 ticks, a timer is put in the bucket of the level
+/// matching its distance and moved down a level each time the level below wraps around (longer
+/// delays are capped and rescheduled). Scheduling and cancelling are O(1). The asio timer only
+/// runs while timers are pending and is armed for the next tick with a timer to expire or to move
+/// down: the ticks without any are skipped, a long delay wakes the context once per level.
+/// Delays complete on the context, never before their duration and at most one tick after it.
+/// The wheel must outlive its delays and be destroyed once the context stopped running.
+/// Usage:
+///   @code
+///   io::TimerWheel wheel{context, 10ms};
+///   co_await wheel.delay(250ms);
+///   auto result = co_await async::when_any(request(), wheel.delay(5s, timeout_tag));
+///   @endcode
+class TimerWheel : NonCopiable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TimerWheel(Context& context, Duration tick = std::chrono::milliseconds{1})
+        : m_context{context}, m_ticker{context}, m_tick_duration{tick}, m_start{Clock::now()}
+    {
+    }
+    TimerWheel(TimerWheel&&) = delete;
+    ~TimerWheel();
+
+    Duration tick_duration() const noexcept { return m_tick_duration; }
+
+    /// Pending timers.
+    size_t size() const
+    {
+        std::lock_guard lock{m_mutex};
+        return m_count;
+    }
+
+    /// The result throws async::OperationCancelled when the delay was cancelled.
+    template <typename R = Unit>
+    async::Operation<TimerWheelDelay<std::remove_cvref_t<R>>> delay(Duration duration,
+                                                                    R&& return_value = {});
+
+private:
+    template <typename R>
+    friend struct TimerWheelDelay;
+
+    struct Timer;
+    using TimerList = async::internal::WaiterList<Timer>;
+
+    struct Timer {
+        Timer* prev = nullptr;
+        Timer* next = nullptr;
+        TimerList* bucket = nullptr;
+        u64 deadline = 0;
+        bool cancelled = false;
+        std::function<void()> on_expired;
+    };
+
+    static constexpr u32 bucket_bits = 8;
+    static constexpr u64 bucket_count = u64{1} << bucket_bits;
+    static constexpr u64 bucket_mask = bucket_count - 1;
+    static constexpr u32 level_count = 4;
+    static constexpr u64 max_distance = (u64{1} << (bucket_bits * level_count)) - 1;
+
+    // Any thread.
+    void schedule(Timer& timer, Duration duration);
+    void cancel(Timer& timer);
+
+    u64 insert(Timer& timer);
+    u64 next_event_tick() const;
+    void advance(TimerList& expired);
+    void arm();
+    void on_tick();
+
+    u64 tick_before(Clock::time_point time) const
+    {
+        return u64((time - m_start) / m_tick_duration);
+    }
+    u64 tick_after(Clock::time_point time) const
+    {
+        return u64((time - m_start + m_tick_duration - Duration{1}) / m_tick_duration);
+    }
+
+    Context& m_context;
+    boost::asio::steady_timer m_ticker;
+    const Duration m_tick_duration;
+    const Clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::array<std::array<TimerList, bucket_count>, level_count> m_levels;
+    u64 m_tick = 0;  // Next tick to process.
+    size_t m_count = 0;
+    bool m_armed = false;
+    u64 m_armed_tick = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename R = Unit>
+struct TimerWheelDelay {
+    TimerWheel& wheel;
+    Duration duration;
+    R return_value;
+    TimerWheel::Timer timer;
+
+    TimerWheelDelay(TimerWheel& wheel, Duration d, R ret_value = Unit{})
+        : wheel{wheel}, duration{d}, return_value{EZ_FWD(ret_value)}
+    {
+    }
+
+    bool done() const { return false; }
+
+    void start(auto continuation)
+    {
+        timer.on_expired = std::move(continuation);
+        wheel.schedule(timer, duration);
+    }
+
+    void cancel() { wheel.cancel(timer); }
+
+    auto result()
+    {
+        if (timer.cancelled) throw async::OperationCancelled{};
+        if constexpr (!std::is_same_v<R, Unit>) { return std::move(return_value); }
+    }
+};
+
+template <typename R>
+async::Operation<TimerWheelDelay<std::remove_cvref_t<R>>> TimerWheel::delay(Duration duration,
+                                                                            R&& return_value)
+{
+    return {*this, duration, EZ_FWD(return_value)};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline TimerWheel::~TimerWheel()
+{
+    m_ticker.cancel();
+
+    // The continuations own the delays, dropping them releases the pending operations.
+    TimerList pending;
+    {
+        std::lock_guard lock{m_mutex};
+        for (auto& level : m_levels) {
+            for (auto& bucket : level) {
+                while (Timer* timer = bucket.pop_front()) pending.push_back(timer);
+            }
+        }
+        m_count = 0;
+    }
+    while (Timer* timer = pending.pop_front()) {
+        timer->bucket = nullptr;
+        std::exchange(timer->on_expired, nullptr);
+    }
+}
+
+inline void TimerWheel::schedule(Timer& timer, Duration duration)
+{
+    const auto now = Clock::now();
+    bool must_arm = false;
+    {
+        std::lock_guard lock{m_mutex};
+        // An idle wheel skips the ticks elapsed since its last timer.
+        if (m_count == 0) m_tick = tick_before(now);
+
+        timer.deadline = tick_after(now + duration);
+        const u64 event_tick = insert(timer);
+        ++m_count;
+        // The asio timer may be armed for a later tick.
+        must_arm = !std::exchange(m_armed, true) || event_tick < m_armed_tick;
+    }
+
+    if (!must_arm) return;
+    if (m_context.get_executor().running_in_this_thread()) arm();
+    else boost::asio::post(m_context, [this] { arm(); });
+}
+
+inline void TimerWheel::cancel(Timer& timer)
+{
+    {
+        std::lock_guard lock{m_mutex};
+        if (timer.bucket == nullptr) return;  // Expired or already cancelled.
+        timer.bucket->remove(&timer);
+        timer.bucket = nullptr;
+        --m_count;
+    }
+
+    // Completed from the context, like an expiration.
+    timer.cancelled = true;
+    boost::asio::post(m_context, [&timer] { std::exchange(timer.on_expired, nullptr)(); });
+}
+
+// The level is picked from the distance to the current tick, the bucket from the deadline bits
+// of that level: the bucket is reached when the lower levels wrap around. Returns the tick at
+// which the timer expires or moves down a level.
+inline u64 TimerWheel::insert(Timer& timer)
+{
+    u64 expires = std::max(timer.deadline, m_tick);
+    if (expires - m_tick > max_distance) expires = m_tick + max_distance;
+
+    const u64 distance = expires - m_tick;
+    u32 level = 0;
+    while (level + 1 < level_count && distance >= (u64{1} << (bucket_bits * (level + 1)))) {
+        ++level;
+    }
+
+    const u32 shift = bucket_bits * level;
+    TimerList& bucket = m_levels[level][(expires >> shift) & bucket_mask];
+    bucket.push_back(&timer);
+    timer.bucket = &bucket;
+    return (expires >> shift) << shift;
+}
+
+// First tick with a non-empty bucket to process: a level 0 bucket, or a bucket of level n
+// cascaded when the ticks reach a multiple of 2^(8n). Each bucket is reached within a rotation
+// of its level from the current tick.
+inline u64 TimerWheel::next_event_tick() const
+{
+    u64 next = std::numeric_limits<u64>::max();
+    for (u32 level = 0; level < level_count; ++level) {
+        const u32 shift = bucket_bits * level;
+        const u64 step = u64{1} << shift;
+        u64 tick = ((m_tick + step - 1) >> shift) << shift;
+        for (u64 i = 0; i < bucket_count && tick < next; ++i, tick += step) {
+            if (!m_levels[level][(tick >> shift) & bucket_mask].empty()) {
+                next = tick;
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+inline void TimerWheel::advance(TimerList& expired)
+{
+    // Level 0 wrapped around: the next bucket of level 1 moves down, and so on.
+    if ((m_tick & bucket_mask) == 0) {
+        for (u32 level = 1; level < level_count; ++level) {
+            const u64 index = (m_tick >> (bucket_bits * level)) & bucket_mask;
+            TimerList cascaded;
+            while (Timer* timer = m_levels[level][index].pop_front()) cascaded.push_back(timer);
+            while (Timer* timer = cascaded.pop_front()) insert(*timer);
+            if (index != 0) break;
+        }
+    }
+
+    TimerList& bucket = m_levels[0][m_tick & bucket_mask];
+    TimerList due;
+    while (Timer* timer = bucket.pop_front()) due.push_back(timer);
+    while (Timer* timer = due.pop_front()) {
+        if (timer->deadline <= m_tick) {
+            timer->bucket = nullptr;
+            --m_count;
+            expired.push_back(timer);
+        }
+        else {
+            insert(*timer);  // Capped distance.
+        }
+    }
+
+    ++m_tick;
+}
+
+inline void TimerWheel::arm()
+{
+    Clock::time_point next_tick;
+    {
+        std::lock_guard lock{m_mutex};
+        if (m_count == 0) {
+            m_armed = false;
+            return;
+        }
+        m_armed_tick = next_event_tick();
+        next_tick = m_start + m_tick_duration * i64(m_armed_tick);
+    }
+
+    // Replaces the wait armed for a later tick, if any.
+    m_ticker.expires_at(next_tick);
+    m_ticker.async_wait([this](boost::system::error_code error) {
+        if (!error) on_tick();
+    });
+}
+
+inline void TimerWheel::on_tick()
+{
+    TimerList expired;
+    bool rearm = false;
+    {
+        std::lock_guard lock{m_mutex};
+        const u64 now = tick_before(Clock::now());
+        while (m_count != 0) {
+            const u64 next = next_event_tick();
+            if (next > now) {
+                // Nothing to process up to now.
+                m_tick = std::max(m_tick, now + 1);
+                break;
+            }
+            m_tick = next;
+            advance(expired);
+        }
+        m_armed = rearm = m_count != 0;
+    }
+
+    // The continuations may schedule new timers.
+    while (Timer* timer = expired.pop_front()) std::exchange(timer->on_expired, nullptr)();
+
+    if (rearm) arm();
+}
+
+}  // namespace ez::io
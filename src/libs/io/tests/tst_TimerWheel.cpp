@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <ez/io/Context.hpp>
+#include <ez/io/TimerWheel.hpp>
+
+#include <ez/async/Cancellation.hpp>
+#include <ez/async/Scope.hpp>
+#include <ez/async/WhenAny.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace ez;
+
+using namespace std::chrono_literals;
+
+TEST(TimerWheel, delay)
+{
+    io::Context context;
+    io::TimerWheel wheel{context, 1ms};
+    async::Scope scope{context};
+
+    auto elapsed = 0ns;
+    auto task = [&]() -> async::Task<> {
+        auto start = std::chrono::steady_clock::now();
+        auto value = co_await wheel.delay(50ms, 10);
+        elapsed = std::chrono::steady_clock::now() - start;
+        [&] { ASSERT_EQ(value, 10); }();
+    };
+
+    scope << task();
+    context.run();
+
+    ASSERT_GE(elapsed, 50ms);
+    ASSERT_EQ(wheel.size(), 0);
+}
+
+TEST(TimerWheel, expiration_order)
+{
+    io::Context context;
+    io::TimerWheel wheel{context, 1ms};
+    async::Scope scope{context};
+
+    std::vector<int> order;
+    auto sleeper = [&](int id, std::chrono::milliseconds duration) -> async::Task<> {
+        co_await wheel.delay(duration);
+        order.push_back(id);
+    };
+
+    // Durations two ticks apart, scheduled out of order.
+    for (int id : {7, 2, 9, 0, 4, 1, 8, 3, 6, 5}) scope << sleeper(id, 2ms * (id + 1));
+
+    context.run();
+    ASSERT_TRUE(std::ranges::is_sorted(order));
+    ASSERT_EQ(order.size(), 10);
+}
+
+// With 1us ticks, 300ms spans more than 2^16 ticks: the timer is cascaded down from level 2.
+TEST(TimerWheel, cascading)
+{
+    io::Context context;
+    io::TimerWheel wheel{context, 1us};
+    async::Scope scope{context};
+
+    auto elapsed = 0ns;
+    auto task = [&]() -> async::Task<> {
+        auto start = std::chrono::steady_clock::now();
+        co_await wheel.delay(300ms);
+        elapsed = std::chrono::steady_clock::now() - start;
+    };
+
+    scope << task();
+    context.run();
+
+    ASSERT_GE(elapsed, 300ms);
+    ASSERT_LT(elapsed, 5s);
+}
+
+// The context only wakes up for the ticks where a timer expires or moves down a level.
+TEST(TimerWheel, idle_ticks)
+{
+    io::Context context;
+    io::TimerWheel wheel{context, 1ms};
+    async::Scope scope{context};
+
+    auto task = [&]() -> async::Task<> { co_await wheel.delay(400ms); };
+
+    scope << task();
+    const size_t handlers = context.run();
+
+    ASSERT_LT(handlers, 20u);
+    ASSERT_EQ(wheel.size(), 0);
+}
+
+TEST(TimerWheel, cancellation)
+{
+    io::Context context;
+    io::TimerWheel wheel{context, 1ms};
+    async::Scope scope{context};
+    async::CancellationSource source;
+    bool cancelled = false;
+
+    auto sleeper = [&]() -> async::Task<> {
+        try {
+            co_await wheel.delay(10s);
+        }
+        catch (const async::OperationCancelled&) {
+            cancelled = true;
+        }
+    };
+    auto canceller = [&]() -> async::Task<> {
+        co_await wheel.delay(10ms);
+        source.request_cancellation();
+    };
+
+    scope << sleeper().with_cancellation(source.token()) << canceller();
+
+    auto start = std::chrono::steady_clock::now();
+    context.run();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+    ASSERT_TRUE(cancelled);
+    ASSERT_EQ(wheel.size(), 0);
+}
+
+TEST(TimerWheel, when_any)
+{
+    io::Context context;
+    io::TimerWheel wheel{context, 1ms};
+    async::Scope scope{context};
+
+    auto task = [&]() -> async::Task<> {
+        auto id = co_await async::when_any(wheel.delay(10ms, 1), wheel.delay(10s, 2));
+        [&] { ASSERT_EQ(id, 1); }();
+    };
+
+    scope << task();
+
+    auto start = std::chrono::steady_clock::now();
+    context.run();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+    ASSERT_EQ(wheel.size(), 0);
+}
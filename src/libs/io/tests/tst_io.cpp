@@ -3,9 +3,13 @@
 #include <ez/io/Context.hpp>
 #include <ez/io/Delay.hpp>
 
+#include <ez/async/Cancellation.hpp>
 #include <ez/async/Race.hpp>
 #include <ez/async/Scope.hpp>
 
+#include <atomic>
+#include <thread>
+
 using namespace ez;
 
 using namespace std::chrono_literals;
@@ -75,3 +79,108 @@ TEST(Async, race)
 
     context.run();
 }
+
+TEST(Async, when_any_cancels_the_timer)
+{
+    io::Context context;
+    async::Scope scope{context};
+
+    auto task = [&]() -> async::Task<> {
+        auto id = co_await async::when_any(io::delay(context, 10ms, 1), io::delay(context, 10s, 2));
+        [&] { ASSERT_EQ(id, 1); }();
+    };
+
+    scope << task();
+
+    // Returns once the cancelled timer is out of work.
+    auto start = std::chrono::steady_clock::now();
+    context.run();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(Async, when_any_with_a_named_delay)
+{
+    io::Context context;
+    async::Scope scope{context};
+    bool finished = false;
+
+    // The loser outlives the awaiting frame destroyed by when_any, its cancellation completes
+    // later and must not resume that frame.
+    auto task = [&]() -> async::Task<> {
+        auto slow = io::delay(context, 10s, 2);
+        auto id = co_await async::when_any(io::delay(context, 10ms, 1), slow);
+        [&] { ASSERT_EQ(id, 1); }();
+        co_await io::delay(context, 10ms);
+        finished = true;
+    };
+
+    scope << task();
+
+    auto start = std::chrono::steady_clock::now();
+    context.run();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+    ASSERT_TRUE(finished);
+}
+
+TEST(Async, cancel_delay)
+{
+    io::Context context;
+    async::Scope scope{context};
+    async::CancellationSource source;
+    bool cancelled = false;
+
+    auto sleeper = [&]() -> async::Task<> {
+        try {
+            co_await io::delay(context, 10s);
+        }
+        catch (const async::OperationCancelled&) {
+            cancelled = true;
+        }
+    };
+    auto canceller = [&]() -> async::Task<> {
+        co_await io::delay(context, 10ms);
+        source.request_cancellation();
+    };
+
+    scope << sleeper().with_cancellation(source.token()) << canceller();
+
+    auto start = std::chrono::steady_clock::now();
+    context.run();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+    ASSERT_TRUE(cancelled);
+}
+
+TEST(Async, cancel_delay_from_another_thread)
+{
+    io::Context context;
+    async::Scope scope{context};
+    async::CancellationSource source;
+    std::atomic<bool> waiting = false;
+    bool cancelled = false;
+
+    auto sleeper = [&]() -> async::Task<> {
+        try {
+            auto delay = io::delay(context, 10s);
+            waiting = true;
+            co_await delay;
+        }
+        catch (const async::OperationCancelled&) {
+            cancelled = true;
+        }
+    };
+
+    scope << sleeper().with_cancellation(source.token());
+
+    // The timer is cancelled on the thread running the context.
+    std::thread canceller{[&] {
+        while (!waiting) std::this_thread::yield();
+        std::this_thread::sleep_for(10ms);
+        source.request_cancellation();
+    }};
+
+    auto start = std::chrono::steady_clock::now();
+    context.run();
+    canceller.join();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+    ASSERT_TRUE(cancelled);
+}
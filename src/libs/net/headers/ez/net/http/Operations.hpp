@@ -7,6 +7,7 @@
 
 #include <ez/Result.hpp>
 #include <ez/async/Operation.hpp>
+#include <ez/io/PostedCancel.hpp>
 
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
@@ -49,6 +50,7 @@ struct WriteOp {
     tcp::Stream& stream;
     const Response<StringBody>& response;
     ErrorCode error_code;
+    io::PostedCancel cancellation;
 
     bool done() const { return false; }
     void start(auto continuation)
@@ -58,11 +60,12 @@ struct WriteOp {
         async_write(stream, response,
                     [this, continuation = std::move(continuation)](ErrorCode error_code,
                                                                    size_t /*count*/) mutable {
+                        cancellation.complete();
                         this->error_code = std::move(error_code);
                         continuation();
                     });
     }
-    void cancel() {}
+    void cancel() { cancellation.post(stream.socket()); }
 
     Result<void, ErrorCode> result()
     {
@@ -6,6 +6,7 @@
 
 #include <ez/async/Operation.hpp>
 #include <ez/async/Task.hpp>
+#include <ez/io/PostedCancel.hpp>
 
 #include <ez/ByteArray.hpp>
 #include <ez/Result.hpp>
@@ -18,21 +19,26 @@
 
 namespace ez::net::tcp {
 
+// The cancellation cancels every pending operation of the socket, they complete with
+// boost::asio::error::operation_aborted. It is posted to the executor of the socket.
+
 struct ConnectOp {
     Socket& scoket;
     const EndPoint& endpoint;
     ErrorCode error_code;
+    io::PostedCancel cancellation;
 
     bool done() const { return false; }
     void start(auto continuation)
     {
         scoket.async_connect(
             endpoint, [this, continuation = std::move(continuation)](ErrorCode error_code) mutable {
+                cancellation.complete();
                 this->error_code = std::move(error_code);
                 continuation();
             });
     }
-    void cancel() {}
+    void cancel() { cancellation.post(scoket); }
     Result<void, ErrorCode> result()
     {
         if (error_code) return Fail{error_code};
@@ -51,6 +57,7 @@ struct AcceptOp {
     Acceptor& acceptor;
     Socket socket;
     ErrorCode error_code;
+    io::PostedCancel cancellation;
 
     AcceptOp(Acceptor& acceptor) : acceptor(acceptor), socket(acceptor.get_executor()) {}
 
@@ -59,11 +66,12 @@ struct AcceptOp {
     {
         acceptor.async_accept(
             socket, [this, continuation = std::move(continuation)](ErrorCode error_code) mutable {
+                cancellation.complete();
                 this->error_code = std::move(error_code);
                 continuation();
             });
     }
-    void cancel() {}
+    void cancel() { cancellation.post(acceptor); }
     Result<Socket, ErrorCode> result()
     {
         if (error_code) return Fail{error_code};
@@ -81,6 +89,7 @@ struct SendOp {
     const Buffer& buffer;
     ErrorCode error_code;
     size_t count = 0;
+    io::PostedCancel cancellation;
 
     bool done() const { return false; }
     void start(auto continuation)
@@ -88,12 +97,13 @@ struct SendOp {
         boost::asio::async_write(socket, buffer,
                                  [this, continuation = std::move(continuation)](
                                      ErrorCode error_code, size_t count) mutable {
+                                     cancellation.complete();
                                      this->error_code = std::move(error_code);
                                      this->count = count;
                                      continuation();
                                  });
     }
-    void cancel() {}
+    void cancel() { cancellation.post(socket); }
     Result<size_t, ErrorCode> result()
     {
         if (error_code) return Fail{error_code};
@@ -123,6 +133,7 @@ struct ReceiveExactlyOp {
     size_t received_count = 0;
     ErrorCode error_code;
     bool done_ = false;
+    io::PostedCancel cancellation;
 
     ReceiveExactlyOp(Socket& socket, ByteArray& output, size_t count)
         : socket{socket}, output{output}, count{count}
@@ -143,12 +154,13 @@ struct ReceiveExactlyOp {
         boost::asio::async_read(socket, net::buffer(output), boost::asio::transfer_exactly(count),
                                 [this, continuation = std::move(continuation)](
                                     ErrorCode error_code, size_t count) mutable {
+                                    cancellation.complete();
                                     this->error_code = std::move(error_code);
                                     this->received_count = count;
                                     continuation();
                                 });
     }
-    void cancel() {}
+    void cancel() { cancellation.post(socket); }
     Result<size_t, ErrorCode> result()
     {
         if (error_code) return Fail{error_code};
@@ -21,10 +21,15 @@ public:
     virtual IoContext& context() = 0;
     virtual AsyncResult<RequestId> invoke(std::string_view name_space,
                                           std::string_view fn_name,
-                                          std::vector<ByteArray> arguments,
-                                          RawReply* reply) = 0;
+                                          std::vector<ByteArray> arguments) = 0;
 
-    virtual void set_response_callback(const RequestId& request_id, std::function<void()> wake) = 0;
+    /// `on_reply` receives the reply on the context, the query owns it until then.
+    virtual void set_response_callback(const RequestId& request_id,
+                                       std::function<void(RawReply)> on_reply) = 0;
+
+    /// Drops the pending request and passes Error::cancelled() to its callback, a late response
+    /// is ignored. Can be called from any thread.
+    virtual void cancel_response(const RequestId& request_id) = 0;
 };
 
 struct RemoteServiceBaseImpl;
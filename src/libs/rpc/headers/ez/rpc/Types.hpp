@@ -19,7 +19,7 @@ using ParsingError = std::runtime_error;
 
 struct Error {
     // Keep the same values as in messages.proto.Error.Code
-    enum Code : int { Timeout, FailedToSendRequest, FunctionNotFound, InternalError };
+    enum Code : int { Timeout, FailedToSendRequest, FunctionNotFound, InternalError, Cancelled };
 
     Code code;
     std::string what;
@@ -29,6 +29,7 @@ struct Error {
         return Error{FailedToSendRequest, "Failed to send request"};
     }
     static Error timeout() { return Error{Timeout, "Response timeout"}; }
+    static Error cancelled() { return Error{Cancelled, "Request cancelled"}; }
     static Error internal_error(auto&& message) { return Error{InternalError, EZ_FWD(message)}; }
 };
 
@@ -4,6 +4,8 @@
 
 #include <ez/async/Operation.hpp>
 
+#include <optional>
+
 namespace ez::rpc {
 void AbstractFunction::set_client(AbstractRemoteService* client) { m_client = client; }
 
@@ -11,9 +13,12 @@ const std::string& AbstractFunction::name_space() const { return m_name_space; }
 
 void AbstractFunction::set_name_space(std::string_view name_space) { m_name_space = name_space; }
 
+// Kept alive by the operation until the reply is delivered, even when the awaiting coroutine is
+// destroyed first (a `when_any` loser).
 struct WaitForResponse {
     AbstractRemoteService& client;
-    const RequestId& request_id;
+    RequestId request_id;
+    std::optional<RawReply> reply;
 
     void start(auto&) {}
 
@@ -21,24 +26,25 @@ struct WaitForResponse {
 
     void start(auto continuation)
     {
-        client.set_response_callback(request_id, [continuation]() mutable { continuation(); });
+        client.set_response_callback(request_id, [this, continuation](RawReply reply) mutable {
+            this->reply = std::move(reply);
+            continuation();
+        });
     }
 
-    void cancel() {}
+    void cancel() { client.cancel_response(request_id); }
 
-    Unit result() { return {}; }
+    RawReply result() { return std::move(*reply); }
 };
 
 AsyncResult<RawReply> AbstractFunction::invoke_remote(std::string_view name_space,
                                                       std::string_view function_name,
                                                       std::vector<ByteArray> args)
 {
-    RawReply reply;
-    auto id = co_await m_client->invoke(name_space, function_name, std::move(args), &reply);
+    auto id = co_await m_client->invoke(name_space, function_name, std::move(args));
     if (!id) co_return Fail{id.error()};
 
-    co_await async::Operation<WaitForResponse>{*m_client, id.value()};
-    co_return std::move(reply);
+    co_return co_await async::Operation<WaitForResponse>{*m_client, std::move(id.value())};
 }
 
 }  // namespace ez::rpc
@@ -10,16 +10,28 @@
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include <optional>
+
 namespace ez::rpc {
 RequestId make_request_id()
 {
     return RequestId{boost::uuids::to_string(boost::uuids::random_generator()())};
 }
 
+namespace {
+RawReply to_raw_reply(const protobuf::Reply& reply)
+{
+    if (reply.has_value()) return ByteArray{reply.value()};
+    return Fail{Error{Error::Code(reply.error().code()), reply.error().what()}};
+}
+}  // namespace
+
 struct RemoteServiceBaseImpl : public AbstractRemoteService {
+    // The reply is kept here when it arrives before the callback is set. The query never points
+    // into the waiting coroutine, which may be destroyed while the request is pending.
     struct Query {
-        RawReply* reply;
-        std::function<void()> wake;
+        std::optional<RawReply> reply;
+        std::function<void(RawReply)> on_reply;
     };
 
     Ref<IoContext> context_;
@@ -37,13 +49,11 @@ struct RemoteServiceBaseImpl : public AbstractRemoteService {
 
     AsyncResult<RequestId> invoke(std::string_view name_space,
                                   std::string_view fn_name,
-                                  std::vector<ByteArray> arguments,
-                                  RawReply* reply) override
+                                  std::vector<ByteArray> arguments) override
     {
         auto id = make_request_id();
 
-        auto& query = queries[id];
-        query.reply = reply;
+        queries.try_emplace(id);
         protobuf::Request request;
         request.set_id(id.value());
         *request.mutable_name_space() = name_space;
@@ -55,10 +65,37 @@ struct RemoteServiceBaseImpl : public AbstractRemoteService {
         co_return std::move(id);
     }
 
-    void set_response_callback(const RequestId& request_id, std::function<void()> wake) override
+    void set_response_callback(const RequestId& request_id,
+                               std::function<void(RawReply)> on_reply) override
     {
         auto& query = queries[request_id];
-        query.wake = std::move(wake);
+        if (query.reply) {
+            deliver(std::move(on_reply), std::move(*query.reply));
+            queries.erase(request_id);
+        }
+        else {
+            query.on_reply = std::move(on_reply);
+        }
+    }
+
+    void cancel_response(const RequestId& request_id) override
+    {
+        async::post(context_.get(), [this, request_id] {
+            auto query = queries.find(request_id);
+            if (query == queries.end()) return;
+
+            auto on_reply = std::move(query->second.on_reply);
+            queries.erase(query);
+            if (on_reply) on_reply(Fail{Error::cancelled()});
+        });
+    }
+
+    void deliver(std::function<void(RawReply)> on_reply, RawReply reply)
+    {
+        async::post(context_.get(),
+                    [on_reply = std::move(on_reply), reply = std::move(reply)]() mutable {
+                        on_reply(std::move(reply));
+                    });
     }
 
     void poll()
@@ -76,17 +113,16 @@ struct RemoteServiceBaseImpl : public AbstractRemoteService {
 
             const auto request_id = RequestId{reply.request_id()};
 
-            if (!queries.contains(request_id)) continue;
+            auto query = queries.find(request_id);
+            if (query == queries.end()) continue;
 
-            auto& query = queries[request_id];
-
-            if (reply.has_value()) { *query.reply = ByteArray{reply.value()}; }
+            if (query->second.on_reply) {
+                deliver(std::move(query->second.on_reply), to_raw_reply(reply));
+                queries.erase(query);
+            }
             else {
-                *query.reply = Fail{Error{Error::Code(reply.error().code()), reply.error().what()}};
+                query->second.reply = to_raw_reply(reply);
             }
-
-            async::post(context_.get(), query.wake);
-            queries.erase(request_id);
         }
 
         start();
@@ -4,7 +4,9 @@
 #include <ez/rpc/Schema.hpp>
 #include <ez/rpc/Service.hpp>
 
+#include <ez/async/Cancellation.hpp>
 #include <ez/async/WhenAll.hpp>
+#include <ez/async/WhenAny.hpp>
 
 #include <ez/Atomic.hpp>
 #include <ez/Shared.hpp>
@@ -230,3 +232,50 @@ TEST(Rpc, test)
     server_task.wait();
     client_task.wait();
 }
+
+TEST(Rpc, cancelled_requests)
+{
+    Transport transport;
+
+    rpc::IoContext service_context, client_context;
+
+    Service service{service_context, transport.make_server()};
+    init_functions(service.implementation<SchemaV1>());
+    init_functions(service.implementation<SchemaV2>());
+    ASSERT_TRUE(service.bind_to("server 1"));
+    service.start({std::chrono::milliseconds{1}});
+
+    RemoteService remote_service{client_context, transport.make_client(rpc::PeerId{"client 1"})};
+    ASSERT_TRUE(remote_service.connect_to("server 1"));
+    remote_service.start({std::chrono::milliseconds{1}});
+
+    auto& remote = remote_service.functions<SchemaV1>();
+    async::CancellationSource source;
+    bool done = false;
+
+    auto client = [&]() -> async::Task<> {
+        // The local branch wins: the pending request is cancelled and its coroutine destroyed
+        // while the reply is on its way, the late reply is ignored.
+        auto local = []() -> rpc::AsyncResult<std::string> { co_return "local"; };
+        auto first = co_await async::when_any(remote.get_foo(), local());
+        EXPECT_EQ(first.value(), "local");
+
+        // Cancelled while waiting for the reply.
+        async::post(client_context, [&] { source.request_cancellation(); });
+        auto cancelled = co_await remote.get_foo().with_cancellation(source.token());
+        EXPECT_FALSE(cancelled);
+        EXPECT_EQ(cancelled.error().code, rpc::Error::Cancelled);
+
+        auto foo = co_await remote.get_foo();
+        EXPECT_EQ(foo.value(), "foo 1");
+        done = true;
+    };
+
+    async::Scope scope{client_context};
+    scope << client();
+
+    while (!done) {
+        client_context.run_for(std::chrono::milliseconds{1});
+        service_context.run_for(std::chrono::milliseconds{1});
+    }
+}